@@ -32,10 +32,88 @@
 #include "assignment.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <string.h>  // For memcpy.
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include <algorithm>
+#include <cmath>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include "glog/logging.h"
 
 namespace wvu {
+namespace {
+// Measured maximum relative errors of the reciprocal square root tiers. See
+// the ReciprocalSqrt tests in assignment_tests.cc. The estimate of rsqrtps is
+// documented to be within 1.5 * 2^-12. Without SSE the estimate comes from the
+// integer approximation of the logarithm, which is less accurate.
+#ifdef __SSE__
+constexpr float kRsqrtEstimateMaxRelativeError = 3.7e-4f;
+constexpr float kRsqrtNewtonMaxRelativeError = 3e-7f;
+#else
+constexpr float kRsqrtEstimateMaxRelativeError = 3.5e-2f;
+constexpr float kRsqrtNewtonMaxRelativeError = 1.8e-3f;
+#endif
+constexpr float kRsqrtFullMaxRelativeError = 1.2e-7f;
+
+// Returns the raw estimate of 1 / sqrt(x).
+inline float EstimateReciprocalSqrt(const float x) {
+#ifdef __SSE__
+  return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+  int32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  bits = 0x5f375a86 - (bits >> 1);
+  float estimate;
+  memcpy(&estimate, &bits, sizeof(estimate));
+  return estimate;
+#endif
+}
+
+// Refines an estimate y of 1 / sqrt(x) with one Newton-Raphson step.
+inline float RefineReciprocalSqrt(const float x, const float y) {
+  return y * (1.5f - (0.5f * x) * (y * y));
+}
+
+// Computes 1 / sqrt(x) for num_values floats. The SSE path processes four
+// values per instruction.
+void ComputeReciprocalSqrt(const float* x,
+                           const int num_values,
+                           const RsqrtAccuracy accuracy,
+                           float* result) {
+  if (accuracy == RSQRT_FULL) {
+    for (int i = 0; i < num_values; ++i) {
+      result[i] = 1.0f / std::sqrt(x[i]);
+    }
+    return;
+  }
+  int i = 0;
+#ifdef __SSE__
+  const __m128 kThreeHalves = _mm_set1_ps(1.5f);
+  const __m128 kHalf = _mm_set1_ps(0.5f);
+  for (; i + 4 <= num_values; i += 4) {
+    const __m128 values = _mm_loadu_ps(x + i);
+    __m128 estimate = _mm_rsqrt_ps(values);
+    if (accuracy == RSQRT_NEWTON) {
+      const __m128 half_x_y_y =
+          _mm_mul_ps(_mm_mul_ps(kHalf, values),
+                     _mm_mul_ps(estimate, estimate));
+      estimate = _mm_mul_ps(estimate, _mm_sub_ps(kThreeHalves, half_x_y_y));
+    }
+    _mm_storeu_ps(result + i, estimate);
+  }
+#endif
+  for (; i < num_values; ++i) {
+    const float estimate = EstimateReciprocalSqrt(x[i]);
+    result[i] = accuracy == RSQRT_NEWTON ?
+        RefineReciprocalSqrt(x[i], estimate) : estimate;
+  }
+}
+
+}  // namespace
+
 // Adds two 3d points and returns the resultant added point.
 Eigen::Vector3f Add3dPoints(const Eigen::Vector3f& x,
                             const Eigen::Vector3f& y) {
@@ -79,4 +157,153 @@ Eigen::Vector3f ComputeCrossProduct(const Eigen::Vector3f& x,
   return x.cross(y);
 }
 
+// Converts a set of 3d vectors into the SoA layout.
+void PackVector3fBatch(const std::vector<Eigen::Vector3f>& vectors,
+                       Vector3fBatch* batch) {
+  batch->resize(vectors.size());
+  for (int i = 0; i < static_cast<int>(vectors.size()); ++i) {
+    batch->x[i] = vectors[i].x();
+    batch->y[i] = vectors[i].y();
+    batch->z[i] = vectors[i].z();
+  }
+}
+
+// Converts a set of quaternions into the SoA layout.
+void PackQuaternionBatch(const std::vector<Eigen::Quaternionf>& quaternions,
+                         QuaternionBatch* batch) {
+  batch->resize(quaternions.size());
+  for (int i = 0; i < static_cast<int>(quaternions.size()); ++i) {
+    batch->w[i] = quaternions[i].w();
+    batch->x[i] = quaternions[i].x();
+    batch->y[i] = quaternions[i].y();
+    batch->z[i] = quaternions[i].z();
+  }
+}
+
+// Composes the quaternions element-wise using the Hamilton product. Every
+// line below is a single Eigen array expression, so it is evaluated in one
+// vectorized pass without temporaries.
+void ComposeQuaternions(const QuaternionBatch& x,
+                        const QuaternionBatch& y,
+                        QuaternionBatch* result) {
+  CHECK_EQ(x.size(), y.size());
+  result->resize(x.size());
+  result->w = x.w * y.w - x.x * y.x - x.y * y.y - x.z * y.z;
+  result->x = x.w * y.x + x.x * y.w + x.y * y.z - x.z * y.y;
+  result->y = x.w * y.y - x.x * y.z + x.y * y.w + x.z * y.x;
+  result->z = x.w * y.z + x.x * y.y - x.y * y.x + x.z * y.w;
+}
+
+// Rotates the vectors using v' = v + w t + q x t, where t = 2 q x v.
+void RotateVectorsByQuaternions(const QuaternionBatch& quaternions,
+                                const Vector3fBatch& vectors,
+                                Vector3fBatch* result) {
+  CHECK_EQ(quaternions.size(), vectors.size());
+  const QuaternionBatch& q = quaternions;
+  const Vector3fBatch& v = vectors;
+  // t = 2 q x v.
+  const Eigen::ArrayXf tx = 2.0f * (q.y * v.z - q.z * v.y);
+  const Eigen::ArrayXf ty = 2.0f * (q.z * v.x - q.x * v.z);
+  const Eigen::ArrayXf tz = 2.0f * (q.x * v.y - q.y * v.x);
+  result->resize(v.size());
+  result->x = v.x + q.w * tx + (q.y * tz - q.z * ty);
+  result->y = v.y + q.w * ty + (q.z * tx - q.x * tz);
+  result->z = v.z + q.w * tz + (q.x * ty - q.y * tx);
+}
+
+// Normalizes every quaternion in the batch in place.
+void NormalizeQuaternions(QuaternionBatch* quaternions) {
+  QuaternionBatch& q = *quaternions;
+  const Eigen::ArrayXf inverse_norm =
+      (q.w.square() + q.x.square() + q.y.square() + q.z.square()).rsqrt();
+  q.w *= inverse_norm;
+  q.x *= inverse_norm;
+  q.y *= inverse_norm;
+  q.z *= inverse_norm;
+}
+
+// Returns the measured bound on the relative error of each tier.
+float ReciprocalSqrtMaxRelativeError(const RsqrtAccuracy accuracy) {
+  switch (accuracy) {
+    case RSQRT_ESTIMATE:
+      return kRsqrtEstimateMaxRelativeError;
+    case RSQRT_NEWTON:
+      return kRsqrtNewtonMaxRelativeError;
+    case RSQRT_FULL:
+      return kRsqrtFullMaxRelativeError;
+  }
+  return kRsqrtFullMaxRelativeError;
+}
+
+// Computes 1 / sqrt(x) for a positive normal float x.
+float ComputeReciprocalSqrt(const float x, const RsqrtAccuracy accuracy) {
+  float result;
+  ComputeReciprocalSqrt(&x, 1, accuracy, &result);
+  return result;
+}
+
+// Computes 1 / sqrt(x) element-wise.
+Eigen::ArrayXf ComputeReciprocalSqrt(const Eigen::ArrayXf& x,
+                                     const RsqrtAccuracy accuracy) {
+  Eigen::ArrayXf result(x.size());
+  ComputeReciprocalSqrt(x.data(), x.size(), accuracy, result.data());
+  return result;
+}
+
+// Normalizes the vector using the reciprocal square root of the given tier.
+// The vector is first divided by its largest absolute component, so that its
+// squared norm lies in [1, 3] and neither underflows nor overflows.
+Eigen::Vector3f NormalizeVector(const Eigen::Vector3f& x,
+                                const RsqrtAccuracy accuracy) {
+  const float max_component = x.cwiseAbs().maxCoeff();
+  if (max_component <= 0.0f) {
+    return x;
+  }
+  const Eigen::Vector3f scaled = x / max_component;
+  return scaled * ComputeReciprocalSqrt(scaled.squaredNorm(), accuracy);
+}
+
+// Normalizes every vector in the batch in place, rescaling each vector by its
+// largest absolute component first as NormalizeVector() does.
+void NormalizeVectors(const RsqrtAccuracy accuracy, Vector3fBatch* vectors) {
+  Vector3fBatch& v = *vectors;
+  const Eigen::ArrayXf max_components =
+      v.x.abs().max(v.y.abs()).max(v.z.abs());
+  // Zero vectors get a scale of zero so they stay unchanged.
+  const Eigen::ArrayXf scales =
+      (max_components > 0.0f).select(max_components.inverse(), 0.0f);
+  v.x *= scales;
+  v.y *= scales;
+  v.z *= scales;
+  const Eigen::ArrayXf squared_norms =
+      v.x.square() + v.y.square() + v.z.square();
+  const Eigen::ArrayXf inverse_norms =
+      (max_components > 0.0f).select(
+          ComputeReciprocalSqrt(squared_norms, accuracy), 0.0f);
+  v.x *= inverse_norms;
+  v.y *= inverse_norms;
+  v.z *= inverse_norms;
+}
+
+// Calculates the angle between two vectors with a single reciprocal square
+// root. Both vectors are rescaled by their largest absolute component, so the
+// product of their squared norms lies in [1, 9].
+float CalculateAngleBetweenTwoVectors(const Eigen::Vector3f& x,
+                                      const Eigen::Vector3f& y,
+                                      const RsqrtAccuracy accuracy) {
+  const float x_max_component = x.cwiseAbs().maxCoeff();
+  const float y_max_component = y.cwiseAbs().maxCoeff();
+  // A zero vector has no direction. normalized() maps it to zero, so the
+  // overload above returns acos(0); do the same instead of 0 * inf = NaN.
+  if (x_max_component <= 0.0f || y_max_component <= 0.0f) {
+    return acos(0.0f);
+  }
+  const Eigen::Vector3f x_scaled = x / x_max_component;
+  const Eigen::Vector3f y_scaled = y / y_max_component;
+  const float cos_theta = x_scaled.dot(y_scaled) * ComputeReciprocalSqrt(
+      x_scaled.squaredNorm() * y_scaled.squaredNorm(), accuracy);
+  // The approximate tiers can slightly overshoot the valid domain of acos.
+  return acos(std::max(-1.0f, std::min(1.0f, cos_theta)));
+}
+
 }  // namespace
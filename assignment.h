@@ -33,6 +33,8 @@
 #define ASSIGNMENT_2_H_
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <vector>
 
 // Assignment 2. Implement the functions declared below in assignment.cc. The
 // goal of the assignment is to test the topics we covered as part of the
@@ -82,6 +84,112 @@ float CalculateAngleBetweenTwoVectors(const Eigen::Vector3f& x,
 Eigen::Vector3f ComputeCrossProduct(const Eigen::Vector3f& x,
                                     const Eigen::Vector3f& y);
 
+// Batch of 3d vectors stored as a structure of arrays (SoA). The i-th vector
+// is (x[i], y[i], z[i]). Keeping every component in its own contiguous array
+// lets Eigen process several vectors per SIMD instruction.
+struct Vector3fBatch {
+  Eigen::ArrayXf x;
+  Eigen::ArrayXf y;
+  Eigen::ArrayXf z;
+
+  // Allocates room for num_vectors vectors. The contents are uninitialized.
+  void resize(const int num_vectors) {
+    x.resize(num_vectors);
+    y.resize(num_vectors);
+    z.resize(num_vectors);
+  }
+  int size() const { return static_cast<int>(x.size()); }
+};
+
+// Batch of quaternions stored as a structure of arrays (SoA). The i-th
+// quaternion is w[i] + x[i] i + y[i] j + z[i] k.
+struct QuaternionBatch {
+  Eigen::ArrayXf w;
+  Eigen::ArrayXf x;
+  Eigen::ArrayXf y;
+  Eigen::ArrayXf z;
+
+  // Allocates room for num_quaternions quaternions. The contents are
+  // uninitialized.
+  void resize(const int num_quaternions) {
+    w.resize(num_quaternions);
+    x.resize(num_quaternions);
+    y.resize(num_quaternions);
+    z.resize(num_quaternions);
+  }
+  int size() const { return static_cast<int>(w.size()); }
+};
+
+// Converts a set of 3d vectors into the SoA layout.
+void PackVector3fBatch(const std::vector<Eigen::Vector3f>& vectors,
+                       Vector3fBatch* batch);
+
+// Converts a set of quaternions into the SoA layout.
+void PackQuaternionBatch(const std::vector<Eigen::Quaternionf>& quaternions,
+                         QuaternionBatch* batch);
+
+// Composes the quaternions element-wise, i.e., result[i] = x[i] * y[i]. Both
+// batches must have the same size, which is checked, and result must not alias
+// x or y.
+void ComposeQuaternions(const QuaternionBatch& x,
+                        const QuaternionBatch& y,
+                        QuaternionBatch* result);
+
+// Rotates the i-th vector by the i-th unit quaternion. The rotation uses the
+// cross-product form v' = v + w t + q x t with t = 2 q x v, where q is the
+// vector part of the quaternion. This avoids building a rotation matrix per
+// quaternion. Both batches must have the same size, which is checked, and
+// result must not alias vectors.
+void RotateVectorsByQuaternions(const QuaternionBatch& quaternions,
+                                const Vector3fBatch& vectors,
+                                Vector3fBatch* result);
+
+// Normalizes every quaternion in the batch in place.
+void NormalizeQuaternions(QuaternionBatch* quaternions);
+
+// Accuracy tiers of the reciprocal square root. Lower tiers trade accuracy for
+// throughput. ReciprocalSqrtMaxRelativeError() returns the measured bound on
+// the relative error of every tier.
+enum RsqrtAccuracy {
+  // Hardware estimate (rsqrtps) without refinement.
+  RSQRT_ESTIMATE = 0,
+  // Hardware estimate refined with one Newton-Raphson step.
+  RSQRT_NEWTON = 1,
+  // Full precision 1 / sqrt(x).
+  RSQRT_FULL = 2
+};
+
+// Returns the maximum relative error of the reciprocal square root for the
+// given accuracy tier. The bound was measured for x in [1e-30, 1e30].
+float ReciprocalSqrtMaxRelativeError(const RsqrtAccuracy accuracy);
+
+// Computes 1 / sqrt(x) for a positive normal float x.
+float ComputeReciprocalSqrt(const float x, const RsqrtAccuracy accuracy);
+
+// Computes 1 / sqrt(x) element-wise for positive normal floats.
+Eigen::ArrayXf ComputeReciprocalSqrt(const Eigen::ArrayXf& x,
+                                     const RsqrtAccuracy accuracy);
+
+// Normalizes the vector using the reciprocal square root of the given tier.
+// Like Eigen's normalized(), a zero vector is returned unchanged. Any vector
+// with finite components is valid, including tiny and huge ones whose squared
+// norm is not representable as a float.
+Eigen::Vector3f NormalizeVector(const Eigen::Vector3f& x,
+                                const RsqrtAccuracy accuracy);
+
+// Normalizes every vector in the batch in place. Zero vectors are left
+// unchanged. The valid inputs are those of NormalizeVector().
+void NormalizeVectors(const RsqrtAccuracy accuracy, Vector3fBatch* vectors);
+
+// Calculates the angle between two vectors in radians. Instead of normalizing
+// both vectors, the cosine is computed as x.y / sqrt(|x|^2 |y|^2) using a
+// single reciprocal square root of the given tier. Any vectors with finite
+// components are valid, as for NormalizeVector(). If either vector is zero,
+// pi / 2 is returned like the overload above.
+float CalculateAngleBetweenTwoVectors(const Eigen::Vector3f& x,
+                                      const Eigen::Vector3f& y,
+                                      const RsqrtAccuracy accuracy);
+
 }  // namespace
 
 #endif  // ASSIGNMENT_2_H_
@@ -34,6 +34,8 @@
 
 // C++ headers.
 #include <algorithm>  // For std::reverse.
+#include <chrono>  // For timing the batch kernels.
+#include <cmath>
 #include <numeric>  // For std::accumulate.
 #include <unordered_set>
 #include <vector>
@@ -184,6 +186,197 @@ TEST(LinearAlgebra, ComputeCrossProduct) {
   EXPECT_NEAR(1.0f, ComputeDotProduct(z, result), 1e-3);
 }
 
+TEST(QuaternionBatch, ComposeQuaternions) {
+  constexpr int kNumQuaternions = 37;
+  std::vector<Eigen::Quaternionf> x(kNumQuaternions);
+  std::vector<Eigen::Quaternionf> y(kNumQuaternions);
+  for (int i = 0; i < kNumQuaternions; ++i) {
+    x[i] = Eigen::Quaternionf::UnitRandom();
+    y[i] = Eigen::Quaternionf::UnitRandom();
+  }
+  QuaternionBatch x_batch, y_batch, result;
+  PackQuaternionBatch(x, &x_batch);
+  PackQuaternionBatch(y, &y_batch);
+  ComposeQuaternions(x_batch, y_batch, &result);
+  ASSERT_EQ(result.size(), kNumQuaternions);
+  for (int i = 0; i < kNumQuaternions; ++i) {
+    const Eigen::Quaternionf expected = x[i] * y[i];
+    EXPECT_NEAR(result.w[i], expected.w(), 1e-5);
+    EXPECT_NEAR(result.x[i], expected.x(), 1e-5);
+    EXPECT_NEAR(result.y[i], expected.y(), 1e-5);
+    EXPECT_NEAR(result.z[i], expected.z(), 1e-5);
+  }
+}
+
+TEST(QuaternionBatch, NormalizeQuaternions) {
+  constexpr int kNumQuaternions = 19;
+  QuaternionBatch quaternions;
+  quaternions.resize(kNumQuaternions);
+  quaternions.w = Eigen::ArrayXf::Random(kNumQuaternions) + 2.0f;
+  quaternions.x = Eigen::ArrayXf::Random(kNumQuaternions);
+  quaternions.y = Eigen::ArrayXf::Random(kNumQuaternions);
+  quaternions.z = Eigen::ArrayXf::Random(kNumQuaternions);
+  NormalizeQuaternions(&quaternions);
+  for (int i = 0; i < kNumQuaternions; ++i) {
+    const Eigen::Vector4f q(quaternions.w[i], quaternions.x[i],
+                            quaternions.y[i], quaternions.z[i]);
+    EXPECT_NEAR(q.norm(), 1.0f, 1e-5);
+  }
+}
+
+// Verifies the rotated vectors against the matrix path, i.e., building a
+// Matrix4f per quaternion and calling MultiplyVectorAndMatrix, and reports the
+// speedup of the batched kernel.
+TEST(QuaternionBatch, RotateVectorsByQuaternions) {
+  constexpr int kNumVectors = 1 << 16;
+  std::vector<Eigen::Quaternionf> quaternions(kNumVectors);
+  std::vector<Eigen::Vector3f> vectors(kNumVectors);
+  for (int i = 0; i < kNumVectors; ++i) {
+    quaternions[i] = Eigen::Quaternionf::UnitRandom();
+    vectors[i] = Eigen::Vector3f::Random();
+  }
+  QuaternionBatch quaternion_batch;
+  Vector3fBatch vector_batch, result;
+  PackQuaternionBatch(quaternions, &quaternion_batch);
+  PackVector3fBatch(vectors, &vector_batch);
+  // Warm up so that the timing below does not include allocating result.
+  RotateVectorsByQuaternions(quaternion_batch, vector_batch, &result);
+
+  const auto batch_start = std::chrono::steady_clock::now();
+  RotateVectorsByQuaternions(quaternion_batch, vector_batch, &result);
+  const auto batch_end = std::chrono::steady_clock::now();
+
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >
+      expected(kNumVectors);
+  const auto matrix_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumVectors; ++i) {
+    Eigen::Matrix4f rotation = Eigen::Matrix4f::Identity();
+    rotation.topLeftCorner<3, 3>() = quaternions[i].toRotationMatrix();
+    expected[i] = MultiplyVectorAndMatrix(rotation,
+                                          vectors[i].homogeneous());
+  }
+  const auto matrix_end = std::chrono::steady_clock::now();
+
+  ASSERT_EQ(result.size(), kNumVectors);
+  for (int i = 0; i < kNumVectors; ++i) {
+    EXPECT_NEAR(result.x[i], expected[i].x(), 1e-4);
+    EXPECT_NEAR(result.y[i], expected[i].y(), 1e-4);
+    EXPECT_NEAR(result.z[i], expected[i].z(), 1e-4);
+  }
+  const std::chrono::duration<double, std::micro> batch_time =
+      batch_end - batch_start;
+  const std::chrono::duration<double, std::micro> matrix_time =
+      matrix_end - matrix_start;
+  LOG(INFO) << "Rotated " << kNumVectors << " vectors. Batch: "
+            << batch_time.count() << " us, matrix path: "
+            << matrix_time.count() << " us, speedup: "
+            << matrix_time.count() / batch_time.count() << "x";
+}
+
+// Measures the relative error of every tier over values from 1e-30 to 1e30 and
+// checks it against the documented bound.
+TEST(ReciprocalSqrt, RelativeErrorWithinBound) {
+  const RsqrtAccuracy kAccuracies[] = {
+    RSQRT_ESTIMATE, RSQRT_NEWTON, RSQRT_FULL
+  };
+  std::vector<float> values;
+  for (float x = 1e-30f; x < 1e30f; x *= 1.0001f) {
+    values.push_back(x);
+  }
+  const Eigen::ArrayXf x =
+      Eigen::Map<const Eigen::ArrayXf>(values.data(), values.size());
+  for (const RsqrtAccuracy accuracy : kAccuracies) {
+    const Eigen::ArrayXf result = ComputeReciprocalSqrt(x, accuracy);
+    double max_relative_error = 0.0;
+    for (int i = 0; i < x.size(); ++i) {
+      const double expected = 1.0 / std::sqrt(static_cast<double>(x[i]));
+      const double relative_error = std::abs(result[i] - expected) / expected;
+      max_relative_error = std::max(max_relative_error, relative_error);
+      // The scalar and the batch kernels must agree.
+      ASSERT_EQ(result[i], ComputeReciprocalSqrt(x[i], accuracy));
+    }
+    LOG(INFO) << "Tier " << accuracy << " max relative error: "
+              << max_relative_error;
+    EXPECT_LE(max_relative_error, ReciprocalSqrtMaxRelativeError(accuracy));
+  }
+}
+
+TEST(ReciprocalSqrt, NormalizeVectors) {
+  constexpr int kNumVectors = 1003;
+  std::vector<Eigen::Vector3f> vectors(kNumVectors);
+  for (int i = 0; i < kNumVectors; ++i) {
+    vectors[i] = 100.0f * Eigen::Vector3f::Random();
+  }
+  vectors[0].setZero();
+  for (const RsqrtAccuracy accuracy : { RSQRT_ESTIMATE, RSQRT_NEWTON }) {
+    Vector3fBatch batch;
+    PackVector3fBatch(vectors, &batch);
+    NormalizeVectors(accuracy, &batch);
+    const float max_error = ReciprocalSqrtMaxRelativeError(accuracy);
+    EXPECT_EQ(batch.x[0], 0.0f);
+    for (int i = 1; i < kNumVectors; ++i) {
+      const Eigen::Vector3f expected = vectors[i].normalized();
+      const Eigen::Vector3f result(batch.x[i], batch.y[i], batch.z[i]);
+      EXPECT_NEAR((result - expected).norm(), 0.0f, 2.0f * max_error);
+      EXPECT_NEAR((NormalizeVector(vectors[i], accuracy) - expected).norm(),
+                  0.0f, 2.0f * max_error);
+    }
+  }
+}
+
+TEST(ReciprocalSqrt, CalculateAngleBetweenTwoVectors) {
+  const Eigen::Vector3f x = 3.0f * Eigen::Vector3f::UnitX();
+  const Eigen::Vector3f y = 5.0f * Eigen::Vector3f::UnitY();
+  constexpr float kRightAngleInRadians = 3.1416 / 2.0f;
+  EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, y, RSQRT_NEWTON),
+              kRightAngleInRadians, 1e-3);
+  // Parallel vectors must not produce NaN even if the estimate overshoots.
+  EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, 2.0f * x, RSQRT_ESTIMATE),
+              0.0f, 5e-2);
+  // A zero vector must give the same angle as the overload that normalizes.
+  const Eigen::Vector3f zero = Eigen::Vector3f::Zero();
+  EXPECT_FLOAT_EQ(CalculateAngleBetweenTwoVectors(zero, y, RSQRT_NEWTON),
+                  CalculateAngleBetweenTwoVectors(zero, y));
+  EXPECT_FLOAT_EQ(CalculateAngleBetweenTwoVectors(x, zero, RSQRT_ESTIMATE),
+                  CalculateAngleBetweenTwoVectors(x, zero));
+}
+
+// The squared norms of these vectors, and their products, underflow or
+// overflow a float even though the vectors themselves are representable.
+TEST(ReciprocalSqrt, HandlesTinyAndHugeVectors) {
+  constexpr float kRightAngleInRadians = 3.1416 / 2.0f;
+  constexpr float kPi = 3.1416;
+  for (const float magnitude : { 1e-30f, 1e-20f, 1e-10f, 1e10f, 1e20f,
+                                 1e30f }) {
+    const Eigen::Vector3f x = magnitude * Eigen::Vector3f(1.0f, 2.0f, -2.0f);
+    const Eigen::Vector3f y = magnitude * Eigen::Vector3f(2.0f, 1.0f, 2.0f);
+    for (const RsqrtAccuracy accuracy : { RSQRT_ESTIMATE, RSQRT_NEWTON,
+                                          RSQRT_FULL }) {
+      const float max_error = ReciprocalSqrtMaxRelativeError(accuracy);
+      const Eigen::Vector3f expected = Eigen::Vector3f(1.0f, 2.0f, -2.0f) / 3;
+      EXPECT_NEAR((NormalizeVector(x, accuracy) - expected).norm(), 0.0f,
+                  2.0f * max_error) << magnitude;
+      Vector3fBatch batch;
+      PackVector3fBatch({ x, y }, &batch);
+      NormalizeVectors(accuracy, &batch);
+      const Eigen::Vector3f result(batch.x[0], batch.y[0], batch.z[0]);
+      EXPECT_NEAR((result - expected).norm(), 0.0f, 2.0f * max_error)
+          << magnitude;
+
+      // Parallel, opposite and orthogonal vectors, also with a second vector
+      // of another magnitude.
+      EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, 2.0f * x, accuracy),
+                  0.0f, 5e-2) << magnitude;
+      EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, -x, accuracy),
+                  kPi, 5e-2) << magnitude;
+      EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, y, accuracy),
+                  kRightAngleInRadians, 1e-2) << magnitude;
+      EXPECT_NEAR(CalculateAngleBetweenTwoVectors(x, y / magnitude, accuracy),
+                  kRightAngleInRadians, 1e-2) << magnitude;
+    }
+  }
+}
+
 TEST_F(ShaderProgramTest, CreateProgramFromValidShaderSources) {
   ShaderProgram shader_program;
   EXPECT_TRUE(shader_program.LoadVertexShaderFromString(vertex_shader_src));
@@ -32,9 +32,21 @@
 // Please contact the author of this library if you have any questions.
 // Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
 
+// Draws a triangle. With --trace_output, the OpenGL calls of the first
+// --trace_frames frames are recorded into a trace for replay_gl_trace, and the
+// program exits after the capture. With --gl_debug_output, the context is a
+// debug context and its KHR_debug messages are logged with glog.
+//
+// Example:
+//
+// ./bin/draw_triangle --trace_output=/tmp/triangle.trace --trace_frames=100
+
+#include <stdint.h>
 #include <iostream>
 #include <string>
 
+#include <gflags/gflags.h>
+
 // The macro below tells the linker to use the GLEW library in a static way.
 // This is mainly for compatibility with Windows.
 // Glew is a library that "scans" and knows what "extensions" (i.e.,
@@ -48,8 +60,25 @@
 // See http://www.glfw.org/ for more information.
 #include <GLFW/glfw3.h>
 
+#include "gl_debug_output.h"
+#include "gl_state_cache.h"
+#include "gl_trace.h"
 #include "shader_program.h"
 
+// Use the right namespace for google flags (gflags).
+#ifdef GFLAGS_NAMESPACE_GOOGLE
+#define CS470_GFLAGS_NAMESPACE google
+#else
+#define CS470_GFLAGS_NAMESPACE gflags
+#endif
+
+DEFINE_string(trace_output, "",
+              "Filepath of the trace of the OpenGL calls. No trace is "
+              "recorded when empty.");
+DEFINE_int32(trace_frames, 100, "Number of frames to record.");
+DEFINE_bool(gl_debug_output, false,
+            "Create a debug context and log its KHR_debug messages.");
+
 // Annonymous namespace for constants and helper functions.
 namespace {
 // Window dimensions.
@@ -123,39 +152,44 @@ void SetWindowHints() {
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
   // Sets the property of resizability of a window.
   glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+  // Drivers may only report debug messages in debug contexts.
+  glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT,
+                 FLAGS_gl_debug_output ? GL_TRUE : GL_FALSE);
 }
 
 // Configures the view port.
 // Note: All the OpenGL functions begin with gl, and all the GLFW functions
 // begin with glfw. This is because they are C-functions -- C does not have
 // namespaces.
-void ConfigureViewPort(GLFWwindow* window) {
+void ConfigureViewPort(wvu::GLTraceRecorder* trace_recorder,
+                       GLFWwindow* window) {
   int width;
   int height;
   // We get the frame buffer dimensions and store them in width and height.
   glfwGetFramebufferSize(window, &width, &height);
   // Tells OpenGL the dimensions of the window and we specify the coordinates
   // of the lower left corner.
-  glViewport(0, 0, width, height);
+  trace_recorder->Viewport(0, 0, width, height);
 }
 
 // Clears the frame buffer.
-void ClearTheFrameBuffer() {
+void ClearTheFrameBuffer(wvu::GLTraceRecorder* trace_recorder) {
   // Sets the initial color of the framebuffer in the RGBA, R = Red, G = Green,
   // B = Blue, and A = alpha.
-  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  trace_recorder->ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   // Tells OpenGL to clear the Color buffer.
-  glClear(GL_COLOR_BUFFER_BIT);
+  trace_recorder->Clear(GL_COLOR_BUFFER_BIT);
 }
 
 // Creates and transfers the vertices into the GPU. Returns the vertex buffer
 // object id.
-GLuint SetVertexBufferObject() {
+GLuint SetVertexBufferObject(wvu::GLTraceRecorder* trace_recorder,
+                             wvu::GLStateCache* state_cache) {
   // Create a vertex buffer object (vbo).
   GLuint vertex_buffer_object_id;
-  glGenBuffers(1, &vertex_buffer_object_id);
+  trace_recorder->GenBuffer(&vertex_buffer_object_id);
   // Set the GL_ARRAY_BUFFER of OpenGL to the vbo we just created.
-  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_id);
+  state_cache->BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_id);
   // Copy the vertices into the GL_ARRAY_BUFFER that currently 'points' to our
   // recently created vbo. In this case, sizeof(vertices) returns the size of
   // the array vertices (defined above) in bytes.
@@ -168,60 +202,67 @@ GLuint SetVertexBufferObject() {
   // 2. GL_DYNAMIC_DRAW: the data will likely change.
   // 3. GL_STREAM_DRAW: the data will change every time it is drawn.
   // See https://www.opengl.org/sdk/docs/man/html/glBufferData.xhtml.
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  trace_recorder->BufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices,
+                             GL_STATIC_DRAW);
   // Inform OpenGL how the vertex buffer is arranged.
   constexpr GLuint kIndex = 0;  // Index of the first buffer array.
   constexpr GLuint kNumElementsInBuffer = 3;
   constexpr GLuint kBufferSize = kNumElementsInBuffer * sizeof(vertices[0]);
-  const GLvoid* offset_ptr = nullptr;
-  glVertexAttribPointer(kIndex, kNumElementsInBuffer, GL_FLOAT, GL_FALSE,
-                        kBufferSize, offset_ptr);
+  constexpr GLintptr kOffset = 0;
+  trace_recorder->VertexAttribPointer(kIndex, kNumElementsInBuffer, GL_FLOAT,
+                                      GL_FALSE, kBufferSize, kOffset);
   // Set as active our newly generated VBO.
-  glEnableVertexAttribArray(kIndex);
-  // Unbind buffer so that later we can use it.
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  trace_recorder->EnableVertexAttribArray(kIndex);
+  // The buffer stays bound. The state cache knows it, so there is no need to
+  // unbind it to keep later binds correct.
   return vertex_buffer_object_id;
 }
 
 // Creates and sets the vertex array object (VAO) for our triangle. Returns the
 // id of the created VAO.
-void SetVertexArrayObject(GLuint* vertex_buffer_object_id,
+void SetVertexArrayObject(wvu::GLTraceRecorder* trace_recorder,
+                          wvu::GLStateCache* state_cache,
+                          GLuint* vertex_buffer_object_id,
                           GLuint* vertex_array_object_id) {
-  // Create the vertex array object (VAO).
-  constexpr int kNumVertexArrays = 1;
-  // This function creates kNumVertexArrays vaos and stores the ids in the
-  // array pointed by the second argument.
-  glGenVertexArrays(kNumVertexArrays, vertex_array_object_id);
+  // Create the vertex array object (VAO). The recorder creates one VAO and
+  // stores its id in the variable pointed by the argument.
+  trace_recorder->GenVertexArray(vertex_array_object_id);
   // Set the recently created vertex array object (VAO) current.
-  glBindVertexArray(*vertex_array_object_id);
-  // Create the Vertex Buffer Object (VBO).
-  *vertex_buffer_object_id = SetVertexBufferObject();
-  // Disable our created VAO.
-  glBindVertexArray(0);
+  state_cache->BindVertexArray(*vertex_array_object_id);
+  // Create the Vertex Buffer Object (VBO). The VAO stays bound; every draw
+  // binds the VAO it needs through the state cache.
+  *vertex_buffer_object_id =
+      SetVertexBufferObject(trace_recorder, state_cache);
 }
 
 // Renders the scene.
 void RenderScene(const wvu::ShaderProgram& shader_program,
                  const GLuint vertex_array_object_id,
+                 wvu::GLTraceRecorder* trace_recorder,
+                 wvu::GLStateCache* state_cache,
                  GLFWwindow* window) {
   // Clear the buffer.
-  ClearTheFrameBuffer();
+  ClearTheFrameBuffer(trace_recorder);
+  // A flat triangle needs neither depth testing nor blending. The state cache
+  // drops these calls after the first frame.
+  state_cache->SetDepthTestEnabled(false);
+  state_cache->SetBlendEnabled(false);
   // Let OpenGL know that we want to use our shader program.
-  shader_program.Use();
+  state_cache->UseProgram(shader_program);
   // Draw the triangle.
-  // Let OpenGL know what vertex array object we will use.
-  glBindVertexArray(vertex_array_object_id);
+  // Let OpenGL know what vertex array object we will use. The VAO is not
+  // unbound after the draw, so the bind is dropped when it is already bound.
+  state_cache->BindVertexArray(vertex_array_object_id);
   // First argument specifies the primitive to use.
   // Second argument specifies the starting index in the VAO.
   // Third argument specified the number of vertices to use.
-  glDrawArrays(GL_TRIANGLES, 0, 3);
-  // Let OpenGL know that we are done with our vertex array object.
-  glBindVertexArray(0);
+  trace_recorder->DrawArrays(GL_TRIANGLES, 0, 3);
 }
 
 }  // namespace
 
 int main(int argc, char** argv) {
+  CS470_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
   // Initialize the GLFW library.
   if (!glfwInit()) {
     return -1;
@@ -258,14 +299,34 @@ int main(int argc, char** argv) {
     return -1;
   }
 
+  // Report the errors and warnings of the driver as they happen, instead of
+  // checking glGetError() after the calls.
+  wvu::GLDebugOutput debug_output;
+  std::string error_info_log;
+  if (FLAGS_gl_debug_output &&
+      !debug_output.Enable(wvu::GLDebugOutputOptions(), &error_info_log)) {
+    std::cerr << "ERROR: " << error_info_log << "\n";
+  }
+
+  // Start the capture before any object is created, so that the trace holds
+  // everything its frames use. Without a trace, the recorder only forwards the
+  // calls to OpenGL.
+  wvu::GLTraceRecorder trace_recorder;
+  if (!FLAGS_trace_output.empty() &&
+      !trace_recorder.Open(FLAGS_trace_output, FLAGS_trace_frames,
+                           &error_info_log)) {
+    std::cerr << "ERROR: " << error_info_log << "\n";
+    glfwTerminate();
+    return -1;
+  }
+
   // Configure View Port.
-  ConfigureViewPort(window);
+  ConfigureViewPort(&trace_recorder, window);
 
   // Compile shaders and create shader program.
   wvu::ShaderProgram shader_program;
   shader_program.LoadVertexShaderFromString(vertex_shader_src);
   shader_program.LoadFragmentShaderFromString(fragment_shader_src);
-  std::string error_info_log;
   if (!shader_program.Create(&error_info_log)) {
     std::cout << "ERROR: " << error_info_log << "\n";
   }
@@ -276,14 +337,31 @@ int main(int argc, char** argv) {
   }
 
   // Prepare buffers to hold the vertices in GPU.
+  wvu::GLStateCache state_cache(&trace_recorder);
   GLuint vertex_buffer_object_id;
   GLuint vertex_array_object_id;
-  SetVertexArrayObject(&vertex_buffer_object_id, &vertex_array_object_id);
+  SetVertexArrayObject(&trace_recorder, &state_cache,
+                       &vertex_buffer_object_id, &vertex_array_object_id);
 
   // Loop until the user closes the window.
+  uint64_t num_frames = 0;
+  uint64_t num_calls_issued = 0;
+  uint64_t num_calls_elided = 0;
   while (!glfwWindowShouldClose(window)) {
     // Render the scene!
-    RenderScene(shader_program, vertex_array_object_id, window);
+    state_cache.ResetCounters();
+    RenderScene(shader_program, vertex_array_object_id, &trace_recorder,
+                &state_cache, window);
+    const bool capturing = trace_recorder.is_capturing();
+    trace_recorder.EndFrame();
+    if (capturing && !trace_recorder.is_capturing()) {
+      std::cout << "Recorded " << trace_recorder.num_captured_frames()
+                << " frames into " << FLAGS_trace_output << "\n";
+      glfwSetWindowShouldClose(window, GL_TRUE);
+    }
+    ++num_frames;
+    num_calls_issued += state_cache.num_calls_issued();
+    num_calls_elided += state_cache.num_calls_elided();
 
     // Swap front and back buffers.
     glfwSwapBuffers(window);
@@ -292,9 +370,29 @@ int main(int argc, char** argv) {
     glfwPollEvents();
   }
 
-  // Cleaning up tasks.
-  glDeleteVertexArrays(1, &vertex_array_object_id);
-  glDeleteBuffers(1, &vertex_buffer_object_id);
+  // Report how many program binds Use() avoided.
+  std::cout << "Program binds issued: "
+            << wvu::ShaderProgram::num_program_binds_issued()
+            << ", skipped: "
+            << wvu::ShaderProgram::num_program_binds_skipped() << "\n";
+  // Report the state changes per frame. After the first frame, every call of
+  // the render loop is elided.
+  if (num_frames > 0) {
+    std::cout << "State calls per frame issued: "
+              << static_cast<double>(num_calls_issued) / num_frames
+              << ", elided: "
+              << static_cast<double>(num_calls_elided) / num_frames << "\n";
+  }
+
+  // Cleaning up tasks. A capture interrupted by closing the window keeps the
+  // frames recorded so far.
+  if (!trace_recorder.Close(&error_info_log)) {
+    std::cerr << "ERROR: " << error_info_log << "\n";
+  }
+  state_cache.DeleteVertexArray(vertex_array_object_id);
+  state_cache.DeleteBuffer(vertex_buffer_object_id);
+  // The callback must be removed while the context exists.
+  debug_output.Disable();
   // Destroy window.
   glfwDestroyWindow(window);
   // Tear down GLFW library.
@@ -0,0 +1,370 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// Benchmarks of the OpenGL modules. They time the paths that the modules speed
+// up against the paths they replace and log the results; they assert nothing
+// about the times, so they are not part of the tests that ctest runs.
+//
+// Example:
+//
+// ./bin/gl_benchmarks --gtest_filter=GLBenchmark.ProgramBinaryCache
+
+// C headers.
+#include <stdlib.h>
+
+// C++ headers.
+#include <chrono>
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "assignment.h"
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gpu_transform.h"
+#include "gtest/gtest.h"
+#include "shader_pipeline.h"
+#include "shader_preprocessor.h"
+#include "shader_program.h"
+#include "shader_variant_cache.h"
+#include "test/gl_test.h"
+#include "vertex_buffer_arena.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+
+// Draws a triangle that covers the viewport kNumFrames times with the program
+// and returns the seconds per frame.
+double DrawFullscreenFrames(ShaderProgram* shader_program) {
+  constexpr int kNumFrames = 20;
+  shader_program->Use();
+  shader_program->FlushUniforms();
+  // The first draw includes the work the driver defers until the program is
+  // used.
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glFinish();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumFrames; ++i) {
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
+  glFinish();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kNumFrames;
+}
+
+class GLBenchmark : public GLTest {};
+
+}  // namespace
+
+// Compares building programs from their sources with loading them from the
+// program binary cache, as a second launch would do.
+TEST_F(GLBenchmark, ProgramBinaryCache) {
+  char directory[] = "/tmp/shader_binary_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  ShaderProgram::SetBinaryCacheDirectory(directory);
+  constexpr int kNumPrograms = 20;
+  std::chrono::duration<double, std::milli> cold_time(0);
+  std::chrono::duration<double, std::milli> warm_time(0);
+  for (const bool warm : { false, true }) {
+    for (int i = 0; i < kNumPrograms; ++i) {
+      ShaderProgram shader_program;
+      shader_program.LoadVertexShaderFromString(vertex_shader_src);
+      shader_program.LoadFragmentShaderFromString(MakeFragmentShaderSource(i));
+      const auto start = std::chrono::steady_clock::now();
+      shader_program.Create(nullptr);
+      // Linking may be deferred by the driver until the program is used.
+      shader_program.Use();
+      glFinish();
+      const auto end = std::chrono::steady_clock::now();
+      (warm ? warm_time : cold_time) += end - start;
+    }
+  }
+  ShaderProgram::SetBinaryCacheDirectory("");
+  RemoveDirectory(directory);
+  LOG(INFO) << kNumPrograms << " programs. From sources: "
+            << cold_time.count() << " ms, from the binary cache: "
+            << warm_time.count() << " ms";
+}
+
+// Compares linking one program per combination of vertex and fragment shader
+// variants with linking one separable program per variant and combining them
+// in a program pipeline.
+TEST_F(GLBenchmark, SeparablePrograms) {
+  if (!IsSeparableProgramSupported()) {
+    LOG(INFO) << "Separable programs are not supported; skipping.";
+    return;
+  }
+  constexpr int kNumVertexVariants = 4;
+  constexpr int kNumFragmentVariants = 5;
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::vector<ShaderProgram> programs(kNumVertexVariants *
+                                        kNumFragmentVariants);
+    for (int i = 0; i < kNumVertexVariants; ++i) {
+      for (int j = 0; j < kNumFragmentVariants; ++j) {
+        ShaderProgram& program = programs[i * kNumFragmentVariants + j];
+        program.LoadVertexShaderFromString(MakeSeparableVertexShaderSource(i));
+        program.LoadFragmentShaderFromString(
+            MakeSeparableFragmentShaderSource(j));
+        program.Create(nullptr);
+        program.Use();
+      }
+    }
+    glFinish();
+  }
+  const std::chrono::duration<double, std::milli> combined_time =
+      std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  {
+    std::vector<SeparableShaderProgram> vertex_stages(kNumVertexVariants);
+    std::vector<SeparableShaderProgram> fragment_stages(kNumFragmentVariants);
+    for (int i = 0; i < kNumVertexVariants; ++i) {
+      vertex_stages[i].Create(GL_VERTEX_SHADER,
+                              MakeSeparableVertexShaderSource(i), nullptr);
+    }
+    for (int j = 0; j < kNumFragmentVariants; ++j) {
+      fragment_stages[j].Create(GL_FRAGMENT_SHADER,
+                                MakeSeparableFragmentShaderSource(j), nullptr);
+    }
+    ShaderProgramPipeline pipeline;
+    pipeline.Create();
+    for (int i = 0; i < kNumVertexVariants; ++i) {
+      for (int j = 0; j < kNumFragmentVariants; ++j) {
+        pipeline.UseStage(vertex_stages[i]);
+        pipeline.UseStage(fragment_stages[j]);
+        pipeline.Use();
+      }
+    }
+    glFinish();
+    glBindProgramPipeline(0);
+  }
+  const std::chrono::duration<double, std::milli> separable_time =
+      std::chrono::steady_clock::now() - start;
+  LOG(INFO) << kNumVertexVariants << "x" << kNumFragmentVariants
+            << " combinations. Programs per combination: "
+            << combined_time.count() << " ms, separable programs: "
+            << separable_time.count() << " ms";
+}
+
+// Compares the throughput of transforming points one at a time on the CPU with
+// transforming them with a compute shader, with the points already on the GPU.
+TEST_F(GLBenchmark, GpuTransform) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  GpuTransform gpu_transform;
+  std::string error_info_log;
+  ASSERT_TRUE(gpu_transform.Initialize(&error_info_log)) << error_info_log;
+  const Eigen::Matrix4f transformation = Eigen::Matrix4f::Random();
+
+  for (const int num_points : { 1 << 10, 1 << 14, 1 << 18 }) {
+    const Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, num_points);
+
+    auto start = std::chrono::steady_clock::now();
+    Eigen::Matrix4Xf cpu_points(4, num_points);
+    for (int i = 0; i < num_points; ++i) {
+      cpu_points.col(i) = MultiplyVectorAndMatrix(transformation,
+                                                  points.col(i));
+    }
+    const std::chrono::duration<double> cpu_time =
+        std::chrono::steady_clock::now() - start;
+
+    const GLsizeiptr num_bytes = points.size() * sizeof(float);
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[0]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, num_bytes, points.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, num_bytes, nullptr, GL_DYNAMIC_DRAW);
+    // Warm up, so the timing excludes the first use of the buffers.
+    gpu_transform.Transform(transformation, buffers[0], buffers[1],
+                            num_points);
+    glFinish();
+    start = std::chrono::steady_clock::now();
+    gpu_transform.Transform(transformation, buffers[0], buffers[1],
+                            num_points);
+    glFinish();
+    const std::chrono::duration<double> gpu_time =
+        std::chrono::steady_clock::now() - start;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glDeleteBuffers(2, buffers);
+
+    LOG(INFO) << num_points << " points. CPU: "
+              << num_points / cpu_time.count() / 1e6 << " Mpoints/s, GPU: "
+              << num_points / gpu_time.count() / 1e6 << " Mpoints/s";
+  }
+}
+
+// Compares the cost per pixel of a fill-bound shader that reads its light
+// count and fog toggle from uniforms with a variant that bakes them in as
+// constants.
+TEST_F(GLBenchmark, BakedShaderVariants) {
+  ShaderVariantCache variants(ShaderPreprocessor(),
+                              fullscreen_vertex_shader_src,
+                              lights_fragment_shader_src);
+  std::string error_info_log;
+  ShaderProgram* uniform_program =
+      variants.GetVariant(ShaderDefines(), &error_info_log);
+  ASSERT_NE(uniform_program, nullptr) << error_info_log;
+  ShaderConstants constants;
+  constants["num_lights"] = "8";
+  constants["use_fog"] = "true";
+  ShaderProgram* baked_program =
+      variants.GetVariant(ShaderDefines(), constants, &error_info_log);
+  ASSERT_NE(baked_program, nullptr) << error_info_log;
+
+  constexpr int kSize = 256;
+  GLuint texture = 0, framebuffer = 0, vertex_array = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kSize, kSize, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  glGenVertexArrays(1, &vertex_array);
+  glBindVertexArray(vertex_array);
+  glViewport(0, 0, kSize, kSize);
+
+  uniform_program->SetUniform(uniform_program->GetUniformHandle("num_lights"),
+                              8);
+  uniform_program->SetUniform(uniform_program->GetUniformHandle("use_fog"), 1);
+  uniform_program->SetUniform(
+      uniform_program->GetUniformHandle("fog_density"), 0.25f);
+  baked_program->SetUniform(baked_program->GetUniformHandle("fog_density"),
+                            0.25f);
+  const double uniform_seconds = DrawFullscreenFrames(uniform_program);
+  const double baked_seconds = DrawFullscreenFrames(baked_program);
+  constexpr double kNumPixels = kSize * kSize;
+  LOG(INFO) << "Per pixel: uniforms " << 1e9 * uniform_seconds / kNumPixels
+            << " ns, baked constants " << 1e9 * baked_seconds / kNumPixels
+            << " ns, speedup: " << uniform_seconds / baked_seconds << "x";
+
+  glBindVertexArray(0);
+  glDeleteVertexArrays(1, &vertex_array);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+}
+
+// Compares submitting many small meshes that live in a buffer per mesh, which
+// needs a bind per draw, with submitting them from a vertex buffer arena.
+TEST_F(GLBenchmark, VertexBufferArena) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+
+  constexpr int kWidth = 4;
+  GLuint texture = 0, framebuffer = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kWidth, 1, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  glViewport(0, 0, kWidth, 1);
+
+  // Many one-point meshes, one per pixel and repeated.
+  constexpr int kNumMeshes = 4096;
+  VertexBufferArena arena;
+  std::string error_info_log;
+  ASSERT_TRUE(arena.Initialize(3 * sizeof(GLfloat), kNumMeshes,
+                               &error_info_log)) << error_info_log;
+  std::vector<VertexBufferArena::Slice> slices(kNumMeshes);
+  std::vector<GLuint> buffers(kNumMeshes), vertex_arrays(kNumMeshes);
+  glGenBuffers(kNumMeshes, buffers.data());
+  glGenVertexArrays(kNumMeshes, vertex_arrays.data());
+  for (int i = 0; i < kNumMeshes; ++i) {
+    const GLfloat vertex[3] = {
+      (2.0f * (i % kWidth) + 1.0f) / kWidth - 1.0f, 0.0f, 0.0f
+    };
+    ASSERT_TRUE(arena.Allocate(vertex, 1, &slices[i]));
+    // The same mesh in its own buffer, as draw_triangle creates them.
+    glBindVertexArray(vertex_arrays[i]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), vertex, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex), nullptr);
+    glEnableVertexAttribArray(0);
+  }
+  GLuint arena_vertex_array = 0;
+  glGenVertexArrays(1, &arena_vertex_array);
+  glBindVertexArray(arena_vertex_array);
+  glBindBuffer(GL_ARRAY_BUFFER, arena.buffer_id(0));
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat),
+                        nullptr);
+  glEnableVertexAttribArray(0);
+
+  ASSERT_TRUE(shader_program.Use());
+  glFinish();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumMeshes; ++i) {
+    glBindVertexArray(vertex_arrays[i]);
+    glDrawArrays(GL_POINTS, 0, 1);
+  }
+  glFinish();
+  const std::chrono::duration<double, std::milli> dedicated_time =
+      std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  glBindVertexArray(arena_vertex_array);
+  for (int i = 0; i < kNumMeshes; ++i) {
+    glDrawArrays(GL_POINTS, slices[i].base_vertex, slices[i].num_vertices);
+  }
+  glFinish();
+  const std::chrono::duration<double, std::milli> arena_time =
+      std::chrono::steady_clock::now() - start;
+  LOG(INFO) << kNumMeshes << " meshes. Buffer per mesh: "
+            << dedicated_time.count() << " ms, arena: "
+            << arena_time.count() << " ms";
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDeleteVertexArrays(1, &arena_vertex_array);
+  glDeleteVertexArrays(kNumMeshes, vertex_arrays.data());
+  glDeleteBuffers(kNumMeshes, buffers.data());
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+}
+
+}  // namespace wvu
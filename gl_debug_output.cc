@@ -0,0 +1,203 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "gl_debug_output.h"
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <GL/glew.h>
+
+#include "glog/logging.h"
+
+namespace wvu {
+namespace {
+// The severities from the most to the least severe.
+constexpr GLenum kSeverities[] = {
+  GL_DEBUG_SEVERITY_HIGH,
+  GL_DEBUG_SEVERITY_MEDIUM,
+  GL_DEBUG_SEVERITY_LOW,
+  GL_DEBUG_SEVERITY_NOTIFICATION
+};
+
+// Returns the name of the source of a message.
+const char* SourceName(const GLenum source) {
+  switch (source) {
+    case GL_DEBUG_SOURCE_API:
+      return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+      return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:
+      return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:
+      return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION:
+      return "application";
+    default:
+      return "other";
+  }
+}
+
+// Returns the name of the type of a message.
+const char* TypeName(const GLenum type) {
+  switch (type) {
+    case GL_DEBUG_TYPE_ERROR:
+      return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+      return "deprecated behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+      return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:
+      return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:
+      return "performance";
+    case GL_DEBUG_TYPE_MARKER:
+      return "marker";
+    default:
+      return "other";
+  }
+}
+
+}  // namespace
+
+GLDebugOutput::GLDebugOutput()
+    : enabled_(false), num_messages_logged_(0), num_messages_throttled_(0) {}
+
+GLDebugOutput::~GLDebugOutput() {
+  Disable();
+}
+
+bool GLDebugOutput::Enable(const GLDebugOutputOptions& options,
+                           std::string* error_info_log) {
+  if (!GLEW_KHR_debug) {
+    if (error_info_log) {
+      *error_info_log = "KHR_debug is not supported.";
+    }
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    message_counts_.clear();
+  }
+  glDebugMessageCallback(&GLDebugOutput::OnMessage, this);
+  // Let the driver drop the messages below the minimum severity, so that
+  // they never reach the callback.
+  bool enabled = true;
+  for (const GLenum severity : kSeverities) {
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr,
+                          enabled ? GL_TRUE : GL_FALSE);
+    if (severity == options.min_severity) {
+      enabled = false;
+    }
+  }
+  if (options.synchronous) {
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  } else {
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  }
+  glEnable(GL_DEBUG_OUTPUT);
+  enabled_ = true;
+  return true;
+}
+
+void GLDebugOutput::Disable() {
+  if (!enabled_) {
+    return;
+  }
+  glDisable(GL_DEBUG_OUTPUT);
+  glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(nullptr, nullptr);
+  enabled_ = false;
+}
+
+uint64_t GLDebugOutput::num_messages_logged() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_messages_logged_;
+}
+
+uint64_t GLDebugOutput::num_messages_throttled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_messages_throttled_;
+}
+
+void GLAPIENTRY GLDebugOutput::OnMessage(GLenum source,
+                                         GLenum type,
+                                         GLuint id,
+                                         GLenum severity,
+                                         GLsizei length,
+                                         const GLchar* message,
+                                         const void* user_param) {
+  GLDebugOutput* debug_output =
+      static_cast<GLDebugOutput*>(const_cast<void*>(user_param));
+  // A negative length means the message is null-terminated.
+  debug_output->LogMessage(source, type, id, severity,
+                           length < 0 ? std::string(message) :
+                           std::string(message, length));
+}
+
+void GLDebugOutput::LogMessage(const GLenum source,
+                               const GLenum type,
+                               const GLuint id,
+                               const GLenum severity,
+                               const std::string& message) {
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    count = ++message_counts_[std::make_tuple(source, type, id)];
+    if (count > options_.max_messages_per_id) {
+      ++num_messages_throttled_;
+      return;
+    }
+    ++num_messages_logged_;
+  }
+  const std::string text = std::string("OpenGL ") + SourceName(source) +
+      " " + TypeName(type) + " " + std::to_string(id) + ": " + message +
+      (count == options_.max_messages_per_id ?
+       " (further occurrences are not logged)" : "");
+  switch (severity) {
+    case GL_DEBUG_SEVERITY_HIGH:
+      LOG(ERROR) << text;
+      break;
+    case GL_DEBUG_SEVERITY_MEDIUM:
+      LOG(WARNING) << text;
+      break;
+    default:
+      LOG(INFO) << text;
+      break;
+  }
+}
+
+}  // namespace wvu
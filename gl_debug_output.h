@@ -0,0 +1,140 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_GL_DEBUG_OUTPUT_H_
+#define GLUTILS_GL_DEBUG_OUTPUT_H_
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <GL/glew.h>
+
+namespace wvu {
+// Options of the debug output.
+struct GLDebugOutputOptions {
+  GLDebugOutputOptions() :
+      min_severity(GL_DEBUG_SEVERITY_MEDIUM), max_messages_per_id(10),
+      synchronous(false) {}
+  // The least severe messages that are logged: GL_DEBUG_SEVERITY_HIGH,
+  // GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW or
+  // GL_DEBUG_SEVERITY_NOTIFICATION. The driver drops the rest, so they are
+  // never formatted.
+  GLenum min_severity;
+  // Number of times a message, identified by its source, type and id, is
+  // logged. Later occurrences are only counted.
+  int max_messages_per_id;
+  // If true, the messages are delivered in the call that raised them, so a
+  // breakpoint in the callback shows the offending call. This serializes the
+  // driver like glGetError() does, so keep it off while profiling.
+  bool synchronous;
+};
+
+// This class routes the KHR_debug messages of the current context into glog,
+// replacing the glGetError() checks after every call. The driver reports the
+// errors, performance warnings and other messages asynchronously through a
+// callback, so the pipeline is not serialized. High severity messages are
+// logged as errors, medium severity messages as warnings and the rest as info.
+// A message that repeats, e.g., a warning raised by every draw, is throttled
+// after options.max_messages_per_id occurrences.
+// Nothing is installed until Enable() is called, so a disabled debug output
+// costs nothing. Drivers may only report messages in debug contexts, see the
+// GLFW_OPENGL_DEBUG_CONTEXT window hint.
+//
+// Example.
+//
+// glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+// GLFWwindow* window = glfwCreateWindow(...);
+// ...  // Make the context current and initialize GLEW.
+// wvu::GLDebugOutput debug_output;
+// if (FLAGS_gl_debug_output &&
+//     !debug_output.Enable(wvu::GLDebugOutputOptions(), &error_info_log)) {
+//   LOG(ERROR) << error_info_log;
+// }
+class GLDebugOutput {
+ public:
+  GLDebugOutput();
+  // Disables the debug output if enabled, so the context must be current.
+  ~GLDebugOutput();
+
+  // Installs the callback in the current context. Returns true if successful,
+  // and false otherwise, e.g., when KHR_debug is not supported, in which case
+  // error_info_log holds the reason.
+  bool Enable(const GLDebugOutputOptions& options,
+              std::string* error_info_log);
+
+  // Removes the callback from the current context.
+  void Disable();
+
+  bool is_enabled() const {
+    return enabled_;
+  }
+
+  // Returns the number of messages logged and the number of messages dropped
+  // by the throttling.
+  uint64_t num_messages_logged() const;
+  uint64_t num_messages_throttled() const;
+
+ private:
+  // The callback given to glDebugMessageCallback(). The user parameter is the
+  // instance.
+  static void GLAPIENTRY OnMessage(GLenum source,
+                                   GLenum type,
+                                   GLuint id,
+                                   GLenum severity,
+                                   GLsizei length,
+                                   const GLchar* message,
+                                   const void* user_param);
+
+  // Logs the message unless it is throttled.
+  void LogMessage(const GLenum source,
+                  const GLenum type,
+                  const GLuint id,
+                  const GLenum severity,
+                  const std::string& message);
+
+  bool enabled_;
+  GLDebugOutputOptions options_;
+  // The driver may call the callback from its own threads.
+  mutable std::mutex mutex_;
+  // Occurrences of every message, keyed by source, type and id.
+  std::map<std::tuple<GLenum, GLenum, GLuint>, int> message_counts_;
+  uint64_t num_messages_logged_;
+  uint64_t num_messages_throttled_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_GL_DEBUG_OUTPUT_H_
@@ -0,0 +1,89 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+
+// System specific headers.
+#include "gl_debug_output.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class GLDebugOutputTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(GLDebugOutputTest, LogsDebugMessages) {
+  if (!GLEW_KHR_debug) {
+    LOG(INFO) << "Debug output is not supported; skipping.";
+    return;
+  }
+  GLDebugOutput debug_output;
+  GLDebugOutputOptions options;
+  options.max_messages_per_id = 10;
+  // Deliver the messages within the calls, so they are counted on return.
+  options.synchronous = true;
+  std::string error_info_log;
+  ASSERT_TRUE(debug_output.Enable(options, &error_info_log))
+      << error_info_log;
+  const std::string message = "Repeated warning";
+  for (int i = 0; i < 15; ++i) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, 1,
+                         GL_DEBUG_SEVERITY_MEDIUM, message.size(),
+                         message.c_str());
+  }
+  EXPECT_EQ(debug_output.num_messages_logged(), 10);
+  EXPECT_EQ(debug_output.num_messages_throttled(), 5);
+
+  // Messages below the minimum severity never reach the callback.
+  glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, 2,
+                       GL_DEBUG_SEVERITY_LOW, -1, "Low severity");
+  EXPECT_EQ(debug_output.num_messages_logged(), 10);
+
+  // Errors of the driver are reported without glGetError().
+  glBindBuffer(GL_ARRAY_BUFFER, ~0u);
+  EXPECT_EQ(debug_output.num_messages_logged(), 11);
+  EXPECT_EQ(glGetError(), GL_INVALID_OPERATION);
+
+  debug_output.Disable();
+  EXPECT_FALSE(glIsEnabled(GL_DEBUG_OUTPUT));
+  glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, 3,
+                       GL_DEBUG_SEVERITY_HIGH, -1, "Not logged");
+  EXPECT_EQ(debug_output.num_messages_logged(), 11);
+}
+
+}  // namespace wvu
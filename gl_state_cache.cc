@@ -0,0 +1,196 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "gl_state_cache.h"
+
+#include <GL/glew.h>
+
+#include "gl_trace.h"
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// The value of a state that the cache does not know. No object name or enum
+// has this value.
+constexpr GLuint kUnknown = ~0u;
+
+}  // namespace
+
+GLStateCache::GLStateCache(GLTraceRecorder* trace_recorder)
+    : trace_recorder_(trace_recorder ?
+                      trace_recorder : GLTraceRecorder::PassThrough()),
+      num_calls_issued_(0), num_calls_elided_(0) {
+  Invalidate();
+}
+
+void GLStateCache::Invalidate() {
+  vertex_array_ = kUnknown;
+  for (int i = 0; i < NUM_BUFFER_TARGETS; ++i) {
+    buffers_[i] = kUnknown;
+  }
+  blend_ = TOGGLE_UNKNOWN;
+  blend_source_factor_ = kUnknown;
+  blend_destination_factor_ = kUnknown;
+  depth_test_ = TOGGLE_UNKNOWN;
+  depth_func_ = kUnknown;
+  depth_mask_ = TOGGLE_UNKNOWN;
+  ShaderProgram::InvalidateCurrentProgram();
+}
+
+void GLStateCache::BindVertexArray(const GLuint vertex_array) {
+  if (Update(vertex_array, &vertex_array_)) {
+    trace_recorder_->BindVertexArray(vertex_array);
+    buffers_[ELEMENT_ARRAY_BUFFER] = kUnknown;
+  }
+}
+
+void GLStateCache::BindBuffer(const GLenum target, const GLuint buffer) {
+  GLuint* cached_buffer = nullptr;
+  switch (target) {
+    case GL_ARRAY_BUFFER:
+      cached_buffer = &buffers_[ARRAY_BUFFER];
+      break;
+    case GL_ELEMENT_ARRAY_BUFFER:
+      cached_buffer = &buffers_[ELEMENT_ARRAY_BUFFER];
+      break;
+    default:
+      ++num_calls_issued_;
+      trace_recorder_->BindBuffer(target, buffer);
+      return;
+  }
+  if (Update(buffer, cached_buffer)) {
+    trace_recorder_->BindBuffer(target, buffer);
+  }
+}
+
+void GLStateCache::DeleteVertexArray(const GLuint vertex_array) {
+  trace_recorder_->DeleteVertexArray(vertex_array);
+  if (vertex_array_ == vertex_array) {
+    vertex_array_ = 0;
+    // The element array buffer binding of the default vertex array is not
+    // known.
+    buffers_[ELEMENT_ARRAY_BUFFER] = kUnknown;
+  }
+}
+
+void GLStateCache::DeleteBuffer(const GLuint buffer) {
+  trace_recorder_->DeleteBuffer(buffer);
+  for (int i = 0; i < NUM_BUFFER_TARGETS; ++i) {
+    if (buffers_[i] == buffer) {
+      buffers_[i] = 0;
+    }
+  }
+}
+
+bool GLStateCache::UseProgram(const ShaderProgram& shader_program) {
+  const bool in_use = shader_program.shader_program_id() != 0 &&
+      ShaderProgram::current_program_id() == shader_program.shader_program_id();
+  if (!shader_program.Use()) {
+    return false;
+  }
+  if (in_use) {
+    ++num_calls_elided_;
+  } else {
+    ++num_calls_issued_;
+    trace_recorder_->RecordUseProgram(shader_program);
+  }
+  return true;
+}
+
+void GLStateCache::SetBlendEnabled(const bool enabled) {
+  SetCapability(GL_BLEND, enabled, &blend_);
+}
+
+void GLStateCache::SetBlendFunc(const GLenum source_factor,
+                                const GLenum destination_factor) {
+  if (source_factor == blend_source_factor_ &&
+      destination_factor == blend_destination_factor_) {
+    ++num_calls_elided_;
+    return;
+  }
+  ++num_calls_issued_;
+  blend_source_factor_ = source_factor;
+  blend_destination_factor_ = destination_factor;
+  trace_recorder_->BlendFunc(source_factor, destination_factor);
+}
+
+void GLStateCache::SetDepthTestEnabled(const bool enabled) {
+  SetCapability(GL_DEPTH_TEST, enabled, &depth_test_);
+}
+
+void GLStateCache::SetDepthFunc(const GLenum depth_func) {
+  if (Update(depth_func, &depth_func_)) {
+    trace_recorder_->DepthFunc(depth_func);
+  }
+}
+
+void GLStateCache::SetDepthMask(const bool enabled) {
+  const Toggle toggle = enabled ? TOGGLE_ENABLED : TOGGLE_DISABLED;
+  if (toggle == depth_mask_) {
+    ++num_calls_elided_;
+    return;
+  }
+  ++num_calls_issued_;
+  depth_mask_ = toggle;
+  trace_recorder_->DepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+bool GLStateCache::Update(const GLuint value, GLuint* cached_value) {
+  if (*cached_value == value) {
+    ++num_calls_elided_;
+    return false;
+  }
+  ++num_calls_issued_;
+  *cached_value = value;
+  return true;
+}
+
+void GLStateCache::SetCapability(const GLenum capability,
+                                 const bool enabled,
+                                 Toggle* toggle) {
+  const Toggle new_toggle = enabled ? TOGGLE_ENABLED : TOGGLE_DISABLED;
+  if (*toggle == new_toggle) {
+    ++num_calls_elided_;
+    return;
+  }
+  ++num_calls_issued_;
+  *toggle = new_toggle;
+  if (enabled) {
+    trace_recorder_->Enable(capability);
+  } else {
+    trace_recorder_->Disable(capability);
+  }
+}
+
+}  // namespace wvu
@@ -0,0 +1,166 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_GL_STATE_CACHE_H_
+#define GLUTILS_GL_STATE_CACHE_H_
+
+#include <stdint.h>
+#include <GL/glew.h>
+
+#include "gl_trace.h"
+#include "shader_program.h"
+
+namespace wvu {
+// This class mirrors the OpenGL state that the render loop changes the most,
+// i.e., the vertex array, the buffer bindings, the program, blending and depth
+// testing, and drops the calls that would set the state it already has. The
+// render loop then binds what every draw needs without unbinding afterwards,
+// and only the changes reach the driver.
+// The cache starts with every state unknown, so the first call of every kind
+// is issued. The program binding is the one tracked by ShaderProgram::Use().
+// Changing the tracked state without the cache, e.g., by calling
+// glBindVertexArray() directly or by making another context current, requires
+// a call to Invalidate(). Use one instance per context from the thread that has
+// the context current. The calls reach OpenGL through the given trace recorder,
+// so a capture records only the calls that were not elided.
+//
+// Example.
+//
+// wvu::GLStateCache state_cache;
+// while (...) {  // Rendering loop.
+//   state_cache.ResetCounters();
+//   state_cache.SetDepthTestEnabled(true);
+//   for (const DrawableObject& object : objects) {
+//     state_cache.UseProgram(*object.shader_program);
+//     state_cache.BindVertexArray(object.vertex_array_object_id);
+//     glDrawArrays(...);
+//   }
+//   LOG(INFO) << state_cache.num_calls_issued() << " calls issued, "
+//             << state_cache.num_calls_elided() << " calls elided.";
+// }
+class GLStateCache {
+ public:
+  // Issues the calls through the trace recorder, which must outlive the cache.
+  // A null recorder issues them directly.
+  explicit GLStateCache(GLTraceRecorder* trace_recorder = nullptr);
+
+  // Forgets the whole state, so that the next call of every kind is issued.
+  void Invalidate();
+
+  // Binds the vertex array object. Since the element array buffer binding is
+  // part of the vertex array object, a change of vertex array also forgets
+  // that binding.
+  void BindVertexArray(const GLuint vertex_array);
+
+  // Binds the buffer to the target. The GL_ARRAY_BUFFER and
+  // GL_ELEMENT_ARRAY_BUFFER targets are cached; the rest are always issued.
+  // The generic GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER targets are not
+  // cached since UniformBufferRing, GpuTransform and
+  // ShaderProgram::BindShaderStorageBuffer() rebind them on their own.
+  void BindBuffer(const GLenum target, const GLuint buffer);
+
+  // Deletes the vertex array or the buffer and forgets its bindings, as OpenGL
+  // unbinds deleted objects.
+  void DeleteVertexArray(const GLuint vertex_array);
+  void DeleteBuffer(const GLuint buffer);
+
+  // Makes the program current with ShaderProgram::Use(). Returns false if the
+  // program is not created.
+  bool UseProgram(const ShaderProgram& shader_program);
+
+  // Blending state, see glEnable(GL_BLEND) and glBlendFunc().
+  void SetBlendEnabled(const bool enabled);
+  void SetBlendFunc(const GLenum source_factor,
+                    const GLenum destination_factor);
+
+  // Depth state, see glEnable(GL_DEPTH_TEST), glDepthFunc() and glDepthMask().
+  void SetDepthTestEnabled(const bool enabled);
+  void SetDepthFunc(const GLenum depth_func);
+  void SetDepthMask(const bool enabled);
+
+  // Returns the number of OpenGL calls issued and the number of calls dropped
+  // because the state already had the value, since the last ResetCounters().
+  uint64_t num_calls_issued() const {
+    return num_calls_issued_;
+  }
+  uint64_t num_calls_elided() const {
+    return num_calls_elided_;
+  }
+
+  // Sets both counters to zero, e.g., at the beginning of every frame.
+  void ResetCounters() {
+    num_calls_issued_ = 0;
+    num_calls_elided_ = 0;
+  }
+
+ private:
+  // The cached buffer targets.
+  enum BufferTarget {
+    ARRAY_BUFFER = 0,
+    ELEMENT_ARRAY_BUFFER,
+    NUM_BUFFER_TARGETS
+  };
+
+  // A cached boolean state.
+  enum Toggle {
+    TOGGLE_UNKNOWN,
+    TOGGLE_DISABLED,
+    TOGGLE_ENABLED
+  };
+
+  // Returns true if the value differs from the cached one, and caches it.
+  // Counts the call as issued or elided accordingly.
+  bool Update(const GLuint value, GLuint* cached_value);
+
+  // Enables or disables the capability if the cached toggle differs.
+  void SetCapability(const GLenum capability,
+                     const bool enabled,
+                     Toggle* toggle);
+
+  GLTraceRecorder* trace_recorder_;
+  GLuint vertex_array_;
+  GLuint buffers_[NUM_BUFFER_TARGETS];
+  Toggle blend_;
+  GLuint blend_source_factor_;
+  GLuint blend_destination_factor_;
+  Toggle depth_test_;
+  GLuint depth_func_;
+  Toggle depth_mask_;
+  uint64_t num_calls_issued_;
+  uint64_t num_calls_elided_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_GL_STATE_CACHE_H_
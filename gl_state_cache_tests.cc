@@ -0,0 +1,184 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+
+// System specific headers.
+#include "gl_state_cache.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+#include "uniform_buffer_ring.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class GLStateCacheTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(GLStateCacheTest, StateCacheElidesRedundantCalls) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  GLuint vertex_arrays[2];
+  GLuint buffers[2];
+  glGenVertexArrays(2, vertex_arrays);
+  glGenBuffers(2, buffers);
+
+  // Every state is unknown at first, so the first calls are issued.
+  GLStateCache state_cache;
+  state_cache.UseProgram(shader_program);
+  state_cache.BindVertexArray(vertex_arrays[0]);
+  state_cache.BindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  state_cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  state_cache.SetBlendEnabled(true);
+  state_cache.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  state_cache.SetDepthTestEnabled(true);
+  state_cache.SetDepthFunc(GL_LEQUAL);
+  state_cache.SetDepthMask(false);
+  EXPECT_EQ(state_cache.num_calls_issued(), 9);
+  EXPECT_EQ(state_cache.num_calls_elided(), 0);
+
+  // Simulate frames that set the same state.
+  constexpr int kNumFrames = 10;
+  state_cache.ResetCounters();
+  for (int i = 0; i < kNumFrames; ++i) {
+    state_cache.UseProgram(shader_program);
+    state_cache.BindVertexArray(vertex_arrays[0]);
+    state_cache.BindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    state_cache.SetBlendEnabled(true);
+    state_cache.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache.SetDepthTestEnabled(true);
+    state_cache.SetDepthFunc(GL_LEQUAL);
+    state_cache.SetDepthMask(false);
+  }
+  EXPECT_EQ(state_cache.num_calls_issued(), 0);
+  EXPECT_EQ(state_cache.num_calls_elided(), 8 * kNumFrames);
+
+  // The cached state is the state of OpenGL.
+  GLint value = 0;
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+  EXPECT_EQ(value, vertex_arrays[0]);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value);
+  EXPECT_EQ(value, buffers[0]);
+  glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &value);
+  EXPECT_EQ(value, buffers[1]);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+  EXPECT_EQ(value, shader_program.shader_program_id());
+  glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+  EXPECT_EQ(value, GL_SRC_ALPHA);
+  glGetIntegerv(GL_DEPTH_FUNC, &value);
+  EXPECT_EQ(value, GL_LEQUAL);
+  GLboolean depth_mask = GL_TRUE;
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+  EXPECT_EQ(depth_mask, GL_FALSE);
+  EXPECT_TRUE(glIsEnabled(GL_BLEND));
+  EXPECT_TRUE(glIsEnabled(GL_DEPTH_TEST));
+
+  // The element array buffer belongs to the vertex array, so it is bound again
+  // after a change of vertex array.
+  state_cache.ResetCounters();
+  state_cache.BindVertexArray(vertex_arrays[1]);
+  state_cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  state_cache.BindVertexArray(vertex_arrays[0]);
+  state_cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  EXPECT_EQ(state_cache.num_calls_issued(), 4);
+
+  // Deleted objects are unbound.
+  state_cache.DeleteBuffer(buffers[0]);
+  state_cache.ResetCounters();
+  state_cache.BindBuffer(GL_ARRAY_BUFFER, 0);
+  EXPECT_EQ(state_cache.num_calls_elided(), 1);
+  state_cache.DeleteVertexArray(vertex_arrays[0]);
+  state_cache.BindVertexArray(0);
+  EXPECT_EQ(state_cache.num_calls_elided(), 2);
+
+  // After an invalidation every call is issued again.
+  state_cache.Invalidate();
+  state_cache.ResetCounters();
+  state_cache.UseProgram(shader_program);
+  state_cache.SetBlendEnabled(false);
+  state_cache.SetDepthTestEnabled(false);
+  state_cache.SetDepthMask(true);
+  EXPECT_EQ(state_cache.num_calls_issued(), 4);
+  EXPECT_FALSE(glIsEnabled(GL_BLEND));
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  state_cache.DeleteVertexArray(vertex_arrays[1]);
+  state_cache.DeleteBuffer(buffers[1]);
+}
+
+// UniformBufferRing binds the generic uniform buffer target by itself, so the
+// cache must not elide a later bind of that target.
+TEST_F(GLStateCacheTest, IssuesUniformBufferBindsAfterUniformBufferRing) {
+  if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+    LOG(INFO) << "Buffer storage is not supported; skipping.";
+    return;
+  }
+  UniformBufferRing uniform_ring;
+  std::string error_info_log;
+  ASSERT_TRUE(uniform_ring.Initialize(1 << 16, &error_info_log))
+      << error_info_log;
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+
+  GLStateCache state_cache;
+  state_cache.BindBuffer(GL_UNIFORM_BUFFER, buffer);
+  UniformBufferRing::Block block;
+  ASSERT_TRUE(uniform_ring.Allocate(64, &block));
+  uniform_ring.BindBlock(0, block);
+  state_cache.ResetCounters();
+  state_cache.BindBuffer(GL_UNIFORM_BUFFER, buffer);
+  EXPECT_EQ(state_cache.num_calls_issued(), 1);
+  EXPECT_EQ(state_cache.num_calls_elided(), 0);
+  GLint value = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &value);
+  EXPECT_EQ(value, buffer);
+
+  // The same holds for the indexed binds of the shader storage target.
+  if (GLEW_ARB_shader_storage_buffer_object) {
+    state_cache.BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, uniform_ring.buffer_id());
+    state_cache.BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_BINDING, &value);
+    EXPECT_EQ(value, buffer);
+  }
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  state_cache.DeleteBuffer(buffer);
+}
+
+}  // namespace wvu
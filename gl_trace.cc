@@ -0,0 +1,821 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "gl_trace.h"
+
+#include <string.h>  // For memcpy.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// Identifies the trace files.
+constexpr char kTraceMagic[] = "WVUGLTRACE1";
+
+// The recorded calls. Every record holds the opcode, the number of arguments,
+// the arguments as 32-bit words and then the payloads of the call, each one
+// preceded by its size.
+enum TraceOpcode {
+  TRACE_END_FRAME = 0,
+  TRACE_VIEWPORT,
+  TRACE_CLEAR_COLOR,
+  TRACE_CLEAR,
+  TRACE_GEN_BUFFER,
+  TRACE_BIND_BUFFER,
+  // Arguments: target, size, usage and whether the payload holds the data.
+  TRACE_BUFFER_DATA,
+  TRACE_DELETE_BUFFER,
+  TRACE_GEN_VERTEX_ARRAY,
+  TRACE_BIND_VERTEX_ARRAY,
+  TRACE_DELETE_VERTEX_ARRAY,
+  TRACE_VERTEX_ATTRIB_POINTER,
+  TRACE_ENABLE_VERTEX_ATTRIB_ARRAY,
+  TRACE_ENABLE,
+  TRACE_DISABLE,
+  TRACE_BLEND_FUNC,
+  TRACE_DEPTH_FUNC,
+  TRACE_DEPTH_MASK,
+  TRACE_DRAW_ARRAYS,
+  // Payloads: the vertex and the fragment shader sources.
+  TRACE_CREATE_PROGRAM,
+  TRACE_USE_PROGRAM,
+  // Arguments: the ShaderProgram::UniformUpload. Payloads: the name of the
+  // uniform of the program in use and the raw bits of its value.
+  TRACE_UNIFORM,
+  // Arguments: the binding. Payload: the name of the uniform block of the
+  // program in use.
+  TRACE_UNIFORM_BLOCK_BINDING,
+  // Arguments: the binding. Payload: the contents of the bound range.
+  TRACE_BIND_UNIFORM_BUFFER_RANGE,
+  // Arguments: target and offset. Payload: the data.
+  TRACE_BUFFER_SUB_DATA,
+  TRACE_DRAW_ELEMENTS,
+  TRACE_DRAW_ELEMENTS_BASE_VERTEX,
+  NUM_TRACE_OPCODES
+};
+
+// The maximum number of arguments of a record.
+constexpr int kMaxNumArguments = 6;
+
+// Returns the number of payloads that follow the arguments of a record.
+int NumPayloads(const uint8_t opcode) {
+  switch (opcode) {
+    case TRACE_BUFFER_DATA:
+    case TRACE_UNIFORM_BLOCK_BINDING:
+    case TRACE_BIND_UNIFORM_BUFFER_RANGE:
+    case TRACE_BUFFER_SUB_DATA:
+      return 1;
+    case TRACE_CREATE_PROGRAM:
+    case TRACE_UNIFORM:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+// Returns the number of words of a uniform value uploaded with the function.
+int NumUniformValues(const ShaderProgram::UniformUpload upload) {
+  switch (upload) {
+    case ShaderProgram::UNIFORM_2FV:
+      return 2;
+    case ShaderProgram::UNIFORM_3FV:
+      return 3;
+    case ShaderProgram::UNIFORM_4FV:
+      return 4;
+    case ShaderProgram::UNIFORM_MATRIX_3FV:
+      return 9;
+    case ShaderProgram::UNIFORM_MATRIX_4FV:
+      return 16;
+    default:
+      return 1;
+  }
+}
+
+// Returns the bits of a float as a word.
+uint32_t FloatBits(const GLfloat value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Returns the float whose bits are the word.
+GLfloat BitsFloat(const uint32_t bits) {
+  GLfloat value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Reads a value of type T at the position and advances it. Returns false if
+// the trace ends before.
+template <typename T>
+bool ReadValue(const std::string& trace, size_t* position, T* value) {
+  if (trace.size() - *position < sizeof(*value)) {
+    return false;
+  }
+  memcpy(value, &trace[*position], sizeof(*value));
+  *position += sizeof(*value);
+  return true;
+}
+
+// Returns true if the program can be rebuilt from the sources the trace
+// records.
+bool IsReproducible(const ShaderProgram& shader_program,
+                    std::string* error_info_log) {
+  if (shader_program.uses_spirv() || shader_program.is_compute()) {
+    *error_info_log = "The trace cannot record SPIR-V or compute programs.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+GLTraceRecorder::GLTraceRecorder()
+    : capturing_(false), num_frames_(0), num_captured_frames_(0),
+      write_succeeded_(true), num_recorded_programs_(0) {}
+
+GLTraceRecorder::~GLTraceRecorder() {
+  Close(nullptr);
+}
+
+GLTraceRecorder* GLTraceRecorder::PassThrough() {
+  static GLTraceRecorder* recorder = new GLTraceRecorder;
+  return recorder;
+}
+
+bool GLTraceRecorder::Open(const std::string& filepath,
+                           const int num_frames,
+                           std::string* error_info_log) {
+  Close(nullptr);
+  file_.open(filepath, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    if (error_info_log) {
+      *error_info_log = "Could not open " + filepath;
+    }
+    return false;
+  }
+  file_.write(kTraceMagic, sizeof(kTraceMagic));
+  capturing_ = num_frames > 0;
+  num_frames_ = num_frames;
+  num_captured_frames_ = 0;
+  write_succeeded_ = static_cast<bool>(file_);
+  capture_error_.clear();
+  records_.clear();
+  recorded_programs_.clear();
+  num_recorded_programs_ = 0;
+  return true;
+}
+
+bool GLTraceRecorder::Close(std::string* error_info_log) {
+  // The trace closes by itself after the last frame, so a later call still
+  // reports how the capture went.
+  if (file_.is_open()) {
+    Flush();
+    file_.close();
+    capturing_ = false;
+    write_succeeded_ = write_succeeded_ && !file_.fail();
+  }
+  if (!write_succeeded_ && error_info_log) {
+    *error_info_log = "Could not write the trace.";
+  }
+  if (!capture_error_.empty() && error_info_log) {
+    *error_info_log = capture_error_;
+  }
+  return write_succeeded_ && capture_error_.empty();
+}
+
+void GLTraceRecorder::EndFrame() {
+  if (!capturing_) {
+    return;
+  }
+  Record(TRACE_END_FRAME, {});
+  Flush();
+  ++num_captured_frames_;
+  if (num_captured_frames_ == num_frames_) {
+    Close(nullptr);
+  }
+}
+
+void GLTraceRecorder::Viewport(const GLint x,
+                               const GLint y,
+                               const GLsizei width,
+                               const GLsizei height) {
+  glViewport(x, y, width, height);
+  if (capturing_) {
+    Record(TRACE_VIEWPORT, {static_cast<uint32_t>(x), static_cast<uint32_t>(y),
+                            static_cast<uint32_t>(width),
+                            static_cast<uint32_t>(height)});
+  }
+}
+
+void GLTraceRecorder::ClearColor(const GLfloat red,
+                                 const GLfloat green,
+                                 const GLfloat blue,
+                                 const GLfloat alpha) {
+  glClearColor(red, green, blue, alpha);
+  if (capturing_) {
+    Record(TRACE_CLEAR_COLOR, {FloatBits(red), FloatBits(green),
+                               FloatBits(blue), FloatBits(alpha)});
+  }
+}
+
+void GLTraceRecorder::Clear(const GLbitfield mask) {
+  glClear(mask);
+  if (capturing_) {
+    Record(TRACE_CLEAR, {mask});
+  }
+}
+
+void GLTraceRecorder::GenBuffer(GLuint* buffer) {
+  glGenBuffers(1, buffer);
+  if (capturing_) {
+    Record(TRACE_GEN_BUFFER, {*buffer});
+  }
+}
+
+void GLTraceRecorder::BindBuffer(const GLenum target, const GLuint buffer) {
+  glBindBuffer(target, buffer);
+  if (capturing_) {
+    Record(TRACE_BIND_BUFFER, {target, buffer});
+  }
+}
+
+void GLTraceRecorder::BufferData(const GLenum target,
+                                 const GLsizeiptr size,
+                                 const void* data,
+                                 const GLenum usage) {
+  glBufferData(target, size, data, usage);
+  if (capturing_) {
+    Record(TRACE_BUFFER_DATA, {target, static_cast<uint32_t>(size), usage,
+                               data != nullptr});
+    RecordPayload(data, data ? size : 0);
+  }
+}
+
+void GLTraceRecorder::BufferSubData(const GLenum target,
+                                    const GLintptr offset,
+                                    const GLsizeiptr size,
+                                    const void* data) {
+  glBufferSubData(target, offset, size, data);
+  if (capturing_) {
+    Record(TRACE_BUFFER_SUB_DATA, {target, static_cast<uint32_t>(offset)});
+    RecordPayload(data, size);
+  }
+}
+
+void GLTraceRecorder::DeleteBuffer(const GLuint buffer) {
+  glDeleteBuffers(1, &buffer);
+  if (capturing_) {
+    Record(TRACE_DELETE_BUFFER, {buffer});
+  }
+}
+
+void GLTraceRecorder::GenVertexArray(GLuint* vertex_array) {
+  glGenVertexArrays(1, vertex_array);
+  if (capturing_) {
+    Record(TRACE_GEN_VERTEX_ARRAY, {*vertex_array});
+  }
+}
+
+void GLTraceRecorder::BindVertexArray(const GLuint vertex_array) {
+  glBindVertexArray(vertex_array);
+  if (capturing_) {
+    Record(TRACE_BIND_VERTEX_ARRAY, {vertex_array});
+  }
+}
+
+void GLTraceRecorder::DeleteVertexArray(const GLuint vertex_array) {
+  glDeleteVertexArrays(1, &vertex_array);
+  if (capturing_) {
+    Record(TRACE_DELETE_VERTEX_ARRAY, {vertex_array});
+  }
+}
+
+void GLTraceRecorder::VertexAttribPointer(const GLuint index,
+                                          const GLint size,
+                                          const GLenum type,
+                                          const GLboolean normalized,
+                                          const GLsizei stride,
+                                          const GLintptr offset) {
+  glVertexAttribPointer(index, size, type, normalized, stride,
+                        reinterpret_cast<const GLvoid*>(offset));
+  if (capturing_) {
+    Record(TRACE_VERTEX_ATTRIB_POINTER,
+           {index, static_cast<uint32_t>(size), type, normalized,
+            static_cast<uint32_t>(stride), static_cast<uint32_t>(offset)});
+  }
+}
+
+void GLTraceRecorder::EnableVertexAttribArray(const GLuint index) {
+  glEnableVertexAttribArray(index);
+  if (capturing_) {
+    Record(TRACE_ENABLE_VERTEX_ATTRIB_ARRAY, {index});
+  }
+}
+
+void GLTraceRecorder::Enable(const GLenum capability) {
+  glEnable(capability);
+  if (capturing_) {
+    Record(TRACE_ENABLE, {capability});
+  }
+}
+
+void GLTraceRecorder::Disable(const GLenum capability) {
+  glDisable(capability);
+  if (capturing_) {
+    Record(TRACE_DISABLE, {capability});
+  }
+}
+
+void GLTraceRecorder::BlendFunc(const GLenum source_factor,
+                                const GLenum destination_factor) {
+  glBlendFunc(source_factor, destination_factor);
+  if (capturing_) {
+    Record(TRACE_BLEND_FUNC, {source_factor, destination_factor});
+  }
+}
+
+void GLTraceRecorder::DepthFunc(const GLenum depth_func) {
+  glDepthFunc(depth_func);
+  if (capturing_) {
+    Record(TRACE_DEPTH_FUNC, {depth_func});
+  }
+}
+
+void GLTraceRecorder::DepthMask(const GLboolean enabled) {
+  glDepthMask(enabled);
+  if (capturing_) {
+    Record(TRACE_DEPTH_MASK, {enabled});
+  }
+}
+
+void GLTraceRecorder::DrawArrays(const GLenum mode,
+                                 const GLint first,
+                                 const GLsizei count) {
+  glDrawArrays(mode, first, count);
+  if (capturing_) {
+    Record(TRACE_DRAW_ARRAYS, {mode, static_cast<uint32_t>(first),
+                               static_cast<uint32_t>(count)});
+  }
+}
+
+void GLTraceRecorder::DrawElements(const GLenum mode,
+                                   const GLsizei count,
+                                   const GLenum type,
+                                   const GLintptr offset) {
+  glDrawElements(mode, count, type, reinterpret_cast<const GLvoid*>(offset));
+  if (capturing_) {
+    Record(TRACE_DRAW_ELEMENTS, {mode, static_cast<uint32_t>(count), type,
+                                 static_cast<uint32_t>(offset)});
+  }
+}
+
+void GLTraceRecorder::DrawElementsBaseVertex(const GLenum mode,
+                                             const GLsizei count,
+                                             const GLenum type,
+                                             const GLintptr offset,
+                                             const GLint base_vertex) {
+  glDrawElementsBaseVertex(mode, count, type,
+                           reinterpret_cast<const GLvoid*>(offset),
+                           base_vertex);
+  if (capturing_) {
+    Record(TRACE_DRAW_ELEMENTS_BASE_VERTEX,
+           {mode, static_cast<uint32_t>(count), type,
+            static_cast<uint32_t>(offset), static_cast<uint32_t>(base_vertex)});
+  }
+}
+
+void GLTraceRecorder::BindUniformBufferRange(const GLuint binding,
+                                             const GLuint buffer,
+                                             const GLintptr offset,
+                                             const GLsizeiptr size,
+                                             const void* contents) {
+  glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+  if (capturing_) {
+    Record(TRACE_BIND_UNIFORM_BUFFER_RANGE, {binding});
+    RecordPayload(contents, size);
+  }
+}
+
+int GLTraceRecorder::FlushUniforms(ShaderProgram* shader_program) {
+  if (capturing_) {
+    for (const ShaderProgram::UniformHandle handle :
+             shader_program->dirty_uniforms()) {
+      RecordUniform(*shader_program, handle);
+    }
+  }
+  return shader_program->FlushUniforms();
+}
+
+void GLTraceRecorder::RecordUseProgram(const ShaderProgram& shader_program) {
+  if (!capturing_) {
+    return;
+  }
+  if (!IsReproducible(shader_program, &capture_error_)) {
+    // Keep the frames recorded so far, which do not use the program.
+    records_.clear();
+    Close(nullptr);
+    return;
+  }
+  const std::string& vertex_shader_src = shader_program.vertex_shader_src();
+  const std::string& fragment_shader_src = shader_program.fragment_shader_src();
+  const auto inserted = recorded_programs_.emplace(
+      shader_program.shader_program_id(), RecordedProgram());
+  RecordedProgram& recorded_program = inserted.first->second;
+  // A name recorded with other sources belongs to a deleted program.
+  const bool new_program = inserted.second ||
+      recorded_program.vertex_shader_src != vertex_shader_src ||
+      recorded_program.fragment_shader_src != fragment_shader_src;
+  if (new_program) {
+    recorded_program.vertex_shader_src = vertex_shader_src;
+    recorded_program.fragment_shader_src = fragment_shader_src;
+    recorded_program.trace_name = num_recorded_programs_++;
+    Record(TRACE_CREATE_PROGRAM, {recorded_program.trace_name});
+    RecordPayload(vertex_shader_src.data(), vertex_shader_src.size());
+    RecordPayload(fragment_shader_src.data(), fragment_shader_src.size());
+  }
+  Record(TRACE_USE_PROGRAM, {recorded_program.trace_name});
+  if (new_program) {
+    RecordProgramState(shader_program);
+  }
+}
+
+void GLTraceRecorder::RecordProgramState(const ShaderProgram& shader_program) {
+  const GLuint program_id = shader_program.shader_program_id();
+  GLint num_uniform_blocks = 0;
+  glGetProgramiv(program_id, GL_ACTIVE_UNIFORM_BLOCKS, &num_uniform_blocks);
+  for (GLint i = 0; i < num_uniform_blocks; ++i) {
+    GLint name_length = 0;
+    GLint binding = 0;
+    glGetActiveUniformBlockiv(program_id, i, GL_UNIFORM_BLOCK_NAME_LENGTH,
+                              &name_length);
+    glGetActiveUniformBlockiv(program_id, i, GL_UNIFORM_BLOCK_BINDING,
+                              &binding);
+    std::string name(name_length, '\0');
+    GLsizei length = 0;
+    glGetActiveUniformBlockName(program_id, i, name_length, &length, &name[0]);
+    name.resize(length);
+    Record(TRACE_UNIFORM_BLOCK_BINDING, {static_cast<uint32_t>(binding)});
+    RecordPayload(name.data(), name.size());
+  }
+  // The dirty uniforms are recorded when they are flushed.
+  const std::vector<ShaderProgram::UniformHandle>& dirty_uniforms =
+      shader_program.dirty_uniforms();
+  for (size_t i = 0; i < shader_program.uniforms().size(); ++i) {
+    const ShaderProgram::UniformHandle handle = static_cast<int>(i);
+    if (std::find(dirty_uniforms.begin(), dirty_uniforms.end(), handle) ==
+        dirty_uniforms.end()) {
+      RecordUniform(shader_program, handle);
+    }
+  }
+}
+
+void GLTraceRecorder::RecordUniform(const ShaderProgram& shader_program,
+                                    const ShaderProgram::UniformHandle handle) {
+  ShaderProgram::UniformUpload upload;
+  const uint32_t* values = nullptr;
+  if (!shader_program.GetUniformValue(handle, &upload, &values)) {
+    return;
+  }
+  const std::string& name = shader_program.uniforms()[handle].name;
+  Record(TRACE_UNIFORM, {static_cast<uint32_t>(upload)});
+  RecordPayload(name.data(), name.size());
+  RecordPayload(values, NumUniformValues(upload) * sizeof(*values));
+}
+
+void GLTraceRecorder::Record(
+    const uint8_t opcode, const std::initializer_list<uint32_t>& arguments) {
+  records_.push_back(static_cast<char>(opcode));
+  records_.push_back(static_cast<char>(arguments.size()));
+  for (const uint32_t argument : arguments) {
+    const char* bytes = reinterpret_cast<const char*>(&argument);
+    records_.insert(records_.end(), bytes, bytes + sizeof(argument));
+  }
+}
+
+void GLTraceRecorder::RecordPayload(const void* data, const size_t size) {
+  const uint32_t payload_size = static_cast<uint32_t>(size);
+  const char* size_bytes = reinterpret_cast<const char*>(&payload_size);
+  records_.insert(records_.end(), size_bytes,
+                  size_bytes + sizeof(payload_size));
+  const char* bytes = static_cast<const char*>(data);
+  records_.insert(records_.end(), bytes, bytes + size);
+}
+
+void GLTraceRecorder::Flush() {
+  if (!records_.empty()) {
+    file_.write(records_.data(), records_.size());
+    write_succeeded_ = write_succeeded_ && static_cast<bool>(file_);
+    records_.clear();
+  }
+}
+
+GLTraceReplayer::~GLTraceReplayer() {
+  for (const auto& buffer : buffers_) {
+    glDeleteBuffers(1, &buffer.second);
+  }
+  for (const auto& vertex_array : vertex_arrays_) {
+    glDeleteVertexArrays(1, &vertex_array.second);
+  }
+  for (const auto& uniform_buffer : uniform_buffers_) {
+    glDeleteBuffers(1, &uniform_buffer.second);
+  }
+}
+
+bool GLTraceReplayer::Load(const std::string& filepath,
+                           std::string* error_info_log) {
+  std::string trace;
+  std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+  if (!in.is_open()) {
+    if (error_info_log) {
+      *error_info_log = "Could not open " + filepath;
+    }
+    return false;
+  }
+  trace.resize(in.tellg());
+  in.seekg(0);
+  in.read(&trace[0], trace.size());
+  if (!in || trace.compare(0, sizeof(kTraceMagic),
+                           std::string(kTraceMagic,
+                                       sizeof(kTraceMagic))) != 0) {
+    if (error_info_log) {
+      *error_info_log = filepath + " is not a trace.";
+    }
+    return false;
+  }
+
+  frames_.clear();
+  payloads_.clear();
+  std::vector<Call> frame;
+  // The program in use at the current record, which owns the uniforms that the
+  // next records name.
+  ShaderProgram* current_program = nullptr;
+  size_t position = sizeof(kTraceMagic);
+  while (position < trace.size()) {
+    Call call = Call();
+    uint8_t num_arguments = 0;
+    bool valid = ReadValue(trace, &position, &call.opcode) &&
+        call.opcode < NUM_TRACE_OPCODES &&
+        ReadValue(trace, &position, &num_arguments) &&
+        num_arguments <= kMaxNumArguments;
+    for (int i = 0; valid && i < num_arguments; ++i) {
+      valid = ReadValue(trace, &position, &call.arguments[i]);
+    }
+    call.payload = NumPayloads(call.opcode) > 0 ?
+        static_cast<int>(payloads_.size()) : -1;
+    for (int i = 0; valid && i < NumPayloads(call.opcode); ++i) {
+      uint32_t payload_size = 0;
+      valid = ReadValue(trace, &position, &payload_size) &&
+          trace.size() - position >= payload_size;
+      if (valid) {
+        payloads_.push_back(trace.substr(position, payload_size));
+        position += payload_size;
+      }
+    }
+    if (!valid) {
+      if (error_info_log) {
+        *error_info_log = filepath + " is truncated or corrupted.";
+      }
+      return false;
+    }
+    if (call.opcode == TRACE_UNIFORM &&
+        (call.arguments[0] > ShaderProgram::UNIFORM_MATRIX_4FV ||
+         payloads_[call.payload + 1].size() !=
+         NumUniformValues(static_cast<ShaderProgram::UniformUpload>(
+             call.arguments[0])) * sizeof(uint32_t))) {
+      if (error_info_log) {
+        *error_info_log = filepath + " is truncated or corrupted.";
+      }
+      return false;
+    }
+    if (call.opcode == TRACE_END_FRAME) {
+      frames_.push_back(std::move(frame));
+      frame.clear();
+    } else if (call.opcode == TRACE_USE_PROGRAM) {
+      const auto program = programs_.find(call.arguments[0]);
+      current_program =
+          program == programs_.end() ? nullptr : program->second.get();
+      frame.push_back(call);
+    } else if (call.opcode == TRACE_UNIFORM) {
+      // Resolve the location now, so that no frame looks it up. Uniforms that
+      // the program does not use get location -1, which OpenGL ignores.
+      const ShaderProgram::UniformHandle handle = current_program ?
+          current_program->GetUniformHandle(payloads_[call.payload]) :
+          ShaderProgram::kInvalidUniformHandle;
+      const GLint location =
+          handle == ShaderProgram::kInvalidUniformHandle ?
+          -1 : current_program->uniforms()[handle].location;
+      call.arguments[1] = static_cast<uint32_t>(location);
+      frame.push_back(call);
+    } else if (call.opcode == TRACE_UNIFORM_BLOCK_BINDING) {
+      // The binding is part of the program, so it is set once now.
+      if (current_program) {
+        current_program->SetUniformBlockBinding(payloads_[call.payload],
+                                                call.arguments[0]);
+      }
+    } else if (call.opcode == TRACE_BIND_UNIFORM_BUFFER_RANGE) {
+      GLuint& uniform_buffer = uniform_buffers_[call.arguments[0]];
+      if (uniform_buffer == 0) {
+        glGenBuffers(1, &uniform_buffer);
+      }
+      frame.push_back(call);
+    } else if (call.opcode == TRACE_CREATE_PROGRAM) {
+      // Build the programs now, so that no frame includes a compilation.
+      std::unique_ptr<ShaderProgram> program(new ShaderProgram);
+      program->LoadVertexShaderFromString(payloads_[call.payload]);
+      program->LoadFragmentShaderFromString(payloads_[call.payload + 1]);
+      if (!program->Create(error_info_log)) {
+        return false;
+      }
+      programs_[call.arguments[0]] = std::move(program);
+    } else {
+      frame.push_back(call);
+    }
+  }
+  // A capture that ended early leaves an incomplete frame; it is dropped.
+  return true;
+}
+
+double GLTraceReplayer::ReplayFrame(const int frame) {
+  const auto start = std::chrono::steady_clock::now();
+  for (const Call& call : frames_[frame]) {
+    const uint32_t* arguments = call.arguments;
+    switch (call.opcode) {
+      case TRACE_VIEWPORT:
+        glViewport(arguments[0], arguments[1], arguments[2], arguments[3]);
+        break;
+      case TRACE_CLEAR_COLOR:
+        glClearColor(BitsFloat(arguments[0]), BitsFloat(arguments[1]),
+                     BitsFloat(arguments[2]), BitsFloat(arguments[3]));
+        break;
+      case TRACE_CLEAR:
+        glClear(arguments[0]);
+        break;
+      case TRACE_GEN_BUFFER: {
+        // Replaying the frame again creates the object again, so the object
+        // of the previous replay is deleted.
+        GLuint& buffer = buffers_[arguments[0]];
+        if (buffer != 0) {
+          glDeleteBuffers(1, &buffer);
+        }
+        glGenBuffers(1, &buffer);
+        break;
+      }
+      case TRACE_BIND_BUFFER:
+        glBindBuffer(arguments[0], MapName(buffers_, arguments[1]));
+        break;
+      case TRACE_BUFFER_DATA:
+        glBufferData(arguments[0], arguments[1],
+                     arguments[3] ? payloads_[call.payload].data() : nullptr,
+                     arguments[2]);
+        break;
+      case TRACE_DELETE_BUFFER: {
+        const GLuint buffer = MapName(buffers_, arguments[0]);
+        glDeleteBuffers(1, &buffer);
+        buffers_.erase(arguments[0]);
+        break;
+      }
+      case TRACE_GEN_VERTEX_ARRAY: {
+        GLuint& vertex_array = vertex_arrays_[arguments[0]];
+        if (vertex_array != 0) {
+          glDeleteVertexArrays(1, &vertex_array);
+        }
+        glGenVertexArrays(1, &vertex_array);
+        break;
+      }
+      case TRACE_BIND_VERTEX_ARRAY:
+        glBindVertexArray(MapName(vertex_arrays_, arguments[0]));
+        break;
+      case TRACE_DELETE_VERTEX_ARRAY: {
+        const GLuint vertex_array = MapName(vertex_arrays_, arguments[0]);
+        glDeleteVertexArrays(1, &vertex_array);
+        vertex_arrays_.erase(arguments[0]);
+        break;
+      }
+      case TRACE_VERTEX_ATTRIB_POINTER:
+        glVertexAttribPointer(
+            arguments[0], arguments[1], arguments[2], arguments[3],
+            arguments[4],
+            reinterpret_cast<const GLvoid*>(
+                static_cast<uintptr_t>(arguments[5])));
+        break;
+      case TRACE_ENABLE_VERTEX_ATTRIB_ARRAY:
+        glEnableVertexAttribArray(arguments[0]);
+        break;
+      case TRACE_ENABLE:
+        glEnable(arguments[0]);
+        break;
+      case TRACE_DISABLE:
+        glDisable(arguments[0]);
+        break;
+      case TRACE_BLEND_FUNC:
+        glBlendFunc(arguments[0], arguments[1]);
+        break;
+      case TRACE_DEPTH_FUNC:
+        glDepthFunc(arguments[0]);
+        break;
+      case TRACE_DEPTH_MASK:
+        glDepthMask(arguments[0]);
+        break;
+      case TRACE_DRAW_ARRAYS:
+        glDrawArrays(arguments[0], arguments[1], arguments[2]);
+        break;
+      case TRACE_USE_PROGRAM: {
+        const auto program = programs_.find(arguments[0]);
+        if (program != programs_.end()) {
+          program->second->Use();
+        }
+        break;
+      }
+      case TRACE_UNIFORM: {
+        uint32_t values[16];
+        const std::string& payload = payloads_[call.payload + 1];
+        memcpy(values, payload.data(), payload.size());
+        ShaderProgram::UploadUniform(
+            static_cast<GLint>(arguments[1]),
+            static_cast<ShaderProgram::UniformUpload>(arguments[0]), values);
+        break;
+      }
+      case TRACE_BIND_UNIFORM_BUFFER_RANGE: {
+        // Every bind uploads the recorded contents into the buffer of the
+        // binding. Respecifying the whole buffer lets the draws that still
+        // read the previous contents keep them.
+        const GLuint uniform_buffer = MapName(uniform_buffers_, arguments[0]);
+        const std::string& contents = payloads_[call.payload];
+        glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffer);
+        glBufferData(GL_UNIFORM_BUFFER, contents.size(), contents.data(),
+                     GL_STREAM_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, arguments[0], uniform_buffer);
+        break;
+      }
+      case TRACE_BUFFER_SUB_DATA: {
+        const std::string& data = payloads_[call.payload];
+        glBufferSubData(arguments[0], arguments[1], data.size(), data.data());
+        break;
+      }
+      case TRACE_DRAW_ELEMENTS:
+        glDrawElements(arguments[0], arguments[1], arguments[2],
+                       reinterpret_cast<const GLvoid*>(
+                           static_cast<uintptr_t>(arguments[3])));
+        break;
+      case TRACE_DRAW_ELEMENTS_BASE_VERTEX:
+        glDrawElementsBaseVertex(arguments[0], arguments[1], arguments[2],
+                                 reinterpret_cast<const GLvoid*>(
+                                     static_cast<uintptr_t>(arguments[3])),
+                                 static_cast<GLint>(arguments[4]));
+        break;
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+GLuint GLTraceReplayer::MapName(
+    const std::unordered_map<uint32_t, GLuint>& names,
+    const uint32_t name) const {
+  const auto mapped_name = names.find(name);
+  return mapped_name == names.end() ? 0 : mapped_name->second;
+}
+
+}  // namespace wvu
@@ -0,0 +1,286 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_GL_TRACE_H_
+#define GLUTILS_GL_TRACE_H_
+
+#include <stdint.h>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+
+#include "shader_program.h"
+
+namespace wvu {
+// This class issues the OpenGL calls of a render loop and, while capturing,
+// records them with their payloads, i.e., the buffer data and the shader
+// sources, into a compact binary trace. Frames are delimited by EndFrame().
+// The capture starts with Open() and stops after the requested number of
+// frames, so open the trace before creating the objects the frames use. When
+// not capturing, the calls go straight to OpenGL at the cost of a branch.
+// Only the calls wrapped by the class are recorded; GLStateCache,
+// UniformBufferRing and VertexBufferArena issue their calls through a recorder,
+// so the trace holds the calls that reach the driver. Uniforms reach the trace
+// through FlushUniforms(), which records the values it uploads, and uniform
+// blocks through BindUniformBufferRange(), which records the contents of the
+// bound range instead of the writes through mapped pointers. The trace cannot
+// reproduce compute programs or programs built from SPIR-V modules, and using
+// one of them ends the capture with an error.
+//
+// Example.
+//
+// wvu::GLTraceRecorder trace_recorder;
+// trace_recorder.Open("/tmp/frames.trace", 100, &error_info_log);
+// wvu::GLStateCache state_cache(&trace_recorder);
+// ...  // Create the objects through trace_recorder.
+// while (...) {  // Rendering loop.
+//   trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+//   state_cache.UseProgram(shader_program);
+//   shader_program.SetUniformMatrix4(model_handle, model_matrix.data());
+//   trace_recorder.FlushUniforms(&shader_program);
+//   trace_recorder.DrawArrays(GL_TRIANGLES, 0, 3);
+//   trace_recorder.EndFrame();
+// }
+class GLTraceRecorder {
+ public:
+  GLTraceRecorder();
+  ~GLTraceRecorder();
+
+  // Returns a recorder that never captures, shared by the users that do not
+  // record a trace.
+  static GLTraceRecorder* PassThrough();
+
+  // Starts capturing num_frames frames into the file, which is overwritten.
+  // Returns true if successful, and false otherwise, in which case
+  // error_info_log holds the reason.
+  bool Open(const std::string& filepath,
+            const int num_frames,
+            std::string* error_info_log);
+
+  // Ends the capture before the requested number of frames. Returns true if
+  // the whole trace was written, and false otherwise, e.g., if the capture
+  // ended because a frame used a program the trace cannot reproduce. The
+  // destructor closes the trace too.
+  bool Close(std::string* error_info_log);
+
+  // Marks the end of a frame. The records of the frame are written to the file
+  // and, after the last frame, the trace is closed.
+  void EndFrame();
+
+  bool is_capturing() const {
+    return capturing_;
+  }
+  int num_captured_frames() const {
+    return num_captured_frames_;
+  }
+
+  // Wrapped OpenGL calls. They take the same arguments as the OpenGL
+  // functions, except that the functions that create objects create one.
+  void Viewport(const GLint x,
+                const GLint y,
+                const GLsizei width,
+                const GLsizei height);
+  void ClearColor(const GLfloat red,
+                  const GLfloat green,
+                  const GLfloat blue,
+                  const GLfloat alpha);
+  void Clear(const GLbitfield mask);
+  void GenBuffer(GLuint* buffer);
+  void BindBuffer(const GLenum target, const GLuint buffer);
+  void BufferData(const GLenum target,
+                  const GLsizeiptr size,
+                  const void* data,
+                  const GLenum usage);
+  void BufferSubData(const GLenum target,
+                     const GLintptr offset,
+                     const GLsizeiptr size,
+                     const void* data);
+  void DeleteBuffer(const GLuint buffer);
+  void GenVertexArray(GLuint* vertex_array);
+  void BindVertexArray(const GLuint vertex_array);
+  void DeleteVertexArray(const GLuint vertex_array);
+  void VertexAttribPointer(const GLuint index,
+                           const GLint size,
+                           const GLenum type,
+                           const GLboolean normalized,
+                           const GLsizei stride,
+                           const GLintptr offset);
+  void EnableVertexAttribArray(const GLuint index);
+  void Enable(const GLenum capability);
+  void Disable(const GLenum capability);
+  void BlendFunc(const GLenum source_factor, const GLenum destination_factor);
+  void DepthFunc(const GLenum depth_func);
+  void DepthMask(const GLboolean enabled);
+  void DrawArrays(const GLenum mode, const GLint first, const GLsizei count);
+  void DrawElements(const GLenum mode,
+                    const GLsizei count,
+                    const GLenum type,
+                    const GLintptr offset);
+  void DrawElementsBaseVertex(const GLenum mode,
+                              const GLsizei count,
+                              const GLenum type,
+                              const GLintptr offset,
+                              const GLint base_vertex);
+
+  // Binds the range of the buffer to the uniform buffer binding, as
+  // glBindBufferRange(GL_UNIFORM_BUFFER, ...) does. The trace records the
+  // contents of the range, so the caller passes them, e.g., the data of a
+  // UniformBufferRing block.
+  void BindUniformBufferRange(const GLuint binding,
+                              const GLuint buffer,
+                              const GLintptr offset,
+                              const GLsizeiptr size,
+                              const void* contents);
+
+  // Uploads the dirty uniforms of the program in use with
+  // ShaderProgram::FlushUniforms() and records their values. Returns the number
+  // of uniforms uploaded.
+  int FlushUniforms(ShaderProgram* shader_program);
+
+  // Records the glUseProgram() issued by ShaderProgram::Use(). The sources of
+  // the program are recorded the first time the trace uses it. The trace names
+  // programs by their sources rather than by their OpenGL names, since OpenGL
+  // reuses the names of deleted programs, e.g., after a hot reload. The
+  // uniform block bindings and the uniform values already uploaded are
+  // recorded with the sources. A compute or SPIR-V program ends the capture,
+  // see the class comment.
+  void RecordUseProgram(const ShaderProgram& shader_program);
+
+ private:
+  // Appends a record with the given arguments.
+  void Record(const uint8_t opcode,
+              const std::initializer_list<uint32_t>& arguments);
+  // Appends a payload of the current record.
+  void RecordPayload(const void* data, const size_t size);
+  // Appends the records of the state the program got before the trace first
+  // used it, i.e., its uniform block bindings and the uniform values already
+  // uploaded. The program must be in use.
+  void RecordProgramState(const ShaderProgram& shader_program);
+  // Appends a record with the value last set for the uniform of the program.
+  void RecordUniform(const ShaderProgram& shader_program,
+                     const ShaderProgram::UniformHandle handle);
+  // Writes the recorded bytes to the file.
+  void Flush();
+
+  bool capturing_;
+  int num_frames_;
+  int num_captured_frames_;
+  std::ofstream file_;
+  // True if every write succeeded.
+  bool write_succeeded_;
+  // Why the capture ended early, or empty.
+  std::string capture_error_;
+  // Records not written yet.
+  std::vector<char> records_;
+  // A program whose sources are in the trace, and its name in the trace.
+  struct RecordedProgram {
+    std::string vertex_shader_src;
+    std::string fragment_shader_src;
+    uint32_t trace_name;
+  };
+
+  // The last program recorded under every OpenGL name.
+  std::unordered_map<GLuint, RecordedProgram> recorded_programs_;
+  uint32_t num_recorded_programs_;
+};
+
+// This class loads a trace written by GLTraceRecorder and issues its calls
+// again, frame by frame, measuring the CPU time spent submitting every frame.
+// The programs of the trace are built when loading, and the uniform names are
+// resolved to locations, so neither is part of any frame. Objects are created
+// with new names, which are mapped from the names in the trace.
+//
+// Example.
+//
+// wvu::GLTraceReplayer replayer;
+// replayer.Load("/tmp/frames.trace", &error_info_log);
+// for (int i = 0; i < replayer.num_frames(); ++i) {
+//   const double submit_seconds = replayer.ReplayFrame(i);
+//   glfwSwapBuffers(window);
+// }
+class GLTraceReplayer {
+ public:
+  GLTraceReplayer() {}
+  ~GLTraceReplayer();
+
+  // Reads the trace and builds its programs. Requires a current context.
+  // Returns true if successful, and false otherwise, in which case
+  // error_info_log holds the reason.
+  bool Load(const std::string& filepath, std::string* error_info_log);
+
+  int num_frames() const {
+    return static_cast<int>(frames_.size());
+  }
+
+  // Returns the number of calls in the frame.
+  int num_calls(const int frame) const {
+    return static_cast<int>(frames_[frame].size());
+  }
+
+  // Issues the calls of the frame and returns the seconds it took, without
+  // waiting for the GPU. Frames must be replayed in order since a frame uses
+  // the objects created by the previous ones. Replaying the frames again
+  // replaces the objects they create.
+  double ReplayFrame(const int frame);
+
+ private:
+  // A decoded call.
+  struct Call {
+    uint8_t opcode;
+    uint32_t arguments[6];
+    // Index of the payload in payloads_, or -1.
+    int payload;
+  };
+
+  // Returns the name of the object created for the name in the trace.
+  GLuint MapName(const std::unordered_map<uint32_t, GLuint>& names,
+                 const uint32_t name) const;
+
+  std::vector<std::vector<Call> > frames_;
+  std::vector<std::string> payloads_;
+  std::unordered_map<uint32_t, std::unique_ptr<ShaderProgram> > programs_;
+  std::unordered_map<uint32_t, GLuint> buffers_;
+  std::unordered_map<uint32_t, GLuint> vertex_arrays_;
+  // A buffer per uniform buffer binding, which receives the recorded contents
+  // of the ranges bound to it.
+  std::unordered_map<uint32_t, GLuint> uniform_buffers_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_GL_TRACE_H_
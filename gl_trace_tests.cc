@@ -0,0 +1,534 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// C++ headers.
+#include <fstream>
+#include <memory>
+#include <string>
+
+// System specific headers.
+#include "gl_state_cache.h"
+#include "gl_trace.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+#include "uniform_buffer_ring.h"
+#include "vertex_buffer_arena.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class GLTraceTest : public GLTest {};
+
+constexpr GLfloat kTriangleVertices[] = {
+  -1.0f, -1.0f, 0.0f,
+  1.0f, -1.0f, 0.0f,
+  0.0f, 1.0f, 0.0f
+};
+
+// Creates a framebuffer that renders into a texture of size x size pixels, and
+// binds it.
+void CreateFramebuffer(const int size, GLuint* texture, GLuint* framebuffer) {
+  glGenTextures(1, texture);
+  glBindTexture(GL_TEXTURE_2D, *texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, *framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         *texture, 0);
+}
+
+// Records the creation of a vertex array that holds the triangle.
+void RecordTriangle(GLTraceRecorder* trace_recorder,
+                    GLStateCache* state_cache,
+                    GLuint* vertex_array,
+                    GLuint* buffer) {
+  trace_recorder->GenVertexArray(vertex_array);
+  state_cache->BindVertexArray(*vertex_array);
+  trace_recorder->GenBuffer(buffer);
+  state_cache->BindBuffer(GL_ARRAY_BUFFER, *buffer);
+  trace_recorder->BufferData(GL_ARRAY_BUFFER, sizeof(kTriangleVertices),
+                             kTriangleVertices, GL_STATIC_DRAW);
+  trace_recorder->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                                      3 * sizeof(kTriangleVertices[0]), 0);
+  trace_recorder->EnableVertexAttribArray(0);
+}
+
+// Returns the number of names below 4096 that are buffers or vertex arrays.
+int CountBuffersAndVertexArrays() {
+  int num_objects = 0;
+  for (GLuint name = 1; name < 4096; ++name) {
+    num_objects += glIsBuffer(name) + glIsVertexArray(name);
+  }
+  return num_objects;
+}
+
+// Returns the red channel of the pixel at the center of the framebuffer.
+GLubyte ReadCenterRed(const int size) {
+  GLubyte pixel[4];
+  glReadPixels(size / 2, size / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+  return pixel[0];
+}
+
+}  // namespace
+
+TEST_F(GLTraceTest, RecordsAndReplaysTraces) {
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  // Record a triangle drawn over a few frames, creating the objects in the
+  // first one as draw_triangle does.
+  constexpr int kNumFrames = 3;
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  // Render into a texture, outside of the trace.
+  constexpr int kSize = 64;
+  GLuint texture = 0, framebuffer = 0;
+  CreateFramebuffer(kSize, &texture, &framebuffer);
+  ASSERT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER), GL_FRAMEBUFFER_COMPLETE);
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, kNumFrames,
+                                  &error_info_log)) << error_info_log;
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  GLuint vertex_array = 0;
+  GLuint buffer = 0;
+  RecordTriangle(&trace_recorder, &state_cache, &vertex_array, &buffer);
+  for (int i = 0; i < kNumFrames + 2; ++i) {
+    trace_recorder.Viewport(0, 0, kSize, kSize);
+    trace_recorder.ClearColor(0.0f, 0.0f, 1.0f, 1.0f);
+    trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+    state_cache.SetBlendEnabled(false);
+    state_cache.UseProgram(shader_program);
+    state_cache.BindVertexArray(vertex_array);
+    trace_recorder.DrawArrays(GL_TRIANGLES, 0, 3);
+    trace_recorder.EndFrame();
+  }
+  // The capture stops by itself after the requested frames.
+  EXPECT_FALSE(trace_recorder.is_capturing());
+  EXPECT_EQ(trace_recorder.num_captured_frames(), kNumFrames);
+  GLubyte recorded_pixel[4];
+  glReadPixels(kSize / 2, kSize / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+               recorded_pixel);
+  state_cache.DeleteBuffer(buffer);
+  state_cache.DeleteVertexArray(vertex_array);
+
+  // Replay the trace over a different clear color.
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  ShaderProgram::InvalidateCurrentProgram();
+  const int num_objects = CountBuffersAndVertexArrays();
+  {
+    GLTraceReplayer replayer;
+    ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+        << error_info_log;
+    ASSERT_EQ(replayer.num_frames(), kNumFrames);
+    // The first frame creates the objects; the next ones only draw, and the
+    // state cache kept the redundant binds out of the trace.
+    EXPECT_EQ(replayer.num_calls(0), 13);
+    EXPECT_EQ(replayer.num_calls(1), 4);
+    for (int i = 0; i < replayer.num_frames(); ++i) {
+      EXPECT_GE(replayer.ReplayFrame(i), 0.0);
+    }
+    GLubyte replayed_pixel[4];
+    glReadPixels(kSize / 2, kSize / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                 replayed_pixel);
+    EXPECT_EQ(memcmp(recorded_pixel, replayed_pixel, 4), 0);
+    EXPECT_EQ(replayed_pixel[0], 255);
+
+    // Repeated replays, as replay_gl_trace --repetitions does, replace the
+    // objects of the first frame.
+    for (int i = 0; i < replayer.num_frames(); ++i) {
+      replayer.ReplayFrame(i);
+    }
+    EXPECT_EQ(CountBuffersAndVertexArrays(), num_objects + 2);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  }
+  EXPECT_EQ(CountBuffersAndVertexArrays(), num_objects);
+  ShaderProgram::InvalidateCurrentProgram();
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+
+  // A file that is not a trace is rejected.
+  std::ofstream(trace_filepath) << "not a trace";
+  GLTraceReplayer replayer;
+  EXPECT_FALSE(replayer.Load(trace_filepath, &error_info_log));
+  unlink(trace_filepath);
+}
+
+// OpenGL may reuse the name of a deleted program, e.g., after a hot reload, but
+// the trace must replay every frame with the program it used.
+TEST_F(GLTraceTest, RecordsProgramsThatReuseDeletedNames) {
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  constexpr int kSize = 64;
+  GLuint texture = 0, framebuffer = 0;
+  CreateFramebuffer(kSize, &texture, &framebuffer);
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, 2, &error_info_log))
+      << error_info_log;
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  GLuint vertex_array = 0;
+  GLuint buffer = 0;
+  RecordTriangle(&trace_recorder, &state_cache, &vertex_array, &buffer);
+
+  // The first frame draws with a red program, and the second one with a
+  // program without red created after deleting the first one.
+  std::unique_ptr<ShaderProgram> shader_program(new ShaderProgram);
+  shader_program->LoadVertexShaderFromString(vertex_shader_src);
+  shader_program->LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program->Create(nullptr));
+  for (int i = 0; i < 2; ++i) {
+    if (i == 1) {
+      shader_program.reset(new ShaderProgram);
+      shader_program->LoadVertexShaderFromString(vertex_shader_src);
+      shader_program->LoadFragmentShaderFromString(
+          MakeFragmentShaderSource(0));
+      ASSERT_TRUE(shader_program->Create(nullptr));
+    }
+    trace_recorder.Viewport(0, 0, kSize, kSize);
+    trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+    state_cache.UseProgram(*shader_program);
+    state_cache.BindVertexArray(vertex_array);
+    trace_recorder.DrawArrays(GL_TRIANGLES, 0, 3);
+    trace_recorder.EndFrame();
+  }
+  ASSERT_EQ(trace_recorder.num_captured_frames(), 2);
+  shader_program.reset();
+  state_cache.DeleteBuffer(buffer);
+  state_cache.DeleteVertexArray(vertex_array);
+
+  {
+    GLTraceReplayer replayer;
+    ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+        << error_info_log;
+    ASSERT_EQ(replayer.num_frames(), 2);
+    replayer.ReplayFrame(0);
+    EXPECT_EQ(ReadCenterRed(kSize), 255);
+    replayer.ReplayFrame(1);
+    EXPECT_EQ(ReadCenterRed(kSize), 0);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  }
+  ShaderProgram::InvalidateCurrentProgram();
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+  unlink(trace_filepath);
+}
+
+TEST_F(GLTraceTest, RecordsUniforms) {
+  const std::string tinted_fragment_shader_src =
+      "#version 330 core\n"
+      "uniform vec4 tint;\n"
+      "out vec4 color;\n"
+      "void main() {\n"
+      "color = tint;\n"
+      "}\n";
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(tinted_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  const ShaderProgram::UniformHandle tint_handle =
+      shader_program.GetUniformHandle("tint");
+  // A value uploaded before the capture starts is recorded with the program.
+  const GLfloat red[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+  const GLfloat green[4] = { 0.0f, 1.0f, 0.0f, 1.0f };
+  ASSERT_TRUE(shader_program.Use());
+  shader_program.SetUniformVector4(tint_handle, red);
+  shader_program.FlushUniforms();
+  ShaderProgram::InvalidateCurrentProgram();
+  constexpr int kSize = 64;
+  GLuint texture = 0, framebuffer = 0;
+  CreateFramebuffer(kSize, &texture, &framebuffer);
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, 2, &error_info_log))
+      << error_info_log;
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  GLuint vertex_array = 0;
+  GLuint buffer = 0;
+  RecordTriangle(&trace_recorder, &state_cache, &vertex_array, &buffer);
+  // The first frame draws in red and the second one in green.
+  for (int i = 0; i < 2; ++i) {
+    trace_recorder.Viewport(0, 0, kSize, kSize);
+    trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+    state_cache.UseProgram(shader_program);
+    if (i == 1) {
+      shader_program.SetUniformVector4(tint_handle, green);
+    }
+    trace_recorder.FlushUniforms(&shader_program);
+    state_cache.BindVertexArray(vertex_array);
+    trace_recorder.DrawArrays(GL_TRIANGLES, 0, 3);
+    trace_recorder.EndFrame();
+  }
+  EXPECT_TRUE(trace_recorder.Close(&error_info_log)) << error_info_log;
+  EXPECT_EQ(trace_recorder.num_captured_frames(), 2);
+  state_cache.DeleteBuffer(buffer);
+  state_cache.DeleteVertexArray(vertex_array);
+  // The replayed program must not inherit the last value set.
+  shader_program.SetUniformVector4(tint_handle, green);
+
+  {
+    GLTraceReplayer replayer;
+    ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+        << error_info_log;
+    ASSERT_EQ(replayer.num_frames(), 2);
+    for (int repetition = 0; repetition < 2; ++repetition) {
+      replayer.ReplayFrame(0);
+      EXPECT_EQ(ReadCenterRed(kSize), 255);
+      replayer.ReplayFrame(1);
+      EXPECT_EQ(ReadCenterRed(kSize), 0);
+    }
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  }
+  ShaderProgram::InvalidateCurrentProgram();
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+  unlink(trace_filepath);
+}
+
+TEST_F(GLTraceTest, RecordsUniformBufferRingBlocks) {
+  if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+    LOG(INFO) << "Buffer storage is not supported; skipping.";
+    return;
+  }
+  const std::string block_fragment_shader_src =
+      "#version 330 core\n"
+      "layout (std140) uniform DrawData {\n"
+      "  vec4 tint;\n"
+      "};\n"
+      "out vec4 color;\n"
+      "void main() {\n"
+      "color = tint;\n"
+      "}\n";
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(block_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  // A binding other than the default one must reach the replay.
+  ASSERT_TRUE(shader_program.SetUniformBlockBinding("DrawData", 3));
+  constexpr int kSize = 64;
+  GLuint texture = 0, framebuffer = 0;
+  CreateFramebuffer(kSize, &texture, &framebuffer);
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, 2, &error_info_log))
+      << error_info_log;
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  UniformBufferRing uniform_ring(&trace_recorder);
+  ASSERT_TRUE(uniform_ring.Initialize(1 << 16, &error_info_log))
+      << error_info_log;
+  GLuint vertex_array = 0;
+  GLuint buffer = 0;
+  RecordTriangle(&trace_recorder, &state_cache, &vertex_array, &buffer);
+  // The first frame draws in red and the second one in green, from blocks
+  // written through the mapped pointer of the ring.
+  for (int i = 0; i < 2; ++i) {
+    const GLfloat tint[4] = { i == 0 ? 1.0f : 0.0f, 1.0f * i, 0.0f, 1.0f };
+    UniformBufferRing::Block block;
+    ASSERT_TRUE(uniform_ring.Allocate(sizeof(tint), &block));
+    memcpy(block.data, tint, sizeof(tint));
+    trace_recorder.Viewport(0, 0, kSize, kSize);
+    trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+    state_cache.UseProgram(shader_program);
+    uniform_ring.BindBlock(3, block);
+    state_cache.BindVertexArray(vertex_array);
+    trace_recorder.DrawArrays(GL_TRIANGLES, 0, 3);
+    uniform_ring.Fence();
+    trace_recorder.EndFrame();
+  }
+  EXPECT_TRUE(trace_recorder.Close(&error_info_log)) << error_info_log;
+  state_cache.DeleteBuffer(buffer);
+  state_cache.DeleteVertexArray(vertex_array);
+
+  {
+    GLTraceReplayer replayer;
+    ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+        << error_info_log;
+    ASSERT_EQ(replayer.num_frames(), 2);
+    replayer.ReplayFrame(0);
+    EXPECT_EQ(ReadCenterRed(kSize), 255);
+    replayer.ReplayFrame(1);
+    EXPECT_EQ(ReadCenterRed(kSize), 0);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  }
+  ShaderProgram::InvalidateCurrentProgram();
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+  unlink(trace_filepath);
+}
+
+TEST_F(GLTraceTest, RecordsIndexedDrawsFromVertexBufferArena) {
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  constexpr int kSize = 64;
+  GLuint texture = 0, framebuffer = 0;
+  CreateFramebuffer(kSize, &texture, &framebuffer);
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, 1, &error_info_log))
+      << error_info_log;
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  GLuint vertex_array = 0;
+  GLuint index_buffer = 0;
+  {
+    // A small mesh before the triangle, so that the triangle needs a base
+    // vertex.
+    VertexBufferArena arena(&trace_recorder);
+    ASSERT_TRUE(arena.Initialize(3 * sizeof(GLfloat), 16, &error_info_log))
+        << error_info_log;
+    VertexBufferArena::Slice point, triangle;
+    ASSERT_TRUE(arena.Allocate(kTriangleVertices, 1, &point));
+    ASSERT_TRUE(arena.Allocate(kTriangleVertices, 3, &triangle));
+    trace_recorder.GenVertexArray(&vertex_array);
+    state_cache.BindVertexArray(vertex_array);
+    state_cache.BindBuffer(GL_ARRAY_BUFFER, arena.buffer_id(0));
+    trace_recorder.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                                       3 * sizeof(kTriangleVertices[0]), 0);
+    trace_recorder.EnableVertexAttribArray(0);
+    const GLushort indices[3] = { 0, 1, 2 };
+    trace_recorder.GenBuffer(&index_buffer);
+    state_cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    trace_recorder.BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices),
+                              indices, GL_STATIC_DRAW);
+
+    trace_recorder.Viewport(0, 0, kSize, kSize);
+    trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+    state_cache.UseProgram(shader_program);
+    trace_recorder.DrawElementsBaseVertex(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT,
+                                          0, triangle.base_vertex);
+    trace_recorder.EndFrame();
+    EXPECT_EQ(ReadCenterRed(kSize), 255);
+  }
+  EXPECT_TRUE(trace_recorder.Close(&error_info_log)) << error_info_log;
+  state_cache.DeleteBuffer(index_buffer);
+  state_cache.DeleteVertexArray(vertex_array);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  {
+    GLTraceReplayer replayer;
+    ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+        << error_info_log;
+    ASSERT_EQ(replayer.num_frames(), 1);
+    replayer.ReplayFrame(0);
+    EXPECT_EQ(ReadCenterRed(kSize), 255);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  }
+  ShaderProgram::InvalidateCurrentProgram();
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+  unlink(trace_filepath);
+}
+
+// The trace records GLSL sources, so it refuses compute programs instead of
+// replaying frames without them.
+TEST_F(GLTraceTest, EndsCaptureOnComputePrograms) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  const std::string compute_shader_src =
+      "#version 430 core\n"
+      "layout (local_size_x = 1) in;\n"
+      "void main() {\n"
+      "}\n";
+  char trace_filepath[] = "/tmp/gl_trace_XXXXXX";
+  const int fd = mkstemp(trace_filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ShaderProgram compute_program;
+  compute_program.LoadComputeShaderFromString(compute_shader_src);
+  ASSERT_TRUE(compute_program.Create(nullptr));
+
+  GLTraceRecorder trace_recorder;
+  std::string error_info_log;
+  ASSERT_TRUE(trace_recorder.Open(trace_filepath, 2, &error_info_log))
+      << error_info_log;
+  trace_recorder.Clear(GL_COLOR_BUFFER_BIT);
+  trace_recorder.EndFrame();
+  GLStateCache state_cache(&trace_recorder);
+  state_cache.Invalidate();
+  state_cache.UseProgram(compute_program);
+  EXPECT_FALSE(trace_recorder.is_capturing());
+  EXPECT_EQ(trace_recorder.num_captured_frames(), 1);
+  EXPECT_FALSE(trace_recorder.Close(&error_info_log));
+  EXPECT_NE(error_info_log.find("compute"), std::string::npos);
+  ShaderProgram::InvalidateCurrentProgram();
+
+  // The frames before the program are kept.
+  GLTraceReplayer replayer;
+  ASSERT_TRUE(replayer.Load(trace_filepath, &error_info_log))
+      << error_info_log;
+  EXPECT_EQ(replayer.num_frames(), 1);
+  unlink(trace_filepath);
+}
+
+}  // namespace wvu
@@ -0,0 +1,159 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "gpu_transform.h"
+
+#include <algorithm>
+#include <string>
+#include <Eigen/Core>
+#include <GL/glew.h>
+
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// Bindings of the shader storage buffers.
+constexpr GLuint kInputBinding = 0;
+constexpr GLuint kOutputBinding = 1;
+
+// The compute shader. Every invocation transforms one point, counting from the
+// first point of the dispatch.
+const std::string compute_shader_src =
+    "#version 430 core\n"
+    "layout (local_size_x = " + std::to_string(GpuTransform::kWorkGroupSize) +
+    ") in;\n"
+    "layout (std430, binding = 0) readonly buffer Input {\n"
+    "  vec4 input_points[];\n"
+    "};\n"
+    "layout (std430, binding = 1) writeonly buffer Output {\n"
+    "  vec4 output_points[];\n"
+    "};\n"
+    "uniform mat4 transformation;\n"
+    "uniform uint num_points;\n"
+    "uniform uint first_point;\n"
+    "void main() {\n"
+    "  const uint i = first_point + gl_GlobalInvocationID.x;\n"
+    "  if (i < num_points) {\n"
+    "    output_points[i] = transformation * input_points[i];\n"
+    "  }\n"
+    "}\n";
+
+}  // namespace
+
+constexpr int GpuTransform::kWorkGroupSize;
+
+bool GpuTransform::Initialize(std::string* error_info_log) {
+  compute_program_.LoadComputeShaderFromString(compute_shader_src);
+  if (!compute_program_.Create(error_info_log)) {
+    return false;
+  }
+  transformation_handle_ = compute_program_.GetUniformHandle("transformation");
+  num_points_handle_ = compute_program_.GetUniformHandle("num_points");
+  first_point_handle_ = compute_program_.GetUniformHandle("first_point");
+  GLuint max_num_groups[3];
+  ShaderProgram::GetMaxComputeWorkGroupCount(max_num_groups);
+  max_num_groups_ = max_num_groups[0];
+  if (max_num_groups_ == 0) {
+    if (error_info_log) {
+      *error_info_log = "Could not query the maximum work group count.";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool GpuTransform::Transform(const Eigen::Matrix4f& transformation,
+                             const GLuint input_buffer,
+                             const GLuint output_buffer,
+                             const GLuint num_points) {
+  if (!compute_program_.Use()) {
+    return false;
+  }
+  if (num_points == 0) {
+    return true;
+  }
+  compute_program_.SetUniformMatrix4(transformation_handle_,
+                                     transformation.data());
+  compute_program_.SetUniform(num_points_handle_, num_points);
+  compute_program_.FlushUniforms();
+  ShaderProgram::BindShaderStorageBuffer(kInputBinding, input_buffer);
+  ShaderProgram::BindShaderStorageBuffer(kOutputBinding, output_buffer);
+  // A dispatch launches at most max_num_groups_ work groups, which may be as
+  // few as 65535, so large inputs take several dispatches.
+  const GLuint num_groups = num_points / kWorkGroupSize +
+      (num_points % kWorkGroupSize != 0);
+  bool success = true;
+  for (GLuint first_group = 0; success && first_group < num_groups;
+       first_group += max_num_groups_) {
+    compute_program_.SetUniform(first_point_handle_,
+                                first_group * kWorkGroupSize);
+    compute_program_.FlushUniforms();
+    success = compute_program_.Dispatch(
+        std::min(num_groups - first_group, max_num_groups_));
+  }
+  // The output is usually drawn as a vertex buffer right after.
+  glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                  GL_BUFFER_UPDATE_BARRIER_BIT |
+                  GL_SHADER_STORAGE_BARRIER_BIT);
+  return success;
+}
+
+bool GpuTransform::Transform(const Eigen::Matrix4f& transformation,
+                             const Eigen::Matrix4Xf& points,
+                             Eigen::Matrix4Xf* transformed_points) {
+  if (!compute_program_.Use()) {
+    return false;
+  }
+  const GLsizeiptr num_bytes = points.size() * sizeof(float);
+  transformed_points->resize(4, points.cols());
+  if (points.cols() == 0) {
+    return true;
+  }
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, num_bytes, points.data(),
+               GL_STREAM_COPY);
+  // Transform in place, since the shader reads a point before writing it.
+  const bool success =
+      Transform(transformation, buffer, buffer, points.cols());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, num_bytes,
+                     transformed_points->data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+  return success;
+}
+
+}  // namespace wvu
@@ -0,0 +1,126 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_GPU_TRANSFORM_H_
+#define GLUTILS_GPU_TRANSFORM_H_
+
+#include <string>
+#include <Eigen/Core>
+#include <GL/glew.h>
+
+#include "shader_program.h"
+
+namespace wvu {
+// This class multiplies many 4d points by a 4x4 matrix on the GPU, i.e., it
+// computes MultiplyVectorAndMatrix(transformation, point) for every point with
+// a compute shader. The points are read from a buffer and the results are
+// written into another buffer, typically the vertex buffer that is drawn next,
+// so the transformed points never travel back to the CPU. Points are packed
+// vec4s, one per 16 bytes. Requires OpenGL 4.3 or ARB_compute_shader.
+//
+// Example.
+//
+// wvu::GpuTransform gpu_transform;
+// if (!gpu_transform.Initialize(&error_info_log)) {
+//   LOG(ERROR) << error_info_log;  // Fall back to the CPU.
+// }
+// while (...) {  // Rendering loop.
+//   gpu_transform.Transform(model_matrix, points_buffer, vertex_buffer,
+//                           num_points);
+//   glDrawArrays(GL_POINTS, 0, num_points);  // Reads vertex_buffer.
+// }
+class GpuTransform {
+ public:
+  // Number of points transformed by a work group.
+  static constexpr int kWorkGroupSize = 256;
+
+  GpuTransform() : transformation_handle_(0), num_points_handle_(0),
+                   first_point_handle_(0), max_num_groups_(0) {}
+  ~GpuTransform() {}
+
+  // Compiles the compute shader. Returns true if successful, and false
+  // otherwise, e.g., when compute shaders are not supported, in which case
+  // error_info_log holds the reason.
+  bool Initialize(std::string* error_info_log);
+
+  // Transforms num_points points of input_buffer into output_buffer. Both
+  // buffers must hold at least num_points * 16 bytes and may be the same
+  // buffer. The function only submits the work; a barrier makes the results
+  // visible to vertex fetching and buffer reads that follow. Points beyond the
+  // work groups of one dispatch are transformed by further dispatches. Returns
+  // false if the class is not initialized or a dispatch fails.
+  //
+  // Parameters:
+  //   transformation  The 4x4 matrix applied to every point.
+  //   input_buffer  The buffer that holds the points.
+  //   output_buffer  The buffer that receives the transformed points.
+  //   num_points  The number of points.
+  bool Transform(const Eigen::Matrix4f& transformation,
+                 const GLuint input_buffer,
+                 const GLuint output_buffer,
+                 const GLuint num_points);
+
+  // Uploads the points, transforms them and reads the result back. Meant for
+  // testing and for data that lives on the CPU; the buffer version avoids the
+  // copies. Returns false if the class is not initialized or a dispatch fails.
+  //
+  // Parameters:
+  //   transformation  The 4x4 matrix applied to every point.
+  //   points  The points, one per column.
+  //   transformed_points  The transformed points. It is resized to the size of
+  //     points.
+  bool Transform(const Eigen::Matrix4f& transformation,
+                 const Eigen::Matrix4Xf& points,
+                 Eigen::Matrix4Xf* transformed_points);
+
+  // Lowers the number of work groups of a dispatch, which is the limit of the
+  // driver by default. Meant for testing the split into several dispatches.
+  void set_max_num_groups_per_dispatch(const GLuint max_num_groups) {
+    if (max_num_groups > 0 && max_num_groups < max_num_groups_) {
+      max_num_groups_ = max_num_groups;
+    }
+  }
+
+ private:
+  ShaderProgram compute_program_;
+  ShaderProgram::UniformHandle transformation_handle_;
+  ShaderProgram::UniformHandle num_points_handle_;
+  ShaderProgram::UniformHandle first_point_handle_;
+  // The work groups of a dispatch.
+  GLuint max_num_groups_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_GPU_TRANSFORM_H_
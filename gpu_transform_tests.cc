@@ -0,0 +1,124 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+
+// System specific headers.
+#include "assignment.h"
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gpu_transform.h"
+#include "gtest/gtest.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class GpuTransformTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(GpuTransformTest, TransformsPointsOnGpu) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  GpuTransform gpu_transform;
+  std::string error_info_log;
+  ASSERT_TRUE(gpu_transform.Initialize(&error_info_log)) << error_info_log;
+  const Eigen::Matrix4f transformation = Eigen::Matrix4f::Random();
+
+  for (const int num_points : { 1 << 10, 1 << 14, 1 << 18 }) {
+    const Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, num_points);
+
+    Eigen::Matrix4Xf cpu_points(4, num_points);
+    for (int i = 0; i < num_points; ++i) {
+      cpu_points.col(i) = MultiplyVectorAndMatrix(transformation,
+                                                  points.col(i));
+    }
+
+    // The points stay on the GPU, and the result lands in a vertex buffer.
+    const GLsizeiptr num_bytes = points.size() * sizeof(float);
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[0]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, num_bytes, points.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, num_bytes, nullptr, GL_DYNAMIC_DRAW);
+    ASSERT_TRUE(gpu_transform.Transform(transformation, buffers[0],
+                                        buffers[1], num_points));
+
+    Eigen::Matrix4Xf gpu_points(4, num_points);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, num_bytes, gpu_points.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glDeleteBuffers(2, buffers);
+    EXPECT_LT((gpu_points - cpu_points).cwiseAbs().maxCoeff(), 1e-4f);
+  }
+
+  // The convenience version round-trips through the CPU.
+  const Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, 1000);
+  Eigen::Matrix4Xf transformed_points;
+  ASSERT_TRUE(gpu_transform.Transform(transformation, points,
+                                      &transformed_points));
+  EXPECT_LT((transformed_points - transformation * points).cwiseAbs()
+            .maxCoeff(), 1e-4f);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+// Inputs with more work groups than a dispatch launches are split into several
+// dispatches. Lowering the limit exercises the split without gigabytes of data.
+TEST_F(GpuTransformTest, SplitsLargeTransformsIntoSeveralDispatches) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  GpuTransform gpu_transform;
+  std::string error_info_log;
+  ASSERT_TRUE(gpu_transform.Initialize(&error_info_log)) << error_info_log;
+  gpu_transform.set_max_num_groups_per_dispatch(2);
+  const Eigen::Matrix4f transformation = Eigen::Matrix4f::Random();
+  // Five work groups, the last one partially filled, in three dispatches.
+  const Eigen::Matrix4Xf points =
+      Eigen::Matrix4Xf::Random(4, 4 * GpuTransform::kWorkGroupSize + 10);
+  Eigen::Matrix4Xf transformed_points;
+  ASSERT_TRUE(gpu_transform.Transform(transformation, points,
+                                      &transformed_points));
+  EXPECT_LT((transformed_points - transformation * points).cwiseAbs()
+            .maxCoeff(), 1e-4f);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+}  // namespace wvu
@@ -0,0 +1,218 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "point_stream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <Eigen/Core>
+
+namespace wvu {
+namespace {
+// Closes a file descriptor once it goes out of scope.
+class ScopedFileDescriptor {
+ public:
+  explicit ScopedFileDescriptor(const int fd) : fd_(fd) {}
+  ~ScopedFileDescriptor() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+  int get() const { return fd_; }
+
+ private:
+  const int fd_;
+};
+
+// Stores the message in error_info_log if the user provided a valid string.
+// Always returns false so that callers can return its result directly.
+bool SetError(const std::string& message, std::string* error_info_log) {
+  if (error_info_log) {
+    *error_info_log = message;
+  }
+  return false;
+}
+
+// Computes the greatest common divisor of two positive numbers.
+size_t GreatestCommonDivisor(size_t a, size_t b) {
+  while (b != 0) {
+    const size_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+// Returns the smallest multiple of the page size and the record size that is
+// not smaller than the requested window size. Windows of this size always
+// start at a page boundary and hold whole records.
+size_t ComputeWindowSize(const size_t requested_size,
+                         const size_t record_size) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t granularity =
+      page_size / GreatestCommonDivisor(page_size, record_size) * record_size;
+  const size_t num_granules =
+      std::max<size_t>(1, (requested_size + granularity - 1) / granularity);
+  return num_granules * granularity;
+}
+
+// Transforms num_points packed records from input into output.
+void TransformRecords(const Eigen::Matrix4f& transformation,
+                      const PointRecordFormat format,
+                      const float* input,
+                      const size_t num_points,
+                      float* output) {
+  if (format == FLOAT4) {
+    const Eigen::Map<const Eigen::Matrix4Xf> points(input, 4, num_points);
+    Eigen::Map<Eigen::Matrix4Xf> transformed_points(output, 4, num_points);
+    transformed_points.noalias() = transformation * points;
+    return;
+  }
+  // Points are (x, y, z, 1), so the transform reduces to a 3x3 product plus
+  // a translation.
+  const Eigen::Map<const Eigen::Matrix3Xf> points(input, 3, num_points);
+  Eigen::Map<Eigen::Matrix3Xf> transformed_points(output, 3, num_points);
+  transformed_points.noalias() =
+      transformation.topLeftCorner<3, 3>() * points;
+  transformed_points.colwise() += transformation.block<3, 1>(0, 3);
+}
+
+}  // namespace
+
+bool TransformPointFile(const std::string& input_path,
+                        const std::string& output_path,
+                        const Eigen::Matrix4f& transformation,
+                        const PointStreamOptions& options,
+                        PointStreamStats* stats,
+                        std::string* error_info_log) {
+  const auto start = std::chrono::steady_clock::now();
+  const size_t record_size = options.format * sizeof(float);
+  const ScopedFileDescriptor input(open(input_path.c_str(), O_RDONLY));
+  if (input.get() < 0) {
+    return SetError("Could not open " + input_path, error_info_log);
+  }
+  struct stat input_stat;
+  if (fstat(input.get(), &input_stat) != 0) {
+    return SetError("Could not stat " + input_path, error_info_log);
+  }
+  const size_t file_size = input_stat.st_size;
+  if (file_size % record_size != 0) {
+    return SetError(input_path + " does not hold a whole number of records",
+                    error_info_log);
+  }
+  // Truncating the output would destroy the input before it is read when both
+  // paths name the same file, e.g., through a hard or symbolic link.
+  struct stat output_stat;
+  if (stat(output_path.c_str(), &output_stat) == 0 &&
+      output_stat.st_dev == input_stat.st_dev &&
+      output_stat.st_ino == input_stat.st_ino) {
+    return SetError(output_path + " is the same file as " + input_path,
+                    error_info_log);
+  }
+  const ScopedFileDescriptor output(
+      open(output_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644));
+  if (output.get() < 0) {
+    return SetError("Could not open " + output_path, error_info_log);
+  }
+  if (ftruncate(output.get(), file_size) != 0) {
+    return SetError("Could not resize " + output_path, error_info_log);
+  }
+
+  // The whole input is read once and in order.
+  posix_fadvise(input.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  const size_t window_size =
+      ComputeWindowSize(options.window_size_bytes, record_size);
+  PointStreamStats local_stats;
+  for (size_t offset = 0; offset < file_size; offset += window_size) {
+    const size_t length = std::min(window_size, file_size - offset);
+    // Ask the kernel to start reading the windows that follow this one while
+    // we transform the current one.
+    if (options.readahead_windows > 0 && offset + length < file_size) {
+      posix_fadvise(input.get(), offset + length,
+                    options.readahead_windows * window_size,
+                    POSIX_FADV_WILLNEED);
+    }
+    void* input_window =
+        mmap(nullptr, length, PROT_READ, MAP_SHARED, input.get(), offset);
+    if (input_window == MAP_FAILED) {
+      return SetError("Could not map " + input_path, error_info_log);
+    }
+    void* output_window = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, output.get(), offset);
+    if (output_window == MAP_FAILED) {
+      munmap(input_window, length);
+      return SetError("Could not map " + output_path, error_info_log);
+    }
+    madvise(input_window, length, MADV_SEQUENTIAL);
+
+    const size_t num_points = length / record_size;
+    TransformRecords(transformation,
+                     options.format,
+                     static_cast<const float*>(input_window),
+                     num_points,
+                     static_cast<float*>(output_window));
+
+    munmap(output_window, length);
+    munmap(input_window, length);
+    // Start writing back the transformed window and drop the input pages we
+    // are done with, so the page cache does not grow with the file size.
+#ifdef __linux__
+    sync_file_range(output.get(), offset, length, SYNC_FILE_RANGE_WRITE);
+#endif
+    posix_fadvise(input.get(), offset, length, POSIX_FADV_DONTNEED);
+
+    local_stats.num_points += num_points;
+    local_stats.num_windows += 1;
+    local_stats.num_bytes_read += length;
+    local_stats.num_bytes_written += length;
+  }
+  if (fsync(output.get()) != 0) {
+    return SetError("Could not flush " + output_path, error_info_log);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  local_stats.elapsed_seconds = elapsed.count();
+  if (stats) {
+    *stats = local_stats;
+  }
+  return true;
+}
+
+}  // namespace wvu
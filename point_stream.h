@@ -0,0 +1,111 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef WVU_POINT_STREAM_H_
+#define WVU_POINT_STREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <Eigen/Core>
+
+namespace wvu {
+// Layout of the records stored in a point file. Every record is a packed set
+// of floats without any header or padding.
+enum PointRecordFormat {
+  FLOAT3 = 3,
+  FLOAT4 = 4
+};
+
+// Options for the streaming transform.
+struct PointStreamOptions {
+  PointStreamOptions() :
+      format(FLOAT3), window_size_bytes(64 << 20), readahead_windows(2) {}
+  // Layout of the records in the input file. The output uses the same layout.
+  PointRecordFormat format;
+  // Number of bytes mapped at once for the input and for the output. The value
+  // is rounded up so that a window holds whole records and starts at a page
+  // boundary. The resident memory used by the transform is bounded by twice
+  // this value.
+  size_t window_size_bytes;
+  // Number of windows ahead of the current one that the kernel is asked to
+  // prefetch.
+  int readahead_windows;
+};
+
+// Statistics of a streaming transform.
+struct PointStreamStats {
+  PointStreamStats() :
+      num_points(0), num_windows(0), num_bytes_read(0), num_bytes_written(0),
+      elapsed_seconds(0.0) {}
+  uint64_t num_points;
+  uint64_t num_windows;
+  uint64_t num_bytes_read;
+  uint64_t num_bytes_written;
+  double elapsed_seconds;
+
+  // End to end throughput measured as bytes read per second, in GB/s.
+  double GigabytesPerSecond() const {
+    return elapsed_seconds > 0.0 ?
+        num_bytes_read / elapsed_seconds / 1e9 : 0.0;
+  }
+};
+
+// Transforms every point stored in the file at input_path with the 4x4
+// transformation and writes the result into output_path. FLOAT3 records are
+// treated as (x, y, z, 1) and the first three coordinates of the transformed
+// point are written; FLOAT4 records are multiplied as they are, just like
+// MultiplyVectorAndMatrix does.
+// Both files are memory-mapped one window at a time, so files larger than the
+// available RAM can be processed. The function returns true if successful, and
+// false otherwise. In case of a failure, error_info_log holds the reason.
+//
+// Parameters:
+//   input_path  The filepath of the packed input records.
+//   output_path  The filepath for the transformed records. It is overwritten
+//     and must not name the same file as input_path.
+//   transformation  The 4x4 matrix applied to every point.
+//   options  The record layout and windowing options.
+//   stats  Optional pointer to the statistics of the transform.
+//   error_info_log  Optional pointer to a string that holds the error log.
+bool TransformPointFile(const std::string& input_path,
+                        const std::string& output_path,
+                        const Eigen::Matrix4f& transformation,
+                        const PointStreamOptions& options,
+                        PointStreamStats* stats,
+                        std::string* error_info_log);
+
+}  // namespace wvu
+
+#endif  // WVU_POINT_STREAM_H_
@@ -0,0 +1,202 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdio.h>
+#include <stdlib.h>  // For mkstemp.
+#include <unistd.h>
+
+// C++ headers.
+#include <fstream>
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "assignment.h"
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "point_stream.h"
+
+namespace wvu {
+namespace {
+// Creates a temporary file and returns its path.
+std::string MakeTemporaryFilepath() {
+  char filepath[] = "/tmp/point_stream_XXXXXX";
+  const int fd = mkstemp(filepath);
+  CHECK_GE(fd, 0);
+  close(fd);
+  return filepath;
+}
+
+// Writes num_points random records into a new temporary file and returns them.
+std::vector<float> WriteRandomPoints(const int num_floats_per_point,
+                                     const int num_points,
+                                     std::string* filepath) {
+  const Eigen::VectorXf points =
+      Eigen::VectorXf::Random(num_floats_per_point * num_points);
+  *filepath = MakeTemporaryFilepath();
+  std::ofstream out(*filepath, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(points.data()),
+            points.size() * sizeof(float));
+  return std::vector<float>(points.data(), points.data() + points.size());
+}
+
+// Reads all the floats stored in filepath.
+std::vector<float> ReadPoints(const std::string& filepath) {
+  std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+  std::vector<float> points(in.tellg() / sizeof(float));
+  in.seekg(0);
+  in.read(reinterpret_cast<char*>(points.data()),
+          points.size() * sizeof(float));
+  return points;
+}
+
+}  // namespace
+
+TEST(PointStream, TransformFloat4PointsAcrossWindows) {
+  // An odd number of points and a tiny window force several windows and a
+  // partial window at the end of the file.
+  constexpr int kNumPoints = 10007;
+  std::string input_path;
+  const std::vector<float> points = WriteRandomPoints(4, kNumPoints,
+                                                      &input_path);
+  const std::string output_path = MakeTemporaryFilepath();
+  const Eigen::Matrix4f transformation = Eigen::Matrix4f::Random();
+  PointStreamOptions options;
+  options.format = FLOAT4;
+  options.window_size_bytes = 1;
+  PointStreamStats stats;
+  std::string error_info_log;
+  ASSERT_TRUE(TransformPointFile(input_path, output_path, transformation,
+                                 options, &stats, &error_info_log))
+      << error_info_log;
+  EXPECT_EQ(stats.num_points, kNumPoints);
+  EXPECT_GT(stats.num_windows, 1);
+  EXPECT_EQ(stats.num_bytes_read, kNumPoints * 4 * sizeof(float));
+
+  const std::vector<float> transformed_points = ReadPoints(output_path);
+  ASSERT_EQ(transformed_points.size(), points.size());
+  for (int i = 0; i < kNumPoints; ++i) {
+    const Eigen::Vector4f point(&points[4 * i]);
+    const Eigen::Vector4f expected =
+        MultiplyVectorAndMatrix(transformation, point);
+    const Eigen::Vector4f result(&transformed_points[4 * i]);
+    EXPECT_NEAR((result - expected).norm(), 0.0f, 1e-4);
+  }
+  unlink(input_path.c_str());
+  unlink(output_path.c_str());
+}
+
+TEST(PointStream, TransformFloat3PointsAcrossWindows) {
+  constexpr int kNumPoints = 20011;
+  std::string input_path;
+  const std::vector<float> points = WriteRandomPoints(3, kNumPoints,
+                                                      &input_path);
+  const std::string output_path = MakeTemporaryFilepath();
+  Eigen::Matrix4f transformation = Eigen::Matrix4f::Identity();
+  transformation.topLeftCorner<3, 3>() =
+      Eigen::Quaternionf::UnitRandom().toRotationMatrix();
+  transformation.block<3, 1>(0, 3) = Eigen::Vector3f::Random();
+  PointStreamOptions options;
+  options.format = FLOAT3;
+  options.window_size_bytes = 1;
+  PointStreamStats stats;
+  std::string error_info_log;
+  ASSERT_TRUE(TransformPointFile(input_path, output_path, transformation,
+                                 options, &stats, &error_info_log))
+      << error_info_log;
+  EXPECT_EQ(stats.num_points, kNumPoints);
+  EXPECT_GT(stats.num_windows, 1);
+  LOG(INFO) << "Streamed " << stats.num_bytes_read << " bytes at "
+            << stats.GigabytesPerSecond() << " GB/s";
+
+  const std::vector<float> transformed_points = ReadPoints(output_path);
+  ASSERT_EQ(transformed_points.size(), points.size());
+  for (int i = 0; i < kNumPoints; ++i) {
+    const Eigen::Vector3f point(&points[3 * i]);
+    const Eigen::Vector4f expected =
+        MultiplyVectorAndMatrix(transformation, point.homogeneous());
+    const Eigen::Vector3f result(&transformed_points[3 * i]);
+    EXPECT_NEAR((result - expected.head<3>()).norm(), 0.0f, 1e-4);
+  }
+  unlink(input_path.c_str());
+  unlink(output_path.c_str());
+}
+
+TEST(PointStream, RejectsTruncatedRecords) {
+  std::string input_path;
+  WriteRandomPoints(1, 5, &input_path);
+  const std::string output_path = MakeTemporaryFilepath();
+  PointStreamOptions options;
+  options.format = FLOAT4;
+  std::string error_info_log;
+  EXPECT_FALSE(TransformPointFile(input_path, output_path,
+                                  Eigen::Matrix4f::Identity(), options,
+                                  nullptr, &error_info_log));
+  EXPECT_GT(error_info_log.size(), 0);
+  unlink(input_path.c_str());
+  unlink(output_path.c_str());
+}
+
+TEST(PointStream, RejectsOutputThatIsTheInput) {
+  std::string input_path;
+  const std::vector<float> points = WriteRandomPoints(4, 16, &input_path);
+  const std::string link_path = MakeTemporaryFilepath();
+  unlink(link_path.c_str());
+  ASSERT_EQ(symlink(input_path.c_str(), link_path.c_str()), 0);
+  PointStreamOptions options;
+  options.format = FLOAT4;
+  std::string error_info_log;
+  EXPECT_FALSE(TransformPointFile(input_path, input_path,
+                                  Eigen::Matrix4f::Identity(), options,
+                                  nullptr, &error_info_log));
+  EXPECT_GT(error_info_log.size(), 0);
+  EXPECT_FALSE(TransformPointFile(input_path, link_path,
+                                  Eigen::Matrix4f::Identity(), options,
+                                  nullptr, nullptr));
+  // The input must be left untouched.
+  EXPECT_EQ(ReadPoints(input_path), points);
+  unlink(link_path.c_str());
+  unlink(input_path.c_str());
+}
+
+TEST(PointStream, FailsOnMissingInput) {
+  PointStreamOptions options;
+  std::string error_info_log;
+  EXPECT_FALSE(TransformPointFile("/nonexistent/points.bin",
+                                  "/nonexistent/transformed_points.bin",
+                                  Eigen::Matrix4f::Identity(), options,
+                                  nullptr, &error_info_log));
+  EXPECT_GT(error_info_log.size(), 0);
+}
+
+}  // namespace wvu
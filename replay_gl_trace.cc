@@ -0,0 +1,170 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+// Replays a trace recorded by draw_triangle --trace_output as fast as possible
+// and reports the CPU time spent submitting every frame. The first frame also
+// creates the objects of the trace, so it is reported apart. The window is
+// hidden and the swap interval is zero, so the replay is not tied to the
+// display, e.g., under Xvfb with llvmpipe.
+//
+// Example:
+//
+// ./bin/replay_gl_trace --trace=/tmp/triangle.trace --repetitions=10
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "gl_trace.h"
+
+// Use the right namespace for google flags (gflags).
+#ifdef GFLAGS_NAMESPACE_GOOGLE
+#define CS470_GFLAGS_NAMESPACE google
+#else
+#define CS470_GFLAGS_NAMESPACE gflags
+#endif
+
+DEFINE_string(trace, "", "Filepath of the trace to replay.");
+DEFINE_int32(repetitions, 1,
+             "Number of times the frames after the first one are replayed.");
+DEFINE_bool(print_frames, false, "Print the submit time of every frame.");
+
+// Annonymous namespace for helper functions.
+namespace {
+// Window dimensions. The trace sets its own viewport.
+constexpr int kWindowWidth = 640;
+constexpr int kWindowHeight = 480;
+
+// Returns the given percentile of the sorted times.
+double Percentile(const std::vector<double>& sorted_times,
+                  const double percentile) {
+  const size_t index = static_cast<size_t>(
+      percentile * (sorted_times.size() - 1) + 0.5);
+  return sorted_times[index];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CS470_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_trace.empty()) {
+    std::cerr << "ERROR: --trace is required.\n";
+    return -1;
+  }
+  if (!glfwInit()) {
+    return -1;
+  }
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  GLFWwindow* window = glfwCreateWindow(kWindowWidth, kWindowHeight,
+                                        "Replay", nullptr, nullptr);
+  if (!window) {
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+  glewExperimental = GL_TRUE;
+  if (glewInit() != GLEW_OK) {
+    std::cerr << "Glew did not initialize properly!" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+
+  int exit_code = 0;
+  {
+    // The replayer deletes its objects, so it goes before the context.
+    wvu::GLTraceReplayer replayer;
+    std::string error_info_log;
+    if (!replayer.Load(FLAGS_trace, &error_info_log)) {
+      std::cerr << "ERROR: " << error_info_log << "\n";
+      exit_code = -1;
+    } else if (replayer.num_frames() == 0) {
+      std::cerr << "ERROR: " << FLAGS_trace << " has no frames.\n";
+      exit_code = -1;
+    } else {
+      const double first_frame_seconds = replayer.ReplayFrame(0);
+      glfwSwapBuffers(window);
+      std::vector<double> frame_seconds;
+      for (int repetition = 0; repetition < FLAGS_repetitions;
+           ++repetition) {
+        for (int i = 1; i < replayer.num_frames(); ++i) {
+          frame_seconds.push_back(replayer.ReplayFrame(i));
+          glfwSwapBuffers(window);
+          if (FLAGS_print_frames) {
+            std::cout << "Frame " << i << ": " << replayer.num_calls(i)
+                      << " calls, " << 1e6 * frame_seconds.back()
+                      << " us\n";
+          }
+        }
+      }
+      glFinish();
+
+      std::cout << "Frame 0 (creates the objects): "
+                << replayer.num_calls(0) << " calls, "
+                << 1e6 * first_frame_seconds << " us\n";
+      if (!frame_seconds.empty()) {
+        double total_seconds = 0.0;
+        for (const double seconds : frame_seconds) {
+          total_seconds += seconds;
+        }
+        std::sort(frame_seconds.begin(), frame_seconds.end());
+        std::cout << "Replayed " << frame_seconds.size() << " frames.\n"
+                  << "Submit time per frame: mean "
+                  << 1e6 * total_seconds / frame_seconds.size()
+                  << " us, median " << 1e6 * Percentile(frame_seconds, 0.5)
+                  << " us, p99 " << 1e6 * Percentile(frame_seconds, 0.99)
+                  << " us, max " << 1e6 * frame_seconds.back() << " us\n";
+      }
+      const GLenum error = glGetError();
+      if (error != GL_NO_ERROR) {
+        std::cerr << "ERROR: The replay raised the OpenGL error 0x"
+                  << std::hex << error << std::dec << ".\n";
+        exit_code = -1;
+      }
+    }
+  }
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  return exit_code;
+}
@@ -0,0 +1,320 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_hot_reloader.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>  // For strerror.
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "glog/logging.h"
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// Time in milliseconds to wait for more events after a change. Editors often
+// write a file in several steps, e.g., truncate and write, or write and rename.
+constexpr int kDebounceMilliseconds = 50;
+
+// Size of the buffer that receives inotify events.
+constexpr int kEventBufferSize = 4096;
+
+// Splits a filepath into its directory and filename. A path without directory
+// refers to the working directory.
+void SplitFilepath(const std::string& filepath,
+                   std::string* directory,
+                   std::string* filename) {
+  const size_t slash = filepath.find_last_of('/');
+  if (slash == std::string::npos) {
+    *directory = ".";
+    *filename = filepath;
+  } else {
+    *directory = slash == 0 ? "/" : filepath.substr(0, slash);
+    *filename = filepath.substr(slash + 1);
+  }
+}
+
+// Returns the filepath in the form used to match inotify events, i.e., the
+// directory and the filename joined by a slash.
+std::string NormalizeFilepath(const std::string& filepath) {
+  std::string directory, filename;
+  SplitFilepath(filepath, &directory, &filename);
+  return directory == "/" ? "/" + filename : directory + "/" + filename;
+}
+
+}  // namespace
+
+ShaderHotReloader::ShaderHotReloader(GLFWwindow* shared_context)
+    : shared_context_(shared_context),
+      inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      stop_event_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      num_reloads_(0) {
+  if (inotify_fd_ >= 0 && stop_event_fd_ >= 0) {
+    watcher_thread_ = std::thread(&ShaderHotReloader::WatchFiles, this);
+  }
+}
+
+ShaderHotReloader::~ShaderHotReloader() {
+  if (watcher_thread_.joinable()) {
+    const uint64_t kStop = 1;
+    const ssize_t unused = write(stop_event_fd_, &kStop, sizeof(kStop));
+    (void)unused;
+    watcher_thread_.join();
+  }
+  if (inotify_fd_ >= 0) close(inotify_fd_);
+  if (stop_event_fd_ >= 0) close(stop_event_fd_);
+}
+
+int ShaderHotReloader::Watch(const std::string& vertex_shader_path,
+                             const std::string& fragment_shader_path,
+                             std::string* error_info_log) {
+  if (!watcher_thread_.joinable()) {
+    if (error_info_log) {
+      *error_info_log = "Could not start watching files with inotify.";
+    }
+    return -1;
+  }
+  std::unique_ptr<WatchedProgram> watched_program(new WatchedProgram);
+  watched_program->vertex_shader_path = NormalizeFilepath(vertex_shader_path);
+  watched_program->fragment_shader_path =
+      NormalizeFilepath(fragment_shader_path);
+  watched_program->changed = false;
+  watched_program->program.reset(new ShaderProgram);
+  ShaderProgram* program = watched_program->program.get();
+  if (!program->LoadVertexShaderFromFile(vertex_shader_path) ||
+      !program->LoadFragmentShaderFromFile(fragment_shader_path)) {
+    if (error_info_log) {
+      *error_info_log = "Could not read " + vertex_shader_path + " or " +
+          fragment_shader_path;
+    }
+    return -1;
+  }
+  if (!program->Create(error_info_log)) {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Watch the directories rather than the files: editors often save by writing
+  // a new file and renaming it, which would drop a watch on the file itself.
+  // Only finished writes and renames count; a created file is still empty.
+  for (const std::string& filepath :
+           { watched_program->vertex_shader_path,
+             watched_program->fragment_shader_path }) {
+    std::string directory, filename;
+    SplitFilepath(filepath, &directory, &filename);
+    if (std::find(watched_directories_.begin(), watched_directories_.end(),
+                  directory) != watched_directories_.end()) {
+      continue;
+    }
+    const int watch_descriptor = inotify_add_watch(
+        inotify_fd_, directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch_descriptor < 0) {
+      if (error_info_log) {
+        *error_info_log = "Could not watch " + directory;
+      }
+      return -1;
+    }
+    watched_directories_.push_back(directory);
+    directory_watch_descriptors_.push_back(watch_descriptor);
+  }
+  watched_programs_.push_back(std::move(watched_program));
+  return static_cast<int>(watched_programs_.size()) - 1;
+}
+
+ShaderProgram* ShaderHotReloader::program(const int handle) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return watched_programs_[handle]->program.get();
+}
+
+bool ShaderHotReloader::SwapReloadedPrograms(std::string* error_info_log) {
+  // The old programs are deleted after releasing the lock, so the watcher
+  // thread is never blocked by OpenGL calls of the rendering thread.
+  std::vector<std::unique_ptr<ShaderProgram> > old_programs;
+  std::string error_logs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::unique_ptr<WatchedProgram>& watched_program :
+             watched_programs_) {
+      if (watched_program->reloaded_program) {
+        old_programs.push_back(std::move(watched_program->program));
+        watched_program->program = std::move(watched_program->reloaded_program);
+        ++num_reloads_;
+      }
+      if (!watched_program->error_info_log.empty()) {
+        error_logs += watched_program->error_info_log;
+        watched_program->error_info_log.clear();
+      }
+    }
+  }
+  if (!error_logs.empty()) {
+    if (error_info_log) {
+      *error_info_log = error_logs;
+    }
+    return false;
+  }
+  return true;
+}
+
+void ShaderHotReloader::WatchFiles() {
+  // The programs are built on the shared context, which stays current in this
+  // thread for its whole life.
+  glfwMakeContextCurrent(shared_context_);
+  pollfd poll_fds[2];
+  poll_fds[0].fd = inotify_fd_;
+  poll_fds[0].events = POLLIN;
+  poll_fds[1].fd = stop_event_fd_;
+  poll_fds[1].events = POLLIN;
+  alignas(inotify_event) char buffer[kEventBufferSize];
+  bool has_changes = false;
+  while (true) {
+    // Block until something happens. Once a change arrives, wait a little for
+    // more changes before rebuilding.
+    const int timeout = has_changes ? kDebounceMilliseconds : -1;
+    const int num_ready = poll(poll_fds, 2, timeout);
+    if (num_ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Other errors would repeat forever, so the thread stops watching.
+      LOG(ERROR) << "Stopped watching the shaders, poll failed: "
+                 << strerror(errno);
+      break;
+    }
+    if (poll_fds[1].revents & POLLIN) {
+      break;
+    }
+    if (num_ready == 0) {
+      ReloadChangedPrograms();
+      has_changes = false;
+      continue;
+    }
+    ssize_t num_bytes;
+    while ((num_bytes = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+      for (char* event_ptr = buffer; event_ptr < buffer + num_bytes; ) {
+        const inotify_event* event =
+            reinterpret_cast<const inotify_event*>(event_ptr);
+        if (event->len > 0) {
+          std::string directory;
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto descriptor = std::find(
+                directory_watch_descriptors_.begin(),
+                directory_watch_descriptors_.end(), event->wd);
+            if (descriptor != directory_watch_descriptors_.end()) {
+              directory = watched_directories_[
+                  descriptor - directory_watch_descriptors_.begin()];
+            }
+          }
+          if (!directory.empty()) {
+            OnFileChanged(NormalizeFilepath(directory + "/" + event->name));
+            has_changes = true;
+          }
+        }
+        event_ptr += sizeof(inotify_event) + event->len;
+      }
+    }
+  }
+  glfwMakeContextCurrent(nullptr);
+}
+
+void ShaderHotReloader::OnFileChanged(const std::string& filepath) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::unique_ptr<WatchedProgram>& watched_program : watched_programs_) {
+    if (watched_program->vertex_shader_path == filepath ||
+        watched_program->fragment_shader_path == filepath) {
+      watched_program->changed = true;
+    }
+  }
+}
+
+void ShaderHotReloader::ReloadChangedPrograms() {
+  // Collect the changed programs first, so that the lock is not held while
+  // compiling.
+  std::vector<std::pair<int, std::pair<std::string, std::string> > > changed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < static_cast<int>(watched_programs_.size()); ++i) {
+      if (watched_programs_[i]->changed) {
+        watched_programs_[i]->changed = false;
+        changed.emplace_back(
+            i, std::make_pair(watched_programs_[i]->vertex_shader_path,
+                              watched_programs_[i]->fragment_shader_path));
+      }
+    }
+  }
+  for (const auto& changed_program : changed) {
+    std::unique_ptr<ShaderProgram> program(new ShaderProgram);
+    std::string error_info_log;
+    bool success =
+        program->LoadVertexShaderFromFile(changed_program.second.first) &&
+        program->LoadFragmentShaderFromFile(changed_program.second.second);
+    if (!success) {
+      error_info_log = "Could not read " + changed_program.second.first +
+          " or " + changed_program.second.second;
+    } else {
+      success = program->Create(&error_info_log);
+    }
+    if (success) {
+      // Make sure the driver finished building the program before the
+      // rendering context uses it.
+      glFinish();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    WatchedProgram* watched_program =
+        watched_programs_[changed_program.first].get();
+    if (success) {
+      // A newer reload replaces one that was not swapped in yet.
+      watched_program->reloaded_program = std::move(program);
+    } else {
+      watched_program->error_info_log = error_info_log;
+    }
+  }
+}
+
+}  // namespace wvu
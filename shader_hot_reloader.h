@@ -0,0 +1,156 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_HOT_RELOADER_H_
+#define GLUTILS_SHADER_HOT_RELOADER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader_program.h"
+
+struct GLFWwindow;
+
+namespace wvu {
+// This class reloads shader programs when their source files change on disk.
+// A background thread watches the files with inotify and, when a file
+// changes, compiles and links the new program on a context that shares its
+// objects with the rendering context. The rendering loop keeps using the old
+// program until the new one is linked; it then calls SwapReloadedPrograms()
+// at a frame boundary, which replaces the programs in a single step. A reload
+// therefore never stalls the rendering loop. A source that fails to compile is
+// reported and the old program stays in use.
+//
+// The shared context is a hidden window created with the rendering window as
+// its share argument. The reloader makes it current on its own thread, so it
+// must not be current anywhere else.
+//
+// Example.
+//
+// glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+// GLFWwindow* reload_window = glfwCreateWindow(1, 1, "", nullptr, window);
+// wvu::ShaderHotReloader reloader(reload_window);
+// const int handle = reloader.Watch("/path/to/vertex_shader",
+//                                   "/path/to/fragment_shader",
+//                                   &error_info_log);
+// while (...) {  // Rendering loop.
+//   if (!reloader.SwapReloadedPrograms(&error_info_log)) {
+//     LOG(ERROR) << error_info_log;
+//   }
+//   reloader.program(handle)->Use();
+//   ...
+// }
+class ShaderHotReloader {
+ public:
+  // Starts the watcher thread. The shared_context window must outlive the
+  // reloader.
+  explicit ShaderHotReloader(GLFWwindow* shared_context);
+  // Stops the watcher thread. Must be called from the rendering thread since it
+  // deletes the programs.
+  ~ShaderHotReloader();
+
+  // Creates a program from the shader files and starts watching them. The
+  // program is built on the calling thread, which must have the rendering
+  // context current. Returns the handle of the program if successful, and -1
+  // otherwise, in which case error_info_log holds the error log.
+  //
+  // Parameters:
+  //   vertex_shader_path  The filepath for the vertex shader.
+  //   fragment_shader_path  The filepath for the fragment shader.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  int Watch(const std::string& vertex_shader_path,
+            const std::string& fragment_shader_path,
+            std::string* error_info_log);
+
+  // Returns the program currently used for the handle. The pointer changes
+  // when SwapReloadedPrograms() swaps in a reloaded program.
+  ShaderProgram* program(const int handle) const;
+
+  // Replaces every program that was reloaded since the last call with its new
+  // version and deletes the old version. Call it from the rendering thread at a
+  // frame boundary. Returns false if a reload failed since the last call, in
+  // which case error_info_log holds the error logs, and true otherwise.
+  bool SwapReloadedPrograms(std::string* error_info_log);
+
+  // Returns the number of programs swapped in since the reloader was created.
+  int num_reloads() const {
+    return num_reloads_;
+  }
+
+ private:
+  // A watched program.
+  struct WatchedProgram {
+    std::string vertex_shader_path;
+    std::string fragment_shader_path;
+    // The program used for rendering.
+    std::unique_ptr<ShaderProgram> program;
+    // The reloaded program waiting to be swapped in.
+    std::unique_ptr<ShaderProgram> reloaded_program;
+    // True when a watched file changed and the program was not reloaded yet.
+    bool changed;
+    // The error log of the last failed reload.
+    std::string error_info_log;
+  };
+
+  // Waits for file changes and rebuilds the changed programs. Runs on
+  // watcher_thread_.
+  void WatchFiles();
+  // Rebuilds the programs whose files changed.
+  void ReloadChangedPrograms();
+  // Marks the programs that use the given file as changed.
+  void OnFileChanged(const std::string& filepath);
+
+  // The window whose context is used to build the reloaded programs.
+  GLFWwindow* shared_context_;
+  // The inotify instance, and the event used to wake up the watcher thread
+  // when the reloader is destroyed.
+  int inotify_fd_;
+  int stop_event_fd_;
+  // The watched directories and their inotify watch descriptors, in the same
+  // order.
+  std::vector<std::string> watched_directories_;
+  std::vector<int> directory_watch_descriptors_;
+  // Guards watched_programs_ and the watched directories.
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<WatchedProgram> > watched_programs_;
+  int num_reloads_;
+  std::thread watcher_thread_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_HOT_RELOADER_H_
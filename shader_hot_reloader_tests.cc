@@ -0,0 +1,145 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdlib.h>
+#include <unistd.h>
+
+// C++ headers.
+#include <chrono>
+#include <string>
+
+// System specific headers.
+#include "gtest/gtest.h"
+#include "shader_hot_reloader.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace wvu {
+namespace {
+// Calls SwapReloadedPrograms until a program is swapped in or a reload fails,
+// for at most five seconds. Returns the result of the last call.
+bool WaitForReload(ShaderHotReloader* reloader, std::string* error_info_log) {
+  const int num_reloads = reloader->num_reloads();
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (!reloader->SwapReloadedPrograms(error_info_log)) {
+      return false;
+    }
+    if (reloader->num_reloads() > num_reloads) {
+      return true;
+    }
+    usleep(10000);
+  }
+  return true;
+}
+
+class ShaderHotReloaderTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderHotReloaderTest, HotReloadsChangedShaderFiles) {
+  char shader_directory[] = "/tmp/shader_hot_reload_XXXXXX";
+  ASSERT_NE(mkdtemp(shader_directory), nullptr);
+  const std::string vertex_shader_path =
+      std::string(shader_directory) + "/shader.vert";
+  const std::string fragment_shader_path =
+      std::string(shader_directory) + "/shader.frag";
+  WriteFile(vertex_shader_path, vertex_shader_src);
+  WriteFile(fragment_shader_path, fragment_shader_src);
+
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  GLFWwindow* reload_window = glfwCreateWindow(1, 1, "", nullptr, window);
+  ASSERT_NE(reload_window, nullptr);
+  {
+    ShaderHotReloader reloader(reload_window);
+    std::string error_info_log;
+    const int handle =
+        reloader.Watch(vertex_shader_path, fragment_shader_path,
+                       &error_info_log);
+    ASSERT_GE(handle, 0) << error_info_log;
+    const ShaderProgram* original_program = reloader.program(handle);
+    EXPECT_EQ(original_program->GetUniformHandle("tint"),
+              ShaderProgram::kInvalidUniformHandle);
+
+    // Nothing changed, so nothing is swapped in.
+    EXPECT_TRUE(reloader.SwapReloadedPrograms(&error_info_log));
+    EXPECT_EQ(reloader.program(handle), original_program);
+
+    WriteFile(fragment_shader_path,
+              "#version 330 core\n"
+              "uniform vec4 tint;\n"
+              "out vec4 color;\n"
+              "void main() {\n"
+              "color = tint;\n"
+              "}\n");
+    ASSERT_TRUE(WaitForReload(&reloader, &error_info_log)) << error_info_log;
+    EXPECT_EQ(reloader.num_reloads(), 1);
+    ShaderProgram* reloaded_program = reloader.program(handle);
+    EXPECT_NE(reloaded_program->GetUniformHandle("tint"),
+              ShaderProgram::kInvalidUniformHandle);
+    EXPECT_TRUE(reloaded_program->Use());
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+    // A broken edit is reported and the last good program stays in use.
+    WriteFile(fragment_shader_path, "#version 330 core\nvoid main() {\n");
+    EXPECT_FALSE(WaitForReload(&reloader, &error_info_log));
+    EXPECT_FALSE(error_info_log.empty());
+    EXPECT_EQ(reloader.num_reloads(), 1);
+    EXPECT_EQ(reloader.program(handle), reloaded_program);
+  }
+  glfwDestroyWindow(reload_window);
+  glfwMakeContextCurrent(window);
+  RemoveDirectory(shader_directory);
+}
+
+TEST_F(ShaderHotReloaderTest, HotReloaderReportsMissingShaderFiles) {
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  GLFWwindow* reload_window = glfwCreateWindow(1, 1, "", nullptr, window);
+  ASSERT_NE(reload_window, nullptr);
+  {
+    ShaderHotReloader reloader(reload_window);
+    std::string error_info_log;
+    EXPECT_EQ(reloader.Watch("/nonexistent/shader.vert",
+                             "/nonexistent/shader.frag", &error_info_log),
+              -1);
+    EXPECT_FALSE(error_info_log.empty());
+  }
+  glfwDestroyWindow(reload_window);
+  glfwMakeContextCurrent(window);
+}
+
+}  // namespace wvu
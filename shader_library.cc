@@ -0,0 +1,146 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_library.h"
+
+#include <dirent.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// Extensions of the vertex and fragment shader files.
+constexpr char kVertexShaderExtension[] = ".vert";
+constexpr char kFragmentShaderExtension[] = ".frag";
+
+// The files of a program.
+struct ProgramFiles {
+  std::string vertex_shader_path;
+  std::string fragment_shader_path;
+};
+
+// Returns true if the filename ends with the extension, and sets name to the
+// filename without it.
+bool HasExtension(const std::string& filename,
+                  const std::string& extension,
+                  std::string* name) {
+  if (filename.size() <= extension.size() ||
+      filename.compare(filename.size() - extension.size(), extension.size(),
+                       extension) != 0) {
+    return false;
+  }
+  *name = filename.substr(0, filename.size() - extension.size());
+  return true;
+}
+
+}  // namespace
+
+bool ShaderLibrary::LoadDirectory(const std::string& directory,
+                                  std::string* error_info_log) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    if (error_info_log) {
+      *error_info_log = "Could not open " + directory;
+    }
+    return false;
+  }
+  // The map orders the programs by name, so they load in the same order on
+  // every run.
+  std::map<std::string, ProgramFiles> program_files;
+  while (const dirent* entry = readdir(dir)) {
+    const std::string filename = entry->d_name;
+    std::string name;
+    if (HasExtension(filename, kVertexShaderExtension, &name)) {
+      program_files[name].vertex_shader_path = directory + "/" + filename;
+    } else if (HasExtension(filename, kFragmentShaderExtension, &name)) {
+      program_files[name].fragment_shader_path = directory + "/" + filename;
+    }
+  }
+  closedir(dir);
+
+  std::string error_logs;
+  // Read and submit every program before waiting for any of them.
+  std::vector<std::pair<std::string, std::unique_ptr<ShaderProgram> > >
+      submitted_programs;
+  for (const auto& files : program_files) {
+    if (files.second.vertex_shader_path.empty() ||
+        files.second.fragment_shader_path.empty()) {
+      error_logs += "Program " + files.first +
+          " lacks its vertex or fragment shader.\n";
+      continue;
+    }
+    std::unique_ptr<ShaderProgram> shader_program(new ShaderProgram);
+    if (!shader_program->LoadVertexShaderFromFile(
+            files.second.vertex_shader_path) ||
+        !shader_program->LoadFragmentShaderFromFile(
+            files.second.fragment_shader_path)) {
+      error_logs += "Could not read the shaders of " + files.first + ".\n";
+      continue;
+    }
+    shader_program->set_label(files.first);
+    shader_program->CreateAsync();
+    submitted_programs.emplace_back(files.first, std::move(shader_program));
+  }
+
+  for (auto& submitted_program : submitted_programs) {
+    std::string program_error_info_log;
+    if (!submitted_program.second->Finish(&program_error_info_log)) {
+      error_logs += "Program " + submitted_program.first + ": " +
+          program_error_info_log + "\n";
+      continue;
+    }
+    programs_[submitted_program.first] = std::move(submitted_program.second);
+  }
+  if (!error_logs.empty()) {
+    if (error_info_log) {
+      *error_info_log = error_logs;
+    }
+    return false;
+  }
+  return true;
+}
+
+ShaderProgram* ShaderLibrary::program(const std::string& name) const {
+  const auto shader_program = programs_.find(name);
+  return shader_program == programs_.end() ?
+      nullptr : shader_program->second.get();
+}
+
+}  // namespace wvu
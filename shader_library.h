@@ -0,0 +1,92 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_LIBRARY_H_
+#define GLUTILS_SHADER_LIBRARY_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "shader_program.h"
+
+namespace wvu {
+// This class loads every shader program of a directory in a single call. A
+// program is a pair of files that share their name and have the extensions
+// ".vert" and ".frag", e.g., "phong.vert" and "phong.frag" form the program
+// "phong". The files are read one program at a time, and every program is
+// submitted with CreateAsync() as soon as its files are read, so the driver
+// compiles the programs read so far while the next files are read. Each file
+// is read with a single read() straight into the program, and the sources are
+// passed to glShaderSource() with their length.
+//
+// Example.
+//
+// wvu::ShaderLibrary shader_library;
+// if (!shader_library.LoadDirectory("/path/to/shaders", &error_info_log)) {
+//   LOG(ERROR) << error_info_log;
+// }
+// wvu::ShaderProgram* phong = shader_library.program("phong");
+class ShaderLibrary {
+ public:
+  ShaderLibrary() {}
+
+  // Loads and creates every program of the directory. A program that cannot be
+  // created, or a file without its counterpart, does not prevent loading the
+  // other programs. Returns true if every program was created, and false
+  // otherwise, in which case error_info_log holds the error logs. A program
+  // with the name of a loaded one replaces it.
+  //
+  // Parameters:
+  //   directory  The directory that holds the shader files.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool LoadDirectory(const std::string& directory,
+                     std::string* error_info_log);
+
+  // Returns the program with the given name, or a null pointer if the library
+  // has no such program.
+  ShaderProgram* program(const std::string& name) const;
+
+  // Returns the number of programs in the library.
+  int num_programs() const {
+    return static_cast<int>(programs_.size());
+  }
+
+ private:
+  std::unordered_map<std::string, std::unique_ptr<ShaderProgram> > programs_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_LIBRARY_H_
@@ -0,0 +1,109 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdlib.h>
+
+// C++ headers.
+#include <chrono>
+#include <string>
+
+// System specific headers.
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_library.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class ShaderLibraryTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderLibraryTest, LoadsShaderDirectory) {
+  char shader_directory[] = "/tmp/shader_library_XXXXXX";
+  ASSERT_NE(mkdtemp(shader_directory), nullptr);
+  constexpr int kNumPrograms = 16;
+  for (int i = 0; i < kNumPrograms; ++i) {
+    const std::string name =
+        std::string(shader_directory) + "/program" + std::to_string(i);
+    WriteFile(name + ".vert", vertex_shader_src);
+    WriteFile(name + ".frag", MakeFragmentShaderSource(i));
+  }
+  // Files that are not shaders are ignored.
+  WriteFile(std::string(shader_directory) + "/README", "Shaders.\n");
+
+  ShaderLibrary shader_library;
+  std::string error_info_log;
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(shader_library.LoadDirectory(shader_directory, &error_info_log))
+      << error_info_log;
+  const auto end = std::chrono::steady_clock::now();
+  LOG(INFO) << "Loaded " << kNumPrograms << " programs in "
+            << std::chrono::duration<double, std::milli>(end - start).count()
+            << " ms";
+  EXPECT_EQ(shader_library.num_programs(), kNumPrograms);
+  for (int i = 0; i < kNumPrograms; ++i) {
+    const ShaderProgram* shader_program =
+        shader_library.program("program" + std::to_string(i));
+    ASSERT_NE(shader_program, nullptr);
+    EXPECT_GT(shader_program->shader_program_id(), 0);
+  }
+  EXPECT_EQ(shader_library.program("README"), nullptr);
+  RemoveDirectory(shader_directory);
+}
+
+TEST_F(ShaderLibraryTest, ShaderDirectoryReportsBrokenPrograms) {
+  char shader_directory[] = "/tmp/shader_library_XXXXXX";
+  ASSERT_NE(mkdtemp(shader_directory), nullptr);
+  const std::string directory = shader_directory;
+  WriteFile(directory + "/good.vert", vertex_shader_src);
+  WriteFile(directory + "/good.frag", fragment_shader_src);
+  WriteFile(directory + "/broken.vert", vertex_shader_src);
+  WriteFile(directory + "/broken.frag", fragment_shader_src + "asdasd;");
+  WriteFile(directory + "/lonely.vert", vertex_shader_src);
+
+  ShaderLibrary shader_library;
+  std::string error_info_log;
+  EXPECT_FALSE(shader_library.LoadDirectory(directory, &error_info_log));
+  EXPECT_NE(error_info_log.find("broken"), std::string::npos);
+  EXPECT_NE(error_info_log.find("lonely"), std::string::npos);
+  EXPECT_EQ(shader_library.num_programs(), 1);
+  EXPECT_NE(shader_library.program("good"), nullptr);
+  EXPECT_FALSE(shader_library.LoadDirectory("/nonexistent", &error_info_log));
+  RemoveDirectory(directory);
+}
+
+}  // namespace wvu
@@ -0,0 +1,185 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_pipeline.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <GL/glew.h>
+
+#include "shader_program.h"
+
+namespace wvu {
+namespace {
+// Counter of the separable programs linked.
+std::atomic<uint64_t> num_linked_separable_programs(0);
+
+// The pipeline bound in the calling thread by ShaderProgramPipeline::Use(), or
+// zero when unknown.
+thread_local GLuint thread_bound_pipeline_id = 0;
+
+// Returns the bit of glUseProgramStages() for the shader type, or 0 if the
+// type is not a stage of a pipeline.
+GLbitfield GetShaderStageBit(const GLenum shader_type) {
+  switch (shader_type) {
+    case GL_VERTEX_SHADER:
+      return GL_VERTEX_SHADER_BIT;
+    case GL_TESS_CONTROL_SHADER:
+      return GL_TESS_CONTROL_SHADER_BIT;
+    case GL_TESS_EVALUATION_SHADER:
+      return GL_TESS_EVALUATION_SHADER_BIT;
+    case GL_GEOMETRY_SHADER:
+      return GL_GEOMETRY_SHADER_BIT;
+    case GL_FRAGMENT_SHADER:
+      return GL_FRAGMENT_SHADER_BIT;
+    case GL_COMPUTE_SHADER:
+      return GL_COMPUTE_SHADER_BIT;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+bool SeparableShaderProgram::Create(const GLenum shader_type,
+                                    const std::string& shader_src,
+                                    std::string* error_info_log) {
+  if (program_id_ != 0) {
+    return true;
+  }
+  if (!GLEW_VERSION_4_1 && !GLEW_ARB_separate_shader_objects) {
+    if (error_info_log) {
+      *error_info_log = "Separable programs require OpenGL 4.1 or "
+          "ARB_separate_shader_objects.";
+    }
+    return false;
+  }
+  if (GetShaderStageBit(shader_type) == 0) {
+    if (error_info_log) {
+      *error_info_log = "Invalid shader type.";
+    }
+    return false;
+  }
+  // Compiles, flags as separable and links in a single call.
+  const char* shader_src_ptr = shader_src.c_str();
+  const GLuint program_id = glCreateShaderProgramv(shader_type, 1,
+                                                   &shader_src_ptr);
+  ++num_linked_separable_programs;
+  GLint success = 0;
+  glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+  if (!success) {
+    if (error_info_log) {
+      // The log of the program holds the compilation log too.
+      GLint log_length = 0;
+      glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &log_length);
+      error_info_log->resize(log_length > 0 ? log_length : 1);
+      glGetProgramInfoLog(program_id, error_info_log->size(), nullptr,
+                          &error_info_log->front());
+    }
+    glDeleteProgram(program_id);
+    return false;
+  }
+  shader_type_ = shader_type;
+  program_id_ = program_id;
+  return true;
+}
+
+uint64_t SeparableShaderProgram::num_program_links() {
+  return num_linked_separable_programs;
+}
+
+bool ShaderProgramPipeline::Create() {
+  if (pipeline_id_ != 0) {
+    return true;
+  }
+  if (!GLEW_VERSION_4_1 && !GLEW_ARB_separate_shader_objects) {
+    return false;
+  }
+  glGenProgramPipelines(1, &pipeline_id_);
+  return pipeline_id_ != 0;
+}
+
+bool ShaderProgramPipeline::UseStage(const SeparableShaderProgram& program) {
+  if (pipeline_id_ == 0 || program.program_id() == 0) {
+    return false;
+  }
+  glUseProgramStages(pipeline_id_, GetShaderStageBit(program.shader_type()),
+                     program.program_id());
+  return true;
+}
+
+bool ShaderProgramPipeline::Use() const {
+  if (pipeline_id_ == 0) {
+    return false;
+  }
+  // The pipeline is ignored while a program is bound.
+  ShaderProgram::UseNoProgram();
+  if (thread_bound_pipeline_id != pipeline_id_) {
+    glBindProgramPipeline(pipeline_id_);
+    thread_bound_pipeline_id = pipeline_id_;
+  }
+  return true;
+}
+
+void ShaderProgramPipeline::InvalidateBoundPipeline() {
+  thread_bound_pipeline_id = 0;
+}
+
+void ShaderProgramPipeline::OnPipelineDeleted() const {
+  // A new pipeline could get the same id once OpenGL releases this one.
+  if (thread_bound_pipeline_id == pipeline_id_) {
+    thread_bound_pipeline_id = 0;
+  }
+}
+
+bool ShaderProgramPipeline::Validate(std::string* error_info_log) const {
+  glValidateProgramPipeline(pipeline_id_);
+  GLint success = 0;
+  glGetProgramPipelineiv(pipeline_id_, GL_VALIDATE_STATUS, &success);
+  if (!success) {
+    if (error_info_log) {
+      GLint log_length = 0;
+      glGetProgramPipelineiv(pipeline_id_, GL_INFO_LOG_LENGTH, &log_length);
+      error_info_log->resize(log_length > 0 ? log_length : 1);
+      glGetProgramPipelineInfoLog(pipeline_id_, error_info_log->size(),
+                                  nullptr, &error_info_log->front());
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace wvu
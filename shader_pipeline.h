@@ -0,0 +1,171 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_PIPELINE_H_
+#define GLUTILS_SHADER_PIPELINE_H_
+
+#include <stdint.h>
+#include <string>
+#include <GL/glew.h>
+
+namespace wvu {
+// This class compiles a single shader stage and links it alone into a
+// separable program (GL_PROGRAM_SEPARABLE). Separable programs of different
+// stages are combined at bind time by a ShaderProgramPipeline, so N vertex
+// variants and M fragment variants need N + M links instead of the N x M links
+// of a ShaderProgram per combination. The interface between the stages must
+// match by location, e.g., layout (location = 0) out vec3 normal, since
+// separable programs are not linked together. Requires OpenGL 4.1 or
+// ARB_separate_shader_objects.
+//
+// Example.
+//
+// wvu::SeparableShaderProgram vertex_stage, fragment_stage;
+// vertex_stage.Create(GL_VERTEX_SHADER, vertex_shader_src, &error_info_log);
+// fragment_stage.Create(GL_FRAGMENT_SHADER, fragment_shader_src,
+//                       &error_info_log);
+// wvu::ShaderProgramPipeline pipeline;
+// pipeline.Create();
+// pipeline.UseStage(vertex_stage);
+// pipeline.UseStage(fragment_stage);
+// while (...) {  // Rendering loop.
+//   pipeline.Use();
+//   glProgramUniformMatrix4fv(vertex_stage.program_id(), ...);
+//   ...
+// }
+class SeparableShaderProgram {
+ public:
+  SeparableShaderProgram() : shader_type_(0), program_id_(0) {}
+  // The program is deleted by the destructor, so it cannot be copied.
+  SeparableShaderProgram(const SeparableShaderProgram&) = delete;
+  SeparableShaderProgram& operator=(const SeparableShaderProgram&) = delete;
+  ~SeparableShaderProgram() {
+    // Deleting a program used by a pipeline is deferred by OpenGL until the
+    // pipeline stops using it.
+    if (program_id_ != 0) {
+      glDeleteProgram(program_id_);
+    }
+  }
+
+  // Compiles the source and links it into a separable program. Returns true
+  // if successful, and false otherwise, in which case error_info_log holds
+  // the error log. Calling it on a created program does nothing.
+  //
+  // Parameters:
+  //   shader_type  The stage, e.g., GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+  //   shader_src  The source of the stage.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Create(const GLenum shader_type,
+              const std::string& shader_src,
+              std::string* error_info_log);
+
+  // Returns the program id, or 0 when the program was not created. Set the
+  // uniforms of the stage with glProgramUniform*() and this id.
+  GLuint program_id() const {
+    return program_id_;
+  }
+
+  // Returns the stage of the program.
+  GLenum shader_type() const {
+    return shader_type_;
+  }
+
+  // Returns the number of separable programs linked, for all threads.
+  static uint64_t num_program_links();
+
+ private:
+  GLenum shader_type_;
+  GLuint program_id_;
+};
+
+// This class wraps a program pipeline object, which combines separable
+// programs of different stages. Changing the program of a stage only updates
+// the pipeline; nothing is linked. See SeparableShaderProgram.
+class ShaderProgramPipeline {
+ public:
+  ShaderProgramPipeline() : pipeline_id_(0) {}
+  ShaderProgramPipeline(const ShaderProgramPipeline&) = delete;
+  ShaderProgramPipeline& operator=(const ShaderProgramPipeline&) = delete;
+  ~ShaderProgramPipeline() {
+    if (pipeline_id_ != 0) {
+      OnPipelineDeleted();
+      glDeleteProgramPipelines(1, &pipeline_id_);
+    }
+  }
+
+  // Creates the pipeline object. Returns true if successful, and false when
+  // separable programs are not supported.
+  bool Create();
+
+  // Uses the separable program for its stage, replacing the program that
+  // the pipeline used for that stage. The program must outlive its use by the
+  // pipeline. Returns false, and does nothing, if the pipeline or the program
+  // is not created.
+  bool UseStage(const SeparableShaderProgram& program);
+
+  // Binds the pipeline. Since a program bound with glUseProgram() takes
+  // precedence over the pipeline, the function also unbinds any program, see
+  // ShaderProgram::UseNoProgram(). As with ShaderProgram::Use(), the pipeline
+  // bound in the calling thread is remembered, so binding it again does not
+  // call OpenGL.
+  bool Use() const;
+
+  // Forgets the pipeline bound in the calling thread, so that the next Use()
+  // calls OpenGL. Call it after making a different context current or after
+  // calling glBindProgramPipeline() directly.
+  static void InvalidateBoundPipeline();
+
+  // Checks that the stages of the pipeline can be used together. Returns true
+  // if the pipeline is valid, and false otherwise, in which case
+  // error_info_log holds the error log.
+  //
+  // Parameters:
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Validate(std::string* error_info_log) const;
+
+  // Returns the pipeline id, or 0 when the pipeline was not created.
+  GLuint pipeline_id() const {
+    return pipeline_id_;
+  }
+
+ private:
+  // Forgets the pipeline if it is the one bound in the calling thread.
+  void OnPipelineDeleted() const;
+
+  GLuint pipeline_id_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_PIPELINE_H_
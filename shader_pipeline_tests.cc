@@ -0,0 +1,202 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_pipeline.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class ShaderPipelineTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderPipelineTest, SeparableProgramsAvoidLinkingEveryCombination) {
+  if (!IsSeparableProgramSupported()) {
+    LOG(INFO) << "Separable programs are not supported; skipping.";
+    return;
+  }
+  constexpr int kNumVertexVariants = 4;
+  constexpr int kNumFragmentVariants = 5;
+
+  // One program per combination.
+  const uint64_t num_links_before = ShaderProgram::num_program_links();
+  {
+    std::vector<ShaderProgram> programs(kNumVertexVariants *
+                                        kNumFragmentVariants);
+    for (int i = 0; i < kNumVertexVariants; ++i) {
+      for (int j = 0; j < kNumFragmentVariants; ++j) {
+        ShaderProgram& program = programs[i * kNumFragmentVariants + j];
+        program.LoadVertexShaderFromString(MakeSeparableVertexShaderSource(i));
+        program.LoadFragmentShaderFromString(
+            MakeSeparableFragmentShaderSource(j));
+        std::string error_info_log;
+        ASSERT_TRUE(program.Create(&error_info_log)) << error_info_log;
+      }
+    }
+    glFinish();
+  }
+  EXPECT_EQ(ShaderProgram::num_program_links() - num_links_before,
+            kNumVertexVariants * kNumFragmentVariants);
+
+  // One separable program per stage variant, combined by a pipeline.
+  const uint64_t num_separable_links_before =
+      SeparableShaderProgram::num_program_links();
+  std::vector<SeparableShaderProgram> vertex_stages(kNumVertexVariants);
+  std::vector<SeparableShaderProgram> fragment_stages(kNumFragmentVariants);
+  std::string error_info_log;
+  for (int i = 0; i < kNumVertexVariants; ++i) {
+    ASSERT_TRUE(vertex_stages[i].Create(GL_VERTEX_SHADER,
+                                        MakeSeparableVertexShaderSource(i),
+                                        &error_info_log)) << error_info_log;
+  }
+  for (int j = 0; j < kNumFragmentVariants; ++j) {
+    ASSERT_TRUE(fragment_stages[j].Create(GL_FRAGMENT_SHADER,
+                                          MakeSeparableFragmentShaderSource(j),
+                                          &error_info_log)) << error_info_log;
+  }
+  ShaderProgramPipeline pipeline;
+  ASSERT_TRUE(pipeline.Create());
+  for (int i = 0; i < kNumVertexVariants; ++i) {
+    for (int j = 0; j < kNumFragmentVariants; ++j) {
+      pipeline.UseStage(vertex_stages[i]);
+      pipeline.UseStage(fragment_stages[j]);
+      ASSERT_TRUE(pipeline.Use());
+      EXPECT_TRUE(pipeline.Validate(&error_info_log)) << error_info_log;
+    }
+  }
+  glFinish();
+  EXPECT_EQ(SeparableShaderProgram::num_program_links() -
+            num_separable_links_before,
+            kNumVertexVariants + kNumFragmentVariants);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+  glBindProgramPipeline(0);
+}
+
+TEST_F(ShaderPipelineTest, ProgramPipelineReplacesBoundProgram) {
+  if (!IsSeparableProgramSupported()) {
+    LOG(INFO) << "Separable programs are not supported; skipping.";
+    return;
+  }
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  ASSERT_TRUE(shader_program.Use());
+
+  SeparableShaderProgram vertex_stage;
+  SeparableShaderProgram fragment_stage;
+  ASSERT_TRUE(vertex_stage.Create(GL_VERTEX_SHADER,
+                                  MakeSeparableVertexShaderSource(1),
+                                  nullptr));
+  ASSERT_TRUE(fragment_stage.Create(GL_FRAGMENT_SHADER,
+                                    MakeSeparableFragmentShaderSource(1),
+                                    nullptr));
+  ShaderProgramPipeline pipeline;
+  ASSERT_TRUE(pipeline.Create());
+  ASSERT_TRUE(pipeline.UseStage(vertex_stage));
+  ASSERT_TRUE(pipeline.UseStage(fragment_stage));
+  ASSERT_TRUE(pipeline.Use());
+  GLint current_program = -1;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+  EXPECT_EQ(current_program, 0);
+  GLint current_pipeline = 0;
+  glGetIntegerv(GL_PROGRAM_PIPELINE_BINDING, &current_pipeline);
+  EXPECT_EQ(current_pipeline, pipeline.pipeline_id());
+
+  // Using the pipeline again calls OpenGL for neither the program nor the
+  // pipeline.
+  ShaderProgram::ResetProgramBindCounters();
+  ASSERT_TRUE(pipeline.Use());
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 0);
+  EXPECT_EQ(ShaderProgram::num_program_binds_skipped(), 1);
+
+  // The program binds again after the pipeline, and the pipeline unbinds it
+  // again.
+  EXPECT_TRUE(shader_program.Use());
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+  EXPECT_EQ(current_program, shader_program.shader_program_id());
+  ShaderProgram::ResetProgramBindCounters();
+  ASSERT_TRUE(pipeline.Use());
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 1);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+  EXPECT_EQ(current_program, 0);
+  glGetIntegerv(GL_PROGRAM_PIPELINE_BINDING, &current_pipeline);
+  EXPECT_EQ(current_pipeline, pipeline.pipeline_id());
+  glBindProgramPipeline(0);
+  ShaderProgramPipeline::InvalidateBoundPipeline();
+  ShaderProgram::InvalidateCurrentProgram();
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(ShaderPipelineTest, SeparableProgramReportsInvalidSource) {
+  if (!IsSeparableProgramSupported()) {
+    LOG(INFO) << "Separable programs are not supported; skipping.";
+    return;
+  }
+  SeparableShaderProgram stage;
+  std::string error_info_log;
+  EXPECT_FALSE(stage.Create(GL_FRAGMENT_SHADER,
+                            MakeSeparableFragmentShaderSource(0) + "asdasd;",
+                            &error_info_log));
+  EXPECT_FALSE(error_info_log.empty());
+  EXPECT_EQ(stage.program_id(), 0);
+  EXPECT_FALSE(stage.Create(GL_ARRAY_BUFFER, fragment_shader_src, nullptr));
+}
+
+TEST_F(ShaderPipelineTest, PipelineRejectsStagesBeforeCreation) {
+  if (!IsSeparableProgramSupported()) {
+    LOG(INFO) << "Separable programs are not supported; skipping.";
+    return;
+  }
+  SeparableShaderProgram stage;
+  ASSERT_TRUE(stage.Create(GL_VERTEX_SHADER,
+                           MakeSeparableVertexShaderSource(1), nullptr));
+  ShaderProgramPipeline pipeline;
+  EXPECT_FALSE(pipeline.UseStage(stage));
+  EXPECT_FALSE(pipeline.Use());
+  ASSERT_TRUE(pipeline.Create());
+  EXPECT_FALSE(pipeline.UseStage(SeparableShaderProgram()));
+  EXPECT_TRUE(pipeline.UseStage(stage));
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+}  // namespace wvu
@@ -0,0 +1,359 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_preprocessor.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wvu {
+namespace {
+// Returns the line without its leading whitespace.
+std::string TrimLeft(const std::string& line) {
+  const size_t start = line.find_first_not_of(" \t\r");
+  return start == std::string::npos ? "" : line.substr(start);
+}
+
+// Returns the part of the line that follows its leading whitespace and
+// comments, or an empty string if there is none. in_block_comment tells whether
+// the line starts inside a block comment, and is updated to whether the next
+// line does.
+std::string SkipLeadingComments(const std::string& line,
+                                bool* in_block_comment) {
+  size_t position = 0;
+  while (true) {
+    if (*in_block_comment) {
+      const size_t end = line.find("*/", position);
+      if (end == std::string::npos) {
+        return "";
+      }
+      *in_block_comment = false;
+      position = end + 2;
+    }
+    position = line.find_first_not_of(" \t\r", position);
+    if (position == std::string::npos ||
+        line.compare(position, 2, "//") == 0) {
+      return "";
+    }
+    if (line.compare(position, 2, "/*") != 0) {
+      return line.substr(position);
+    }
+    *in_block_comment = true;
+    position += 2;
+  }
+}
+
+// Returns true if the line has the given directive, e.g., "include". The
+// line must not have leading whitespace. Whitespace is allowed between the
+// '#' and the name of the directive, as in C.
+bool HasDirective(const std::string& line,
+                  const std::string& directive,
+                  std::string* arguments) {
+  if (line.empty() || line[0] != '#') {
+    return false;
+  }
+  const std::string rest = TrimLeft(line.substr(1));
+  if (rest.compare(0, directive.size(), directive) != 0 ||
+      (rest.size() > directive.size() &&
+       rest[directive.size()] != ' ' && rest[directive.size()] != '\t')) {
+    return false;
+  }
+  *arguments = TrimLeft(rest.substr(directive.size()));
+  return true;
+}
+
+// Parses the name of an #include directive, which is either quoted or within
+// angle brackets. Returns true if successful.
+bool ParseIncludeName(const std::string& arguments, std::string* name) {
+  if (arguments.size() < 2) {
+    return false;
+  }
+  const char closing = arguments[0] == '"' ? '"' :
+      (arguments[0] == '<' ? '>' : '\0');
+  const size_t end = arguments.find(closing, 1);
+  if (closing == '\0' || end == std::string::npos || end == 1) {
+    return false;
+  }
+  *name = arguments.substr(1, end - 1);
+  return true;
+}
+
+// Returns true if the name is a valid GLSL identifier.
+bool IsIdentifier(const std::string& name) {
+  if (name.empty() || isdigit(name[0])) {
+    return false;
+  }
+  for (const char c : name) {
+    if (!isalnum(c) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Appends the #define lines of the definitions.
+void AppendDefines(const ShaderDefines& defines, std::string* output) {
+  for (const auto& define : defines) {
+    *output += "#define " + define.first;
+    if (!define.second.empty()) {
+      *output += " " + define.second;
+    }
+    *output += "\n";
+  }
+}
+
+// Returns the #line directive that makes the next line have the given number.
+std::string LineDirective(const int line_number, const int source_number) {
+  return "#line " + std::to_string(line_number) + " " +
+      std::to_string(source_number) + "\n";
+}
+
+}  // namespace
+
+std::string MakeShaderDefinesKey(const ShaderDefines& defines) {
+  // Values cannot hold new lines, so a new line separates the definitions
+  // unambiguously.
+  std::string key;
+  for (const auto& define : defines) {
+    key += define.first + "=" + define.second + "\n";
+  }
+  return key;
+}
+
+std::string BakeShaderConstants(const std::string& source,
+                                const ShaderConstants& constants,
+                                std::set<std::string>* baked_names) {
+  std::istringstream lines(source);
+  std::string baked_source;
+  baked_source.reserve(source.size());
+  std::string line;
+  while (std::getline(lines, line)) {
+    // The declaration must be the only statement of the line: the keyword, the
+    // type, the name and a semicolon.
+    const std::string statement = TrimLeft(line);
+    const size_t semicolon = statement.find(';');
+    std::istringstream tokens(statement.substr(0, semicolon));
+    std::string keyword, type, name, extra;
+    if (semicolon != std::string::npos &&
+        TrimLeft(statement.substr(semicolon + 1)).empty() &&
+        tokens >> keyword >> type >> name && !(tokens >> extra) &&
+        keyword == "uniform" && constants.count(name) > 0) {
+      baked_source += "const " + type + " " + name + " = " +
+          constants.at(name) + ";";
+      if (baked_names) {
+        baked_names->insert(name);
+      }
+    } else {
+      baked_source += line;
+    }
+    if (!lines.eof()) {
+      baked_source += "\n";
+    }
+  }
+  return baked_source;
+}
+
+bool ReadShaderFile(const std::string& filepath, std::string* contents) {
+  const int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return false;
+  }
+  contents->resize(file_stat.st_size);
+  size_t num_bytes_read = 0;
+  bool success = true;
+  while (num_bytes_read < contents->size()) {
+    const ssize_t num_bytes = read(fd, &(*contents)[num_bytes_read],
+                                   contents->size() - num_bytes_read);
+    if (num_bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (num_bytes < 0) {
+      success = false;
+    }
+    if (num_bytes <= 0) {
+      break;
+    }
+    num_bytes_read += num_bytes;
+  }
+  close(fd);
+  // The file may have been truncated after fstat(), e.g., by an editor.
+  contents->resize(num_bytes_read);
+  return success;
+}
+
+void ShaderPreprocessor::AddIncludeDirectory(const std::string& directory) {
+  include_directories_.push_back(directory);
+}
+
+void ShaderPreprocessor::AddIncludeSource(const std::string& name,
+                                          const std::string& source) {
+  include_sources_[name] = source;
+}
+
+bool ShaderPreprocessor::Preprocess(const std::string& source,
+                                    const ShaderDefines& defines,
+                                    std::string* preprocessed_source,
+                                    std::string* error_info_log) const {
+  for (const auto& define : defines) {
+    if (!IsIdentifier(define.first) ||
+        define.second.find('\n') != std::string::npos) {
+      if (error_info_log) {
+        *error_info_log = "Invalid definition of \"" + define.first + "\"";
+      }
+      return false;
+    }
+  }
+  std::vector<std::string> included_names;
+  std::string output;
+  output.reserve(source.size());
+  if (!AppendSource(source, "source", 0, &defines, &included_names, &output,
+                    error_info_log)) {
+    return false;
+  }
+  *preprocessed_source = std::move(output);
+  return true;
+}
+
+bool ShaderPreprocessor::AppendSource(
+    const std::string& source,
+    const std::string& source_name,
+    const int source_number,
+    const ShaderDefines* defines,
+    std::vector<std::string>* included_names,
+    std::string* output,
+    std::string* error_info_log) const {
+  std::istringstream lines(source);
+  std::string line;
+  int line_number = 0;
+  bool defines_pending = defines != nullptr;
+  bool in_block_comment = false;
+  const size_t source_start = output->size();
+  while (std::getline(lines, line)) {
+    ++line_number;
+    const std::string trimmed_line = TrimLeft(line);
+    std::string arguments;
+    // The definitions go right after the #version line, which must precede
+    // everything but comments; without #version they go first.
+    if (defines_pending) {
+      const std::string code = SkipLeadingComments(line, &in_block_comment);
+      if (!code.empty()) {
+        defines_pending = false;
+        if (HasDirective(code, "version", &arguments)) {
+          *output += line + "\n";
+          AppendDefines(*defines, output);
+          *output += LineDirective(line_number + 1, source_number);
+          continue;
+        }
+        std::string definitions;
+        AppendDefines(*defines, &definitions);
+        definitions += LineDirective(1, source_number);
+        output->insert(source_start, definitions);
+      }
+    }
+
+    if (!HasDirective(trimmed_line, "include", &arguments)) {
+      *output += line + "\n";
+      continue;
+    }
+    std::string include_name;
+    const std::string location =
+        source_name + ":" + std::to_string(line_number);
+    if (!ParseIncludeName(arguments, &include_name)) {
+      if (error_info_log) {
+        *error_info_log = "Malformed #include in " + location;
+      }
+      return false;
+    }
+    if (std::find(included_names->begin(), included_names->end(),
+                  include_name) != included_names->end()) {
+      // Already included, which also stops recursive includes. Keep an empty
+      // line so the line numbers still match.
+      *output += "\n";
+      continue;
+    }
+    std::string include_source;
+    if (!FindIncludeSource(include_name, &include_source)) {
+      if (error_info_log) {
+        *error_info_log = "Could not find \"" + include_name +
+            "\" included in " + location;
+      }
+      return false;
+    }
+    included_names->push_back(include_name);
+    *output += LineDirective(1, included_names->size());
+    if (!AppendSource(include_source, include_name, included_names->size(),
+                      nullptr, included_names, output,
+                      error_info_log)) {
+      return false;
+    }
+    *output += LineDirective(line_number + 1, source_number);
+  }
+  if (defines_pending) {
+    // The source has no code at all.
+    AppendDefines(*defines, output);
+  }
+  return true;
+}
+
+bool ShaderPreprocessor::FindIncludeSource(const std::string& name,
+                                           std::string* source) const {
+  const auto include_source = include_sources_.find(name);
+  if (include_source != include_sources_.end()) {
+    *source = include_source->second;
+    return true;
+  }
+  for (const std::string& directory : include_directories_) {
+    if (ReadShaderFile(directory + "/" + name, source)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace wvu
@@ -0,0 +1,150 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_PREPROCESSOR_H_
+#define GLUTILS_SHADER_PREPROCESSOR_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wvu {
+// A set of preprocessor definitions, mapping every name to its value. An empty
+// value defines the name without a value. The map is ordered, so two equal sets
+// always produce the same source and the same key.
+typedef std::map<std::string, std::string> ShaderDefines;
+
+// Returns a string that identifies the set of definitions.
+std::string MakeShaderDefinesKey(const ShaderDefines& defines);
+
+// Values of uniforms to bake into a source as constants, mapping every name to
+// a GLSL expression, e.g., "4", "true" or "vec3(0.5f)".
+typedef std::map<std::string, std::string> ShaderConstants;
+
+// Replaces the declarations of the form
+//
+// uniform TYPE NAME;
+//
+// whose NAME has a value in constants with
+//
+// const TYPE NAME = VALUE;
+//
+// which lets the compiler fold the branches and unroll the loops that depend on
+// the uniform. Only declarations on a line of their own are replaced, so the
+// line numbers do not change. Returns the baked source, and adds the names of
+// the replaced uniforms to baked_names if it is not null.
+std::string BakeShaderConstants(const std::string& source,
+                                const ShaderConstants& constants,
+                                std::set<std::string>* baked_names);
+
+// Reads an entire shader file into contents. The string is sized once from the
+// size of the file and filled directly by read(), so the bytes are copied only
+// once. Returns true if successful, and false otherwise.
+bool ReadShaderFile(const std::string& filepath, std::string* contents);
+
+// This class prepares GLSL sources before compilation. GLSL has no #include,
+// so the class resolves the lines of the form
+//
+// #include "name"
+//
+// with the sources registered with AddIncludeSource() or, failing that, with
+// the files found in the include directories. Every source is included at
+// most once, as if it started with #pragma once. The class also injects a set
+// of #define lines right after the #version line, which lets a single source
+// produce every feature combination.
+// The preprocessed source keeps #line directives, so the line numbers that the
+// compiler reports match the original sources. The main source is string 0 and
+// the included sources are numbered in order of inclusion.
+//
+// Example.
+//
+// wvu::ShaderPreprocessor preprocessor;
+// preprocessor.AddIncludeDirectory("/path/to/shaders/include");
+// wvu::ShaderDefines defines;
+// defines["USE_LIGHTING"] = "";
+// defines["NUM_LIGHTS"] = "4";
+// std::string source;
+// if (!preprocessor.Preprocess(fragment_shader_src, defines, &source,
+//                              &error_info_log)) {
+//   LOG(ERROR) << error_info_log;
+// }
+class ShaderPreprocessor {
+ public:
+  ShaderPreprocessor() {}
+
+  // Adds a directory where included files are searched, after the directories
+  // added before.
+  void AddIncludeDirectory(const std::string& directory);
+
+  // Registers the source of an include name. Registered sources are searched
+  // before the include directories.
+  void AddIncludeSource(const std::string& name, const std::string& source);
+
+  // Resolves the includes of the source and injects the definitions. Returns
+  // true if successful, and false otherwise, in which case error_info_log
+  // holds the reason.
+  //
+  // Parameters:
+  //   source  The GLSL source to preprocess.
+  //   defines  The definitions to inject.
+  //   preprocessed_source  The resulting source.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Preprocess(const std::string& source,
+                  const ShaderDefines& defines,
+                  std::string* preprocessed_source,
+                  std::string* error_info_log) const;
+
+ private:
+  // Appends the source to the output, replacing its #include lines with the
+  // included sources. The definitions are injected only when defines is not
+  // null.
+  bool AppendSource(const std::string& source,
+                    const std::string& source_name,
+                    const int source_number,
+                    const ShaderDefines* defines,
+                    std::vector<std::string>* included_names,
+                    std::string* output,
+                    std::string* error_info_log) const;
+  // Finds the source of an include name. Returns true if found.
+  bool FindIncludeSource(const std::string& name, std::string* source) const;
+
+  std::vector<std::string> include_directories_;
+  std::unordered_map<std::string, std::string> include_sources_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_PREPROCESSOR_H_
@@ -0,0 +1,265 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdlib.h>  // For mkdtemp and mkstemp.
+#include <unistd.h>
+
+// C++ headers.
+#include <fstream>
+#include <set>
+#include <string>
+
+// System specific headers.
+#include "gtest/gtest.h"
+#include "shader_preprocessor.h"
+
+namespace wvu {
+namespace {
+const std::string fragment_shader_src =
+    "#version 330 core\n"
+    "#include \"lighting.glsl\"\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "#ifdef USE_LIGHTING\n"
+    "color = Shade(vec4(1.0f));\n"
+    "#else\n"
+    "color = vec4(1.0f);\n"
+    "#endif\n"
+    "}\n";
+
+const std::string lighting_src =
+    "#include \"common.glsl\"\n"
+    "vec4 Shade(vec4 color) { return kAmbient * color; }\n";
+
+const std::string common_src =
+    "const float kAmbient = 0.2f;\n";
+
+}  // namespace
+
+TEST(ShaderPreprocessor, InjectsDefinesAfterVersion) {
+  ShaderPreprocessor preprocessor;
+  ShaderDefines defines;
+  defines["USE_LIGHTING"] = "";
+  defines["NUM_LIGHTS"] = "4";
+  std::string source;
+  ASSERT_TRUE(preprocessor.Preprocess("// Comment.\n"
+                                      "#version 330 core\n"
+                                      "void main() {}\n",
+                                      defines, &source, nullptr));
+  EXPECT_EQ(source,
+            "// Comment.\n"
+            "#version 330 core\n"
+            "#define NUM_LIGHTS 4\n"
+            "#define USE_LIGHTING\n"
+            "#line 3 0\n"
+            "void main() {}\n");
+
+  // Without #version the definitions go first.
+  ASSERT_TRUE(preprocessor.Preprocess("void main() {}\n", defines, &source,
+                                      nullptr));
+  EXPECT_EQ(source,
+            "#define NUM_LIGHTS 4\n"
+            "#define USE_LIGHTING\n"
+            "#line 1 0\n"
+            "void main() {}\n");
+}
+
+// #version may follow block comments, e.g., a license header, and defines
+// placed before it would make the shader invalid.
+TEST(ShaderPreprocessor, InjectsDefinesAfterBlockComments) {
+  ShaderPreprocessor preprocessor;
+  ShaderDefines defines;
+  defines["USE_LIGHTING"] = "";
+  std::string source;
+  ASSERT_TRUE(preprocessor.Preprocess("/* License.\n"
+                                      "   #version 100 is not it. */\n"
+                                      "/* One line. */ // Comment.\n"
+                                      "#version 330 core\n"
+                                      "void main() {}\n",
+                                      defines, &source, nullptr));
+  EXPECT_EQ(source,
+            "/* License.\n"
+            "   #version 100 is not it. */\n"
+            "/* One line. */ // Comment.\n"
+            "#version 330 core\n"
+            "#define USE_LIGHTING\n"
+            "#line 5 0\n"
+            "void main() {}\n");
+
+  // Without #version the definitions go first, even when the code starts on
+  // the line that closes a comment.
+  ASSERT_TRUE(preprocessor.Preprocess("/* License.\n"
+                                      "*/ void main() {}\n",
+                                      defines, &source, nullptr));
+  EXPECT_EQ(source,
+            "#define USE_LIGHTING\n"
+            "#line 1 0\n"
+            "/* License.\n"
+            "*/ void main() {}\n");
+}
+
+TEST(ShaderPreprocessor, ResolvesNestedIncludesOnce) {
+  ShaderPreprocessor preprocessor;
+  preprocessor.AddIncludeSource("lighting.glsl", lighting_src);
+  preprocessor.AddIncludeSource("common.glsl", common_src);
+  std::string source;
+  ASSERT_TRUE(preprocessor.Preprocess(
+      "#version 330 core\n"
+      "#include \"lighting.glsl\"\n"
+      "# include <common.glsl>\n"
+      "void main() {}\n",
+      ShaderDefines(), &source, nullptr));
+  EXPECT_EQ(source,
+            "#version 330 core\n"
+            "#line 2 0\n"
+            "#line 1 1\n"
+            "#line 1 2\n"
+            "const float kAmbient = 0.2f;\n"
+            "#line 2 1\n"
+            "vec4 Shade(vec4 color) { return kAmbient * color; }\n"
+            "#line 3 0\n"
+            "\n"
+            "void main() {}\n");
+}
+
+TEST(ShaderPreprocessor, IgnoresRecursiveIncludes) {
+  ShaderPreprocessor preprocessor;
+  preprocessor.AddIncludeSource("a.glsl", "#include \"b.glsl\"\nint a;\n");
+  preprocessor.AddIncludeSource("b.glsl", "#include \"a.glsl\"\nint b;\n");
+  std::string source;
+  ASSERT_TRUE(preprocessor.Preprocess("#include \"a.glsl\"\n", ShaderDefines(),
+                                      &source, nullptr));
+  EXPECT_NE(source.find("int a;"), std::string::npos);
+  EXPECT_NE(source.find("int b;"), std::string::npos);
+}
+
+TEST(ShaderPreprocessor, FindsIncludesInDirectories) {
+  char include_directory[] = "/tmp/shader_include_XXXXXX";
+  ASSERT_NE(mkdtemp(include_directory), nullptr);
+  const std::string include_path =
+      std::string(include_directory) + "/lighting.glsl";
+  {
+    std::ofstream include_file(include_path);
+    include_file << lighting_src;
+  }
+  ShaderPreprocessor preprocessor;
+  preprocessor.AddIncludeDirectory("/nonexistent");
+  preprocessor.AddIncludeDirectory(include_directory);
+  preprocessor.AddIncludeSource("common.glsl", common_src);
+  std::string source;
+  EXPECT_TRUE(preprocessor.Preprocess(fragment_shader_src, ShaderDefines(),
+                                      &source, nullptr));
+  EXPECT_NE(source.find("vec4 Shade(vec4 color)"), std::string::npos);
+  unlink(include_path.c_str());
+  rmdir(include_directory);
+}
+
+TEST(ShaderPreprocessor, ReportsErrors) {
+  ShaderPreprocessor preprocessor;
+  std::string source = "unchanged";
+  std::string error_info_log;
+  EXPECT_FALSE(preprocessor.Preprocess(fragment_shader_src, ShaderDefines(),
+                                       &source, &error_info_log));
+  EXPECT_NE(error_info_log.find("lighting.glsl"), std::string::npos);
+  EXPECT_NE(error_info_log.find("source:2"), std::string::npos);
+  EXPECT_EQ(source, "unchanged");
+
+  EXPECT_FALSE(preprocessor.Preprocess("#include lighting.glsl\n",
+                                       ShaderDefines(), &source,
+                                       &error_info_log));
+  ShaderDefines defines;
+  defines["NOT AN IDENTIFIER"] = "";
+  EXPECT_FALSE(preprocessor.Preprocess("void main() {}\n", defines, &source,
+                                       &error_info_log));
+}
+
+TEST(ShaderPreprocessor, MakesKeysOfDefines) {
+  ShaderDefines defines;
+  EXPECT_EQ(MakeShaderDefinesKey(defines), "");
+  defines["B"] = "1";
+  defines["A"] = "";
+  ShaderDefines same_defines;
+  same_defines["A"] = "";
+  same_defines["B"] = "1";
+  EXPECT_EQ(MakeShaderDefinesKey(defines), MakeShaderDefinesKey(same_defines));
+  same_defines["B"] = "2";
+  EXPECT_NE(MakeShaderDefinesKey(defines), MakeShaderDefinesKey(same_defines));
+}
+
+TEST(ShaderPreprocessor, BakesUniformsAsConstants) {
+  const std::string source =
+      "#version 330 core\n"
+      "uniform int num_lights;\n"
+      "  uniform bool use_fog;  \n"
+      "uniform float fog_density;\n"
+      "uniform vec4 tints[4];\n"
+      "// uniform int commented;\n"
+      "void main() {}";
+  ShaderConstants constants;
+  constants["num_lights"] = "4";
+  constants["use_fog"] = "false";
+  constants["tints"] = "vec4(1.0f)";
+  constants["commented"] = "1";
+  std::set<std::string> baked_names;
+  EXPECT_EQ(BakeShaderConstants(source, constants, &baked_names),
+            "#version 330 core\n"
+            "const int num_lights = 4;\n"
+            "const bool use_fog = false;\n"
+            "uniform float fog_density;\n"
+            "uniform vec4 tints[4];\n"
+            "// uniform int commented;\n"
+            "void main() {}");
+  EXPECT_EQ(baked_names, std::set<std::string>({"num_lights", "use_fog"}));
+  EXPECT_EQ(BakeShaderConstants(source, ShaderConstants(), nullptr), source);
+}
+
+TEST(ShaderPreprocessor, ReadsShaderFiles) {
+  char filepath[] = "/tmp/shader_file_XXXXXX";
+  const int fd = mkstemp(filepath);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  std::string contents;
+  // An empty file is valid.
+  EXPECT_TRUE(ReadShaderFile(filepath, &contents));
+  EXPECT_TRUE(contents.empty());
+  {
+    std::ofstream file(filepath);
+    file << fragment_shader_src;
+  }
+  EXPECT_TRUE(ReadShaderFile(filepath, &contents));
+  EXPECT_EQ(contents, fragment_shader_src);
+  unlink(filepath);
+  EXPECT_FALSE(ReadShaderFile(filepath, &contents));
+  EXPECT_FALSE(ReadShaderFile("/tmp", &contents));
+}
+
+}  // namespace wvu
@@ -34,10 +34,24 @@
 
 #include "shader_program.h"
 
+#include <stdint.h>
+#include <stdio.h>  // For rename.
+#include <stdlib.h>  // For mkstemp.
+#include <string.h>  // For memcmp and memcpy.
+#include <sys/stat.h>  // For mkdir.
+#include <unistd.h>  // For close.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <mutex>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 #include <GL/glew.h>
 
 namespace wvu {
@@ -45,37 +59,75 @@ namespace {
 // Buffer size for the error log info.
 constexpr int kNumCharsInfoLog = 512;
 
+// Identifies the files of the program binary cache.
+constexpr char kBinaryCacheMagic[] = "WVUPROGRAMBINARY1";
+
+// Counter of the programs linked from sources.
+std::atomic<uint64_t> num_linked_programs(0);
+
+// The first word of every SPIR-V module.
+constexpr uint32_t kSpirvMagicNumber = 0x07230203;
+
+// Timings of the last completed program creations, see GetCreationTimings(),
+// and how many of them are kept.
+std::mutex creation_timings_mutex;
+std::deque<ShaderProgram::CreationTiming>* MutableCreationTimings() {
+  static std::deque<ShaderProgram::CreationTiming> creation_timings;
+  return &creation_timings;
+}
+size_t max_num_creation_timings = 1024;
+
+// Returns the seconds elapsed since start.
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
 // Enumeration to select the shader types.
 enum ShaderType {
   VERTEX = 0,
-  FRAGMENT = 1
+  FRAGMENT = 1,
+  COMPUTE = 2
 };
 
-// Compiles a shader that is contained in shader_src C++ string. The shader type
-// determines what shader we should compile. This function retrieves the errors
-// in case of compilation errors and stores it into info_log. This function
-// returns the shader id if successful, otherwise it returns zero.
-GLuint CompileShader(const std::string& shader_src,
-                     const ShaderType shader_type,
-                     std::string* info_log) {
-  // Create an id for shader using OpenGL glCreateShader().
-  GLuint shader_id = 0;
+// Creates an id for a shader of the given type using OpenGL glCreateShader().
+GLuint CreateShader(const ShaderType shader_type) {
   switch (shader_type) {
     case VERTEX:
-      shader_id = glCreateShader(GL_VERTEX_SHADER);
-      break;
+      return glCreateShader(GL_VERTEX_SHADER);
     case FRAGMENT:
-      shader_id = glCreateShader(GL_FRAGMENT_SHADER);
-      break;
+      return glCreateShader(GL_FRAGMENT_SHADER);
+    case COMPUTE:
+      return glCreateShader(GL_COMPUTE_SHADER);
   }
+  return 0;
+}
+
+// Creates a shader and submits the compilation of the source contained in the
+// shader_src C++ string. The shader type determines what shader we should
+// compile. The function does not wait for the compilation to finish; see
+// CheckCompileStatus(). Returns the id of the shader.
+GLuint SubmitShaderCompilation(const std::string& shader_src,
+                               const ShaderType shader_type) {
+  const GLuint shader_id = CreateShader(shader_type);
   // Retrieving the pointer to the C string wrapped by shader_src.
   // This is to comply with the signature of glShaderSource() function.
-  const char* shader_src_ptr = shader_src.c_str();
+  const char* shader_src_ptr = shader_src.data();
+  // Passing the length spares the driver a scan for the null terminator.
+  const GLint shader_src_length = static_cast<GLint>(shader_src.size());
   // Associates the vertex shader id with the vertex shader source pointed
   // by vertex_shader_src_ptr.
-  glShaderSource(shader_id, 1, &shader_src_ptr, nullptr);
+  glShaderSource(shader_id, 1, &shader_src_ptr, &shader_src_length);
   // Compile the shader.
   glCompileShader(shader_id);
+  return shader_id;
+}
+
+// Verifies if the compilation of a shader was successful. The call blocks until
+// the driver finishes compiling the shader. This function retrieves the errors
+// in case of compilation errors and stores it into info_log.
+bool CheckCompileStatus(const GLuint shader_id, std::string* info_log) {
   // Verify if the compilation was successful.
   GLint success = 0;
   // Retrieve if the compilation was successful. The function returns a non-zero
@@ -92,26 +144,80 @@ GLuint CompileShader(const std::string& shader_src,
       glGetShaderInfoLog(shader_id, kNumCharsInfoLog, nullptr,
                          &info_log->front());
     }
+    return false;
+  }
+  return true;
+}
+
+// Creates a shader from a SPIR-V module and specializes its "main" entry point.
+// This replaces the compilation of GLSL: the driver skips parsing, and the
+// result is checked with CheckCompileStatus() as well. Returns the id of the
+// shader.
+GLuint SubmitShaderSpecialization(const std::string& spirv_module,
+                                  const ShaderType shader_type) {
+  const GLuint shader_id = CreateShader(shader_type);
+  glShaderBinary(1, &shader_id, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB,
+                 spirv_module.data(),
+                 static_cast<GLsizei>(spirv_module.size()));
+  glSpecializeShaderARB(shader_id, "main", 0, nullptr, nullptr);
+  return shader_id;
+}
+
+// Submits either the compilation of the GLSL source or the specialization of
+// the SPIR-V module of a shader.
+GLuint SubmitShader(const std::string& shader_src,
+                    const std::string& spirv_module,
+                    const bool use_spirv,
+                    const ShaderType shader_type) {
+  return use_spirv ? SubmitShaderSpecialization(spirv_module, shader_type) :
+      SubmitShaderCompilation(shader_src, shader_type);
+}
+
+// Compiles a shader that is contained in shader_src C++ string, or specializes
+// its SPIR-V module if use_spirv is true. The shader type determines what
+// shader we should compile. This function retrieves the errors
+// in case of compilation errors and stores it into info_log. This function
+// returns the shader id if successful, otherwise it returns zero.
+GLuint CompileShader(const std::string& shader_src,
+                     const std::string& spirv_module,
+                     const bool use_spirv,
+                     const ShaderType shader_type,
+                     std::string* info_log) {
+  const GLuint shader_id =
+      SubmitShader(shader_src, spirv_module, use_spirv, shader_type);
+  if (!CheckCompileStatus(shader_id, info_log)) {
     return 0;
   }
   return shader_id;
 }
 
-// Creates a shader program. This function requires the ids of the vertex and
-// fragment shaders which were successfully compiled. The function can return
-// the error info log string in case of a failure. The function returns the
-// shader program id if successfull, and returns zero otherwise.
-GLuint CreateShaderProgram(const GLuint vertex_shader,
-                           const GLuint fragment_shader,
-                           std::string* info_log) {
+// Creates a shader program and submits the linkage of the shaders, i.e., the
+// vertex and fragment shaders or a compute shader. The function does not wait
+// for the linkage to finish; see CheckLinkStatus(). Returns the shader program
+// id.
+GLuint SubmitShaderProgramLinkage(const std::vector<GLuint>& shaders) {
   // Create a program id.
   const GLuint shader_program = glCreateProgram();
-  // Attach to the program the vertex shader.
-  glAttachShader(shader_program, vertex_shader);
-  // Attach to the program the fragment shader.
-  glAttachShader(shader_program, fragment_shader);
-  // Link the both shaders to get a shader program.
+  // Let the driver know that we may retrieve the binary of the program.
+  if (!ShaderProgram::binary_cache_directory().empty() &&
+      GLEW_ARB_get_program_binary) {
+    glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                        GL_TRUE);
+  }
+  // Attach to the program every shader.
+  for (const GLuint shader : shaders) {
+    glAttachShader(shader_program, shader);
+  }
+  // Link the shaders to get a shader program.
   glLinkProgram(shader_program);
+  ++num_linked_programs;
+  return shader_program;
+}
+
+// Verifies if the linkage of a shader program was successful. The call blocks
+// until the driver finishes linking. The function can return the error info log
+// string in case of a failure.
+bool CheckLinkStatus(const GLuint shader_program, std::string* info_log) {
   // Check if the operation was successful.
   GLint success = 0;
   // Get the status of the linkage procedure. The function returns a non-zero
@@ -125,6 +231,19 @@ GLuint CreateShaderProgram(const GLuint vertex_shader,
       glGetProgramInfoLog(shader_program, kNumCharsInfoLog, nullptr,
                           &info_log->front());
     }
+    return false;
+  }
+  return true;
+}
+
+// Creates a shader program. This function requires the ids of the shaders
+// which were successfully compiled. The function can return the error info log
+// string in case of a failure. The function returns the shader program id if
+// successfull, and returns zero otherwise.
+GLuint CreateShaderProgram(const std::vector<GLuint>& shaders,
+                           std::string* info_log) {
+  const GLuint shader_program = SubmitShaderProgramLinkage(shaders);
+  if (!CheckLinkStatus(shader_program, info_log)) {
     return 0;
   }
   return shader_program;
@@ -132,37 +251,456 @@ GLuint CreateShaderProgram(const GLuint vertex_shader,
 
 // Releases the resources allocated for compilation of shaders.
 // Clear the shader sources strings.
-void ReleaseShaderResources(const GLuint vertex_shader,
-                            const GLuint fragment_shader) {
-  // Delete shaders and set them to 0.
-  glDeleteShader(vertex_shader);
-  glDeleteShader(fragment_shader);
+void ReleaseShaderResources(const std::vector<GLuint>& shaders) {
+  // Delete shaders.
+  for (const GLuint shader : shaders) {
+    glDeleteShader(shader);
+  }
+}
+
+// Removes the "[0]" suffix that OpenGL appends to the names of arrays.
+std::string StripArraySuffix(const std::string& name) {
+  const std::string kArraySuffix = "[0]";
+  if (name.size() > kArraySuffix.size() &&
+      name.compare(name.size() - kArraySuffix.size(), kArraySuffix.size(),
+                   kArraySuffix) == 0) {
+    return name.substr(0, name.size() - kArraySuffix.size());
+  }
+  return name;
+}
+
+// Returns the active uniforms or attributes of a linked program. The
+// variable_type is either GL_ACTIVE_UNIFORMS or GL_ACTIVE_ATTRIBUTES.
+std::vector<ShaderProgram::ShaderVariable> GetActiveVariables(
+    const GLuint shader_program, const GLenum variable_type) {
+  const bool uniforms = variable_type == GL_ACTIVE_UNIFORMS;
+  GLint num_variables = 0;
+  glGetProgramiv(shader_program, variable_type, &num_variables);
+  GLint max_name_length = 0;
+  glGetProgramiv(shader_program,
+                 uniforms ? GL_ACTIVE_UNIFORM_MAX_LENGTH :
+                 GL_ACTIVE_ATTRIBUTE_MAX_LENGTH,
+                 &max_name_length);
+  std::vector<GLchar> name(std::max(max_name_length, 1));
+  std::vector<ShaderProgram::ShaderVariable> variables;
+  variables.reserve(num_variables);
+  for (GLint i = 0; i < num_variables; ++i) {
+    ShaderProgram::ShaderVariable variable;
+    GLsizei name_length = 0;
+    if (uniforms) {
+      glGetActiveUniform(shader_program, i, name.size(), &name_length,
+                         &variable.size, &variable.type, name.data());
+    } else {
+      glGetActiveAttrib(shader_program, i, name.size(), &name_length,
+                        &variable.size, &variable.type, name.data());
+    }
+    const std::string full_name(name.data(), name_length);
+    variable.location = uniforms ?
+        glGetUniformLocation(shader_program, full_name.c_str()) :
+        glGetAttribLocation(shader_program, full_name.c_str());
+    // Uniforms in uniform blocks and built-in attributes have no location.
+    if (variable.location < 0) {
+      continue;
+    }
+    variable.name = StripArraySuffix(full_name);
+    variables.push_back(variable);
+  }
+  return variables;
+}
+
+// The program in use in the calling thread as set by ShaderProgram::Use(), or
+// zero when unknown or when no program is in use.
+thread_local GLuint thread_current_program_id = 0;
+// True when ShaderProgram::UseNoProgram() unbound the programs of the calling
+// thread, i.e., program zero is known to be in use.
+thread_local bool thread_no_program_in_use = false;
+// GL_MAX_COMPUTE_WORK_GROUP_COUNT of the context of the calling thread, queried
+// on the first use. All zeros until then.
+thread_local GLuint thread_max_compute_work_group_count[3] = { 0, 0, 0 };
+
+// Counters of the glUseProgram() calls issued and skipped by Use().
+std::atomic<uint64_t> num_issued_program_binds(0);
+std::atomic<uint64_t> num_skipped_program_binds(0);
+
+// Returns the directory of the binary cache. The function-local static avoids
+// depending on the initialization order of globals. The mutex guards it since
+// programs are also created by other threads, e.g., the hot reloader.
+std::mutex binary_cache_directory_mutex;
+std::string* MutableBinaryCacheDirectory() {
+  static std::string* binary_cache_directory = new std::string;
+  return binary_cache_directory;
+}
+
+// Updates a 64-bit FNV-1a hash with the given bytes.
+uint64_t HashBytes(const char* bytes, const size_t num_bytes, uint64_t hash) {
+  constexpr uint64_t kFnvPrime = 1099511628211ull;
+  for (size_t i = 0; i < num_bytes; ++i) {
+    hash ^= static_cast<unsigned char>(bytes[i]);
+    hash *= kFnvPrime;
+  }
+  return hash;
 }
 
-// Loads a shader source from a file. The function receives the filepath
-// reads it, and returns the content of the file in loaded_file. Returns
-// true if successful, otherwise false.
-bool LoadShaderFromFile(const std::string& filepath,
-                        std::string* loaded_file) {
-  // Create an input file stream.
-  std::ifstream in(filepath);
-  // Verify if it is open and that we have a valid sink C++ string.
-  if (!in.is_open() || !loaded_file) {
+// Updates the hash with a string and its length, so that consecutive strings
+// cannot be confused with each other.
+uint64_t HashString(const std::string& value, uint64_t hash) {
+  const uint64_t size = value.size();
+  hash = HashBytes(reinterpret_cast<const char*>(&size), sizeof(size), hash);
+  return HashBytes(value.data(), value.size(), hash);
+}
+
+// Returns the GL string as a C++ string, or an empty string if it is null.
+std::string GetGLString(const GLenum name) {
+  const GLubyte* value = glGetString(name);
+  return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+// Returns the path of the cache file for the given sources. The key covers the
+// sources as well as the vendor, renderer and version of the driver since
+// program binaries are only valid for the driver that produced them.
+std::string GetBinaryCacheFilepath(const std::string& vertex_shader_src,
+                                   const std::string& fragment_shader_src,
+                                   const std::string& compute_shader_src) {
+  constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+  uint64_t hash = kFnvOffsetBasis;
+  hash = HashString(vertex_shader_src, hash);
+  hash = HashString(fragment_shader_src, hash);
+  // Only compute programs hash their source, so the keys of the other programs
+  // stay the same.
+  if (!compute_shader_src.empty()) {
+    hash = HashString(compute_shader_src, hash);
+  }
+  hash = HashString(GetGLString(GL_VENDOR), hash);
+  hash = HashString(GetGLString(GL_RENDERER), hash);
+  hash = HashString(GetGLString(GL_VERSION), hash);
+  char filename[32];
+  snprintf(filename, sizeof(filename), "%016llx.bin",
+           static_cast<unsigned long long>(hash));
+  return ShaderProgram::binary_cache_directory() + "/" + filename;
+}
+
+// Returns true if the binary cache can be used with the current context.
+bool IsBinaryCacheAvailable() {
+  if (ShaderProgram::binary_cache_directory().empty() ||
+      !GLEW_ARB_get_program_binary) {
     return false;
   }
-  // Create a string buffer to load the entire file in a single call.
-  std::stringstream string_buffer;
-  // Load the file in a single read.
-  string_buffer << in.rdbuf();
-  // Close the file.
-  in.close();
-  // Extract the string from the string buffer.
-  *loaded_file = string_buffer.str();
-  return true;
+  GLint num_binary_formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_binary_formats);
+  return num_binary_formats > 0;
 }
 
 }  // namespace
 
+void ShaderProgram::SetBinaryCacheDirectory(const std::string& directory) {
+  if (!directory.empty()) {
+    // Failures, e.g., because the directory exists, are ignored. A directory
+    // that cannot be written simply disables storing binaries.
+    mkdir(directory.c_str(), 0755);
+  }
+  std::lock_guard<std::mutex> lock(binary_cache_directory_mutex);
+  *MutableBinaryCacheDirectory() = directory;
+}
+
+std::string ShaderProgram::binary_cache_directory() {
+  std::lock_guard<std::mutex> lock(binary_cache_directory_mutex);
+  return *MutableBinaryCacheDirectory();
+}
+
+constexpr ShaderProgram::UniformHandle ShaderProgram::kInvalidUniformHandle;
+
+bool ShaderProgram::Use() const {
+  if (!created_) {
+    return false;
+  }
+  if (thread_current_program_id == shader_program_id_) {
+    ++num_skipped_program_binds;
+    return true;
+  }
+  // We set the shader program as active.
+  glUseProgram(shader_program_id_);
+  thread_current_program_id = shader_program_id_;
+  thread_no_program_in_use = false;
+  ++num_issued_program_binds;
+  return true;
+}
+
+void ShaderProgram::UseNoProgram() {
+  if (thread_no_program_in_use) {
+    ++num_skipped_program_binds;
+    return;
+  }
+  glUseProgram(0);
+  thread_current_program_id = 0;
+  thread_no_program_in_use = true;
+  ++num_issued_program_binds;
+}
+
+void ShaderProgram::InvalidateCurrentProgram() {
+  thread_current_program_id = 0;
+  thread_no_program_in_use = false;
+}
+
+GLuint ShaderProgram::current_program_id() {
+  return thread_current_program_id;
+}
+
+uint64_t ShaderProgram::num_program_binds_issued() {
+  return num_issued_program_binds;
+}
+
+uint64_t ShaderProgram::num_program_binds_skipped() {
+  return num_skipped_program_binds;
+}
+
+void ShaderProgram::ResetProgramBindCounters() {
+  num_issued_program_binds = 0;
+  num_skipped_program_binds = 0;
+}
+
+uint64_t ShaderProgram::num_program_links() {
+  return num_linked_programs;
+}
+
+void ShaderProgram::OnProgramDeleted() const {
+  // A new program could get the same id once OpenGL releases this one.
+  if (thread_current_program_id == shader_program_id_) {
+    thread_current_program_id = 0;
+  }
+}
+
+ShaderProgram::UniformHandle ShaderProgram::GetUniformHandle(
+    const std::string& name) const {
+  for (int i = 0; i < static_cast<int>(uniforms_.size()); ++i) {
+    if (uniforms_[i].name == name) {
+      return i;
+    }
+  }
+  return kInvalidUniformHandle;
+}
+
+GLint ShaderProgram::GetAttributeLocation(const std::string& name) const {
+  for (const ShaderVariable& attribute : attributes_) {
+    if (attribute.name == name) {
+      return attribute.location;
+    }
+  }
+  return -1;
+}
+
+void ShaderProgram::SetUniform(const UniformHandle handle,
+                               const GLfloat value) {
+  SetUniformValue(handle, UNIFORM_1F, &value, 1);
+}
+
+void ShaderProgram::SetUniform(const UniformHandle handle,
+                               const GLint value) {
+  SetUniformValue(handle, UNIFORM_1I, &value, 1);
+}
+
+void ShaderProgram::SetUniform(const UniformHandle handle,
+                               const GLuint value) {
+  SetUniformValue(handle, UNIFORM_1UI, &value, 1);
+}
+
+void ShaderProgram::SetUniformVector2(const UniformHandle handle,
+                                      const GLfloat* values) {
+  SetUniformValue(handle, UNIFORM_2FV, values, 2);
+}
+
+void ShaderProgram::SetUniformVector3(const UniformHandle handle,
+                                      const GLfloat* values) {
+  SetUniformValue(handle, UNIFORM_3FV, values, 3);
+}
+
+void ShaderProgram::SetUniformVector4(const UniformHandle handle,
+                                      const GLfloat* values) {
+  SetUniformValue(handle, UNIFORM_4FV, values, 4);
+}
+
+void ShaderProgram::SetUniformMatrix3(const UniformHandle handle,
+                                      const GLfloat* values) {
+  SetUniformValue(handle, UNIFORM_MATRIX_3FV, values, 9);
+}
+
+void ShaderProgram::SetUniformMatrix4(const UniformHandle handle,
+                                      const GLfloat* values) {
+  SetUniformValue(handle, UNIFORM_MATRIX_4FV, values, 16);
+}
+
+void ShaderProgram::SetUniformValue(const UniformHandle handle,
+                                    const UniformUpload upload,
+                                    const void* values,
+                                    const int num_values) {
+  // Also covers handles of other programs and handles kept after Release() or
+  // a move.
+  if (handle < 0 || handle >= static_cast<int>(uniform_states_.size())) {
+    return;
+  }
+  UniformState& state = uniform_states_[handle];
+  const size_t num_bytes = num_values * sizeof(uint32_t);
+  if (state.known && state.upload == upload &&
+      memcmp(state.values, values, num_bytes) == 0) {
+    ++num_skipped_uniform_uploads_;
+    return;
+  }
+  memcpy(state.values, values, num_bytes);
+  state.upload = upload;
+  state.known = true;
+  if (!state.dirty) {
+    state.dirty = true;
+    dirty_uniforms_.push_back(handle);
+  }
+}
+
+int ShaderProgram::FlushUniforms() {
+  for (const UniformHandle handle : dirty_uniforms_) {
+    UniformState& state = uniform_states_[handle];
+    UploadUniform(uniforms_[handle].location, state.upload, state.values);
+    state.dirty = false;
+  }
+  const int num_uploads = static_cast<int>(dirty_uniforms_.size());
+  num_uniform_uploads_ += num_uploads;
+  dirty_uniforms_.clear();
+  return num_uploads;
+}
+
+bool ShaderProgram::GetUniformValue(const UniformHandle handle,
+                                    UniformUpload* upload,
+                                    const uint32_t** values) const {
+  if (handle < 0 || handle >= static_cast<int>(uniform_states_.size()) ||
+      !uniform_states_[handle].known) {
+    return false;
+  }
+  *upload = uniform_states_[handle].upload;
+  *values = uniform_states_[handle].values;
+  return true;
+}
+
+void ShaderProgram::UploadUniform(const GLint location,
+                                  const UniformUpload upload,
+                                  const uint32_t* values) {
+  const GLfloat* float_values = reinterpret_cast<const GLfloat*>(values);
+  switch (upload) {
+    case UNIFORM_1F:
+      glUniform1f(location, float_values[0]);
+      break;
+    case UNIFORM_1I:
+      glUniform1i(location, static_cast<GLint>(values[0]));
+      break;
+    case UNIFORM_1UI:
+      glUniform1ui(location, values[0]);
+      break;
+    case UNIFORM_2FV:
+      glUniform2fv(location, 1, float_values);
+      break;
+    case UNIFORM_3FV:
+      glUniform3fv(location, 1, float_values);
+      break;
+    case UNIFORM_4FV:
+      glUniform4fv(location, 1, float_values);
+      break;
+    case UNIFORM_MATRIX_3FV:
+      glUniformMatrix3fv(location, 1, GL_FALSE, float_values);
+      break;
+    case UNIFORM_MATRIX_4FV:
+      glUniformMatrix4fv(location, 1, GL_FALSE, float_values);
+      break;
+  }
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
+    : vertex_shader_src_(std::move(other.vertex_shader_src_)),
+      fragment_shader_src_(std::move(other.fragment_shader_src_)),
+      compute_shader_src_(std::move(other.compute_shader_src_)),
+      vertex_shader_spirv_(std::move(other.vertex_shader_spirv_)),
+      fragment_shader_spirv_(std::move(other.fragment_shader_spirv_)),
+      compute_shader_spirv_(std::move(other.compute_shader_spirv_)),
+      vertex_shader_(other.vertex_shader_),
+      fragment_shader_(other.fragment_shader_),
+      compute_shader_(other.compute_shader_),
+      shader_program_id_(other.shader_program_id_),
+      created_(other.created_),
+      creation_pending_(other.creation_pending_),
+      loaded_from_binary_cache_(other.loaded_from_binary_cache_),
+      label_(std::move(other.label_)),
+      creation_timing_(std::move(other.creation_timing_)),
+      uniforms_(std::move(other.uniforms_)),
+      attributes_(std::move(other.attributes_)),
+      uniform_states_(std::move(other.uniform_states_)),
+      dirty_uniforms_(std::move(other.dirty_uniforms_)),
+      num_uniform_uploads_(other.num_uniform_uploads_),
+      num_skipped_uniform_uploads_(other.num_skipped_uniform_uploads_) {
+  // The other instance no longer owns the program.
+  other.created_ = false;
+  other.creation_pending_ = false;
+  other.Release();
+}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept {
+  if (this != &other) {
+    Release();
+    vertex_shader_src_ = std::move(other.vertex_shader_src_);
+    fragment_shader_src_ = std::move(other.fragment_shader_src_);
+    compute_shader_src_ = std::move(other.compute_shader_src_);
+    vertex_shader_spirv_ = std::move(other.vertex_shader_spirv_);
+    fragment_shader_spirv_ = std::move(other.fragment_shader_spirv_);
+    compute_shader_spirv_ = std::move(other.compute_shader_spirv_);
+    vertex_shader_ = other.vertex_shader_;
+    fragment_shader_ = other.fragment_shader_;
+    compute_shader_ = other.compute_shader_;
+    shader_program_id_ = other.shader_program_id_;
+    created_ = other.created_;
+    creation_pending_ = other.creation_pending_;
+    loaded_from_binary_cache_ = other.loaded_from_binary_cache_;
+    label_ = std::move(other.label_);
+    creation_timing_ = std::move(other.creation_timing_);
+    uniforms_ = std::move(other.uniforms_);
+    attributes_ = std::move(other.attributes_);
+    uniform_states_ = std::move(other.uniform_states_);
+    dirty_uniforms_ = std::move(other.dirty_uniforms_);
+    num_uniform_uploads_ = other.num_uniform_uploads_;
+    num_skipped_uniform_uploads_ = other.num_skipped_uniform_uploads_;
+    other.created_ = false;
+    other.creation_pending_ = false;
+    other.Release();
+  }
+  return *this;
+}
+
+void ShaderProgram::Release() {
+  if (creation_pending_) {
+    // The asynchronous creation never finished. Release what was submitted.
+    ReleaseShaderResources(shaders());
+  }
+  if (created_ || creation_pending_) {
+    // Once the shader program is not needed, we tell OpenGL to delete it.
+    glDeleteProgram(shader_program_id_);
+    OnProgramDeleted();
+  }
+  vertex_shader_src_.clear();
+  fragment_shader_src_.clear();
+  compute_shader_src_.clear();
+  vertex_shader_spirv_.clear();
+  fragment_shader_spirv_.clear();
+  compute_shader_spirv_.clear();
+  vertex_shader_ = 0;
+  fragment_shader_ = 0;
+  compute_shader_ = 0;
+  shader_program_id_ = 0;
+  created_ = false;
+  creation_pending_ = false;
+  loaded_from_binary_cache_ = false;
+  label_.clear();
+  creation_timing_ = CreationTiming();
+  uniforms_.clear();
+  attributes_.clear();
+  uniform_states_.clear();
+  dirty_uniforms_.clear();
+  num_uniform_uploads_ = 0;
+  num_skipped_uniform_uploads_ = 0;
+}
+
 bool ShaderProgram::LoadVertexShaderFromString(
     const std::string& vertex_shader_source) {
   vertex_shader_src_ = vertex_shader_source;
@@ -175,14 +713,139 @@ bool ShaderProgram::LoadFragmentShaderFromString(
   return true;
 }
 
+bool ShaderProgram::LoadComputeShaderFromString(
+    const std::string& compute_shader_source) {
+  compute_shader_src_ = compute_shader_source;
+  return true;
+}
+
 bool ShaderProgram::LoadVertexShaderFromFile(
     const std::string& vertex_shader_path) {
-  return LoadShaderFromFile(vertex_shader_path, &vertex_shader_src_);
+  return ReadShaderFile(vertex_shader_path, &vertex_shader_src_);
 }
 
 bool ShaderProgram::LoadFragmentShaderFromFile(
     const std::string& fragment_shader_path) {
-  return LoadShaderFromFile(fragment_shader_path, &fragment_shader_src_);
+  return ReadShaderFile(fragment_shader_path, &fragment_shader_src_);
+}
+
+bool ShaderProgram::LoadComputeShaderFromFile(
+    const std::string& compute_shader_path) {
+  return ReadShaderFile(compute_shader_path, &compute_shader_src_);
+}
+
+bool ShaderProgram::LoadSpirvShader(const GLenum shader_type,
+                                    const std::string& spirv_module) {
+  // A module is a sequence of 32-bit words starting with the magic number.
+  uint32_t magic_number = 0;
+  if (spirv_module.size() < sizeof(magic_number) ||
+      spirv_module.size() % sizeof(magic_number) != 0) {
+    return false;
+  }
+  memcpy(&magic_number, spirv_module.data(), sizeof(magic_number));
+  if (magic_number != kSpirvMagicNumber) {
+    return false;
+  }
+  switch (shader_type) {
+    case GL_VERTEX_SHADER:
+      vertex_shader_spirv_ = spirv_module;
+      return true;
+    case GL_FRAGMENT_SHADER:
+      fragment_shader_spirv_ = spirv_module;
+      return true;
+    case GL_COMPUTE_SHADER:
+      compute_shader_spirv_ = spirv_module;
+      return true;
+  }
+  return false;
+}
+
+bool ShaderProgram::LoadSpirvShaderFromFile(const GLenum shader_type,
+                                            const std::string& spirv_path) {
+  std::string spirv_module;
+  return ReadShaderFile(spirv_path, &spirv_module) &&
+      LoadSpirvShader(shader_type, spirv_module);
+}
+
+bool ShaderProgram::uses_spirv() const {
+  if (!GLEW_ARB_gl_spirv) {
+    return false;
+  }
+  // OpenGL does not link SPIR-V and GLSL shaders together, so every shader
+  // needs a module.
+  if (is_compute()) {
+    return !compute_shader_spirv_.empty();
+  }
+  return !vertex_shader_spirv_.empty() && !fragment_shader_spirv_.empty();
+}
+
+bool ShaderProgram::PreprocessShaders(const ShaderPreprocessor& preprocessor,
+                                      const ShaderDefines& defines,
+                                      std::string* error_info_log) {
+  // Shaders that are not loaded stay empty.
+  std::string* shader_srcs[] = {
+    &vertex_shader_src_, &fragment_shader_src_, &compute_shader_src_
+  };
+  std::string preprocessed_srcs[3];
+  for (int i = 0; i < 3; ++i) {
+    if (!shader_srcs[i]->empty() &&
+        !preprocessor.Preprocess(*shader_srcs[i], defines,
+                                 &preprocessed_srcs[i], error_info_log)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (!shader_srcs[i]->empty()) {
+      *shader_srcs[i] = std::move(preprocessed_srcs[i]);
+    }
+  }
+  return true;
+}
+
+bool ShaderProgram::BakeConstants(const ShaderConstants& constants,
+                                  std::string* error_info_log) {
+  std::string info_log;
+  if (!vertex_shader_spirv_.empty() || !fragment_shader_spirv_.empty() ||
+      !compute_shader_spirv_.empty()) {
+    info_log = "Constants cannot be baked into SPIR-V modules.";
+  }
+  for (const auto& constant : constants) {
+    if (constant.second.empty() ||
+        constant.second.find('\n') != std::string::npos) {
+      info_log += "Invalid value of the constant " + constant.first + ".\n";
+    }
+  }
+  if (!info_log.empty()) {
+    if (error_info_log) {
+      *error_info_log = info_log;
+    }
+    return false;
+  }
+  std::set<std::string> baked_names;
+  std::string baked_srcs[3];
+  std::string* shader_srcs[] = {
+    &vertex_shader_src_, &fragment_shader_src_, &compute_shader_src_
+  };
+  for (int i = 0; i < 3; ++i) {
+    baked_srcs[i] = BakeShaderConstants(*shader_srcs[i], constants,
+                                        &baked_names);
+  }
+  for (const auto& constant : constants) {
+    if (baked_names.count(constant.first) == 0) {
+      info_log += "No uniform declaration of the constant " + constant.first +
+          ".\n";
+    }
+  }
+  if (!info_log.empty()) {
+    if (error_info_log) {
+      *error_info_log = info_log;
+    }
+    return false;
+  }
+  for (int i = 0; i < 3; ++i) {
+    *shader_srcs[i] = std::move(baked_srcs[i]);
+  }
+  return true;
 }
 
 bool ShaderProgram::Create(std::string* error_info_log) {
@@ -190,45 +853,465 @@ bool ShaderProgram::Create(std::string* error_info_log) {
   // method will report true. No need to build again. If different shader
   // sources are used, then a different instance should be called.
   if (created_) return true;
+  StartCreationTiming();
+  if (LoadProgramFromBinaryCache()) {
+    OnProgramCreated();
+    RecordCreationTiming(true);
+    return true;
+  }
   std::string info_log;
-  if (!BuildVertexShader(&info_log)) {
+  bool success = CheckShaderSources(&info_log);
+  if (is_compute()) {
+    success = success && BuildComputeShader(&info_log);
+  } else {
+    success = success && BuildVertexShader(&info_log) &&
+        BuildFragmentShader(&info_log);
+  }
+  success = success && LinkProgram(&info_log);
+  RecordCreationTiming(success);
+  if (!success) {
     if (error_info_log) {
       *error_info_log = info_log;
     }
     return false;
   }
-  if (!BuildFragmentShader(&info_log)) {
+  OnProgramCreated();
+  StoreProgramInBinaryCache();
+  return true;
+}
+
+void ShaderProgram::CreateAsync() {
+  if (created_ || creation_pending_) return;
+  StartCreationTiming();
+  if (LoadProgramFromBinaryCache()) {
+    OnProgramCreated();
+    RecordCreationTiming(true);
+    return;
+  }
+  // Submit everything without querying any status, since a query would wait
+  // for the driver to finish. Invalid sources are reported by Finish().
+  if (!CheckShaderSources(nullptr)) {
+    creation_pending_ = true;
+    return;
+  }
+  const bool use_spirv = uses_spirv();
+  auto start = std::chrono::steady_clock::now();
+  if (is_compute()) {
+    compute_shader_ = SubmitShader(compute_shader_src_, compute_shader_spirv_,
+                                   use_spirv, COMPUTE);
+    creation_timing_.compute_shader_seconds = SecondsSince(start);
+  } else {
+    vertex_shader_ = SubmitShader(vertex_shader_src_, vertex_shader_spirv_,
+                                  use_spirv, VERTEX);
+    creation_timing_.vertex_shader_seconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    fragment_shader_ = SubmitShader(fragment_shader_src_,
+                                    fragment_shader_spirv_, use_spirv,
+                                    FRAGMENT);
+    creation_timing_.fragment_shader_seconds = SecondsSince(start);
+  }
+  shader_program_id_ = SubmitShaderProgramLinkage(shaders());
+  creation_pending_ = true;
+}
+
+bool ShaderProgram::IsReady() const {
+  if (!creation_pending_ || shader_program_id_ == 0) return true;
+  if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile) {
+    GLint completed = GL_FALSE;
+    glGetProgramiv(shader_program_id_, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+  }
+  return true;
+}
+
+bool ShaderProgram::Finish(std::string* error_info_log) {
+  if (created_) return true;
+  if (!creation_pending_) {
     if (error_info_log) {
-      *error_info_log = info_log;
+      *error_info_log = "CreateAsync() was not called.";
     }
     return false;
   }
-  if (!LinkProgram(&info_log)) {
+  creation_pending_ = false;
+  // Check the shaders first to report the same errors as Create().
+  const auto start = std::chrono::steady_clock::now();
+  std::string info_log;
+  bool success = CheckShaderSources(&info_log);
+  for (const GLuint shader : shaders()) {
+    success = success && CheckCompileStatus(shader, &info_log);
+  }
+  success = success && CheckLinkStatus(shader_program_id_, &info_log);
+  ReleaseShaderResources(shaders());
+  creation_timing_.link_seconds = SecondsSince(start);
+  RecordCreationTiming(success);
+  if (!success) {
+    glDeleteProgram(shader_program_id_);
+    shader_program_id_ = 0;
     if (error_info_log) {
       *error_info_log = info_log;
     }
     return false;
   }
-  created_ = true;
+  OnProgramCreated();
+  StoreProgramInBinaryCache();
   return true;
 }
 
+bool ShaderProgram::Dispatch(const GLuint num_groups_x,
+                             const GLuint num_groups_y,
+                             const GLuint num_groups_z) const {
+  if (!is_compute()) {
+    return false;
+  }
+  GLuint max_num_groups[3];
+  GetMaxComputeWorkGroupCount(max_num_groups);
+  if (num_groups_x > max_num_groups[0] || num_groups_y > max_num_groups[1] ||
+      num_groups_z > max_num_groups[2] || !Use()) {
+    return false;
+  }
+  glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+  return true;
+}
+
+void ShaderProgram::GetMaxComputeWorkGroupCount(GLuint max_num_groups[3]) {
+  GLuint* max_count = thread_max_compute_work_group_count;
+  // OpenGL guarantees at least 65535 groups per dimension, so a zero means the
+  // limit was not queried yet, or that the context has no compute shaders.
+  if (max_count[0] == 0) {
+    for (GLuint i = 0; i < 3; ++i) {
+      GLint count = 0;
+      glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, i, &count);
+      max_count[i] = static_cast<GLuint>(count);
+    }
+  }
+  max_num_groups[0] = max_count[0];
+  max_num_groups[1] = max_count[1];
+  max_num_groups[2] = max_count[2];
+}
+
+void ShaderProgram::GetComputeWorkGroupSize(GLint work_group_size[3]) const {
+  work_group_size[0] = work_group_size[1] = work_group_size[2] = 0;
+  if (created_ && is_compute()) {
+    glGetProgramiv(shader_program_id_, GL_COMPUTE_WORK_GROUP_SIZE,
+                   work_group_size);
+  }
+}
+
+GLint ShaderProgram::GetShaderStorageBlockBinding(
+    const std::string& name) const {
+  if (!created_) {
+    return -1;
+  }
+  const GLuint block_index = glGetProgramResourceIndex(
+      shader_program_id_, GL_SHADER_STORAGE_BLOCK, name.c_str());
+  if (block_index == GL_INVALID_INDEX) {
+    return -1;
+  }
+  const GLenum property = GL_BUFFER_BINDING;
+  GLint binding = -1;
+  glGetProgramResourceiv(shader_program_id_, GL_SHADER_STORAGE_BLOCK,
+                         block_index, 1, &property, 1, nullptr, &binding);
+  return binding;
+}
+
+bool ShaderProgram::SetUniformBlockBinding(const std::string& name,
+                                           const GLuint binding) const {
+  if (!created_) {
+    return false;
+  }
+  const GLuint block_index =
+      glGetUniformBlockIndex(shader_program_id_, name.c_str());
+  if (block_index == GL_INVALID_INDEX) {
+    return false;
+  }
+  glUniformBlockBinding(shader_program_id_, block_index, binding);
+  return true;
+}
+
+void ShaderProgram::BindShaderStorageBuffer(const GLuint binding,
+                                            const GLuint buffer) {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
+void ShaderProgram::BindShaderStorageBuffer(const GLuint binding,
+                                            const GLuint buffer,
+                                            const GLintptr offset,
+                                            const GLsizeiptr size) {
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+}
+
+void ShaderProgram::SetMaxShaderCompilerThreads(const GLuint num_threads) {
+  if (GLEW_KHR_parallel_shader_compile) {
+    glMaxShaderCompilerThreadsKHR(num_threads);
+  } else if (GLEW_ARB_parallel_shader_compile) {
+    glMaxShaderCompilerThreadsARB(num_threads);
+  }
+}
+
 bool ShaderProgram::BuildVertexShader(std::string* info_log) {
-  vertex_shader_ = CompileShader(vertex_shader_src_, VERTEX, info_log);
+  const auto start = std::chrono::steady_clock::now();
+  vertex_shader_ = CompileShader(vertex_shader_src_, vertex_shader_spirv_,
+                                 uses_spirv(), VERTEX, info_log);
+  creation_timing_.vertex_shader_seconds = SecondsSince(start);
   return vertex_shader_ != 0;
 }
 
 bool ShaderProgram::BuildFragmentShader(std::string* info_log) {
-  fragment_shader_ = CompileShader(fragment_shader_src_, FRAGMENT, info_log);
+  const auto start = std::chrono::steady_clock::now();
+  fragment_shader_ = CompileShader(fragment_shader_src_, fragment_shader_spirv_,
+                                   uses_spirv(), FRAGMENT, info_log);
+  creation_timing_.fragment_shader_seconds = SecondsSince(start);
   return fragment_shader_ != 0;
 }
 
+bool ShaderProgram::BuildComputeShader(std::string* info_log) {
+  const auto start = std::chrono::steady_clock::now();
+  compute_shader_ = CompileShader(compute_shader_src_, compute_shader_spirv_,
+                                  uses_spirv(), COMPUTE, info_log);
+  creation_timing_.compute_shader_seconds = SecondsSince(start);
+  return compute_shader_ != 0;
+}
+
 bool ShaderProgram::LinkProgram(std::string* info_log) {
-  shader_program_id_ = CreateShaderProgram(vertex_shader_,
-                                           fragment_shader_,
-                                           info_log);
-  ReleaseShaderResources(vertex_shader_, fragment_shader_);
+  const auto start = std::chrono::steady_clock::now();
+  shader_program_id_ = CreateShaderProgram(shaders(), info_log);
+  ReleaseShaderResources(shaders());
+  creation_timing_.link_seconds = SecondsSince(start);
   return shader_program_id_ != 0;
 }
 
+bool ShaderProgram::CheckShaderSources(std::string* info_log) const {
+  // Without ARB_gl_spirv, or with modules for only some of the shaders, the
+  // GLSL sources are compiled instead.
+  const bool has_spirv = !vertex_shader_spirv_.empty() ||
+      !fragment_shader_spirv_.empty() || !compute_shader_spirv_.empty();
+  if (has_spirv && !uses_spirv() &&
+      ((!vertex_shader_spirv_.empty() && vertex_shader_src_.empty()) ||
+       (!fragment_shader_spirv_.empty() && fragment_shader_src_.empty()) ||
+       (!compute_shader_spirv_.empty() && compute_shader_src_.empty()))) {
+    if (info_log) {
+      *info_log = "SPIR-V shaders require ARB_gl_spirv and a module for every "
+          "shader. Load the GLSL sources as a fallback.";
+    }
+    return false;
+  }
+  if (!is_compute()) {
+    return true;
+  }
+  if (!vertex_shader_src_.empty() || !fragment_shader_src_.empty() ||
+      !vertex_shader_spirv_.empty() || !fragment_shader_spirv_.empty()) {
+    if (info_log) {
+      *info_log = "A program has either a compute shader, or vertex and "
+          "fragment shaders.";
+    }
+    return false;
+  }
+  if (!GLEW_VERSION_4_3 && !GLEW_ARB_compute_shader) {
+    if (info_log) {
+      *info_log = "Compute shaders require OpenGL 4.3 or ARB_compute_shader.";
+    }
+    return false;
+  }
+  return true;
+}
+
+std::vector<GLuint> ShaderProgram::shaders() const {
+  if (is_compute()) {
+    return { compute_shader_ };
+  }
+  return { vertex_shader_, fragment_shader_ };
+}
+
+bool ShaderProgram::LoadProgramFromBinaryCache() {
+  if (!IsBinaryCacheAvailable()) {
+    return false;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  const bool loaded = LoadProgramBinary();
+  creation_timing_.binary_cache_seconds = SecondsSince(start);
+  return loaded;
+}
+
+bool ShaderProgram::LoadProgramBinary() {
+  std::ifstream in(BinaryCacheFilepath(), std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  // The file holds the magic string, the binary format, the size of the binary
+  // and the binary itself.
+  char magic[sizeof(kBinaryCacheMagic)];
+  GLenum binary_format = 0;
+  GLint binary_size = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&binary_format), sizeof(binary_format));
+  in.read(reinterpret_cast<char*>(&binary_size), sizeof(binary_size));
+  if (!in || std::string(magic, sizeof(magic)) !=
+      std::string(kBinaryCacheMagic, sizeof(kBinaryCacheMagic)) ||
+      binary_size <= 0) {
+    return false;
+  }
+  std::vector<char> binary(binary_size);
+  in.read(binary.data(), binary_size);
+  if (!in) {
+    return false;
+  }
+  const GLuint shader_program = glCreateProgram();
+  glProgramBinary(shader_program, binary_format, binary.data(), binary_size);
+  // The driver rejects binaries it cannot use, e.g., after a driver update,
+  // by failing the link status. In that case we build from the sources.
+  GLint success = 0;
+  glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+  if (!success) {
+    glDeleteProgram(shader_program);
+    return false;
+  }
+  shader_program_id_ = shader_program;
+  loaded_from_binary_cache_ = true;
+  return true;
+}
+
+void ShaderProgram::StoreProgramInBinaryCache() const {
+  if (!IsBinaryCacheAvailable()) {
+    return;
+  }
+  GLint binary_size = 0;
+  glGetProgramiv(shader_program_id_, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+  if (binary_size <= 0) {
+    return;
+  }
+  std::vector<char> binary(binary_size);
+  GLenum binary_format = 0;
+  glGetProgramBinary(shader_program_id_, binary_size, nullptr, &binary_format,
+                     binary.data());
+  // Write into a temporary file and rename it, so that a concurrent launch
+  // never reads a partially written binary. mkstemp() gives every writer its
+  // own temporary file, so writers of the same key, in this or another
+  // process, never mix their bytes.
+  const std::string filepath = BinaryCacheFilepath();
+  std::string temporary_filepath = filepath + ".XXXXXX";
+  const int fd = mkstemp(&temporary_filepath[0]);
+  if (fd < 0) {
+    return;
+  }
+  FILE* out = fdopen(fd, "wb");
+  if (!out) {
+    close(fd);
+    remove(temporary_filepath.c_str());
+    return;
+  }
+  bool written =
+      fwrite(kBinaryCacheMagic, sizeof(kBinaryCacheMagic), 1, out) == 1 &&
+      fwrite(&binary_format, sizeof(binary_format), 1, out) == 1 &&
+      fwrite(&binary_size, sizeof(binary_size), 1, out) == 1 &&
+      fwrite(binary.data(), binary_size, 1, out) == 1;
+  written = fclose(out) == 0 && written;
+  if (!written || rename(temporary_filepath.c_str(), filepath.c_str()) != 0) {
+    remove(temporary_filepath.c_str());
+  }
+}
+
+void ShaderProgram::StartCreationTiming() {
+  creation_timing_ = CreationTiming();
+  creation_timing_.label = label_;
+  if (uses_spirv()) {
+    creation_timing_.source_size = vertex_shader_spirv_.size() +
+        fragment_shader_spirv_.size() + compute_shader_spirv_.size();
+  } else {
+    creation_timing_.source_size = vertex_shader_src_.size() +
+        fragment_shader_src_.size() + compute_shader_src_.size();
+  }
+}
+
+void ShaderProgram::RecordCreationTiming(const bool created) {
+  creation_timing_.created = created;
+  std::lock_guard<std::mutex> lock(creation_timings_mutex);
+  std::deque<CreationTiming>* creation_timings = MutableCreationTimings();
+  if (max_num_creation_timings == 0) {
+    return;
+  }
+  if (creation_timings->size() == max_num_creation_timings) {
+    creation_timings->pop_front();
+  }
+  creation_timings->push_back(creation_timing_);
+}
+
+std::vector<ShaderProgram::CreationTiming>
+ShaderProgram::GetCreationTimings() {
+  std::lock_guard<std::mutex> lock(creation_timings_mutex);
+  const std::deque<CreationTiming>& creation_timings =
+      *MutableCreationTimings();
+  return std::vector<CreationTiming>(creation_timings.begin(),
+                                     creation_timings.end());
+}
+
+void ShaderProgram::ClearCreationTimings() {
+  std::lock_guard<std::mutex> lock(creation_timings_mutex);
+  MutableCreationTimings()->clear();
+}
+
+void ShaderProgram::SetMaxNumCreationTimings(const size_t num_timings) {
+  std::lock_guard<std::mutex> lock(creation_timings_mutex);
+  max_num_creation_timings = num_timings;
+  std::deque<CreationTiming>* creation_timings = MutableCreationTimings();
+  while (creation_timings->size() > max_num_creation_timings) {
+    creation_timings->pop_front();
+  }
+}
+
+std::string ShaderProgram::MakeCreationReport() {
+  std::vector<CreationTiming> creation_timings = GetCreationTimings();
+  std::sort(creation_timings.begin(), creation_timings.end(),
+            [](const CreationTiming& lhs, const CreationTiming& rhs) {
+              return lhs.total_seconds() > rhs.total_seconds();
+            });
+  double total_seconds = 0.0;
+  for (const CreationTiming& creation_timing : creation_timings) {
+    total_seconds += creation_timing.total_seconds();
+  }
+  char line[256];
+  snprintf(line, sizeof(line), "%zu programs created in %.3f ms.\n",
+           creation_timings.size(), 1e3 * total_seconds);
+  std::string report = line;
+  report += "  total ms   cache ms  vertex ms    frag ms compute ms    link ms"
+      "      bytes  label\n";
+  for (const CreationTiming& creation_timing : creation_timings) {
+    snprintf(line, sizeof(line),
+             "%10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10zu  ",
+             1e3 * creation_timing.total_seconds(),
+             1e3 * creation_timing.binary_cache_seconds,
+             1e3 * creation_timing.vertex_shader_seconds,
+             1e3 * creation_timing.fragment_shader_seconds,
+             1e3 * creation_timing.compute_shader_seconds,
+             1e3 * creation_timing.link_seconds,
+             creation_timing.source_size);
+    report += line;
+    report += creation_timing.label.empty() ?
+        "(unlabeled)" : creation_timing.label;
+    if (!creation_timing.created) {
+      report += " (failed)";
+    }
+    report += "\n";
+  }
+  return report;
+}
+
+std::string ShaderProgram::BinaryCacheFilepath() const {
+  // Programs built from SPIR-V are keyed by their modules.
+  if (uses_spirv()) {
+    return GetBinaryCacheFilepath(vertex_shader_spirv_, fragment_shader_spirv_,
+                                  compute_shader_spirv_);
+  }
+  return GetBinaryCacheFilepath(vertex_shader_src_, fragment_shader_src_,
+                                compute_shader_src_);
+}
+
+void ShaderProgram::OnProgramCreated() {
+  created_ = true;
+  // Enumerate the variables once, so that no string lookups are needed while
+  // rendering.
+  uniforms_ = GetActiveVariables(shader_program_id_, GL_ACTIVE_UNIFORMS);
+  attributes_ = GetActiveVariables(shader_program_id_, GL_ACTIVE_ATTRIBUTES);
+  uniform_states_.assign(uniforms_.size(), UniformState());
+}
+
 }  // namespace wvu
@@ -35,9 +35,13 @@
 #ifndef GLUTILS_SHADER_PROGRAM_H_
 #define GLUTILS_SHADER_PROGRAM_H_
 
+#include <stdint.h>
 #include <string>
+#include <vector>
 #include <GL/glew.h>
 
+#include "shader_preprocessor.h"
+
 namespace wvu {
 // This class helps with the compilation of vertex and fragment shaders. The
 // class compiles the shaders and creates a shader program. The class keeps
@@ -80,32 +84,163 @@ namespace wvu {
 //   ...
 // }
 //
-// 4) Passing uniform variables to shader example:
-// When passing values to uniform variables in the shader program, the shader
-// program id is necessary. This class provides access to this id by calling the
-// accessor method shader_program_id().
+// 4) Reusing linked programs across launches example:
+// Linking from GLSL is expensive. When a binary cache directory is set,
+// Create() looks for a program binary previously stored by the driver and, if
+// the sources, the renderer and the driver version match, loads it instead of
+// compiling and linking. Otherwise the program is built from the sources as
+// usual and its binary is stored for the next launch.
+//
+// wvu::ShaderProgram::SetBinaryCacheDirectory("/path/to/cache");
+// ...
+// shader_program.Create(&error_info_log);
+//
+// 5) Creating many programs asynchronously example:
+// Create() waits for the driver after every compilation. Submitting all the
+// programs first with CreateAsync() lets drivers that expose
+// KHR_parallel_shader_compile build them in worker threads while the
+// application keeps rendering.
+//
+// for (wvu::ShaderProgram& shader_program : shader_programs) {
+//   shader_program.CreateAsync();
+// }
+// while (...) {  // Rendering loop.
+//   if (shader_program.IsReady() && !shader_program.Finish(&error_info_log)) {
+//     LOG(ERROR) << error_info_log;
+//   }
+//   ...  // Draw with a fallback program until Finish() succeeds.
+// }
+//
+// 6) Passing uniform variables to shader example:
+// Once the program is created, the class knows every active uniform and
+// attribute. Resolve the handles of the uniforms once, outside the rendering
+// loop, and use the typed setters with the handles inside the loop. This way
+// no string lookup happens per frame. The setters only record the values;
+// FlushUniforms() uploads the values that changed since the last flush right
+// before the draw.
+//
+//  const wvu::ShaderProgram::UniformHandle model_handle =
+//      shader_program.GetUniformHandle("model");
+//  while (...) {  // Rendering loop.
+//    shader_program.Use();
+//    shader_program.SetUniformMatrix4(model_handle, model_matrix.data());
+//    shader_program.FlushUniforms();
+//    glDrawArrays(...);
+//  }
+//
+// 7) Running a compute shader example:
+// A program holds either a compute shader or a vertex and a fragment shader.
+// Compute shaders read and write shader storage buffers, which are bound to
+// the bindings declared by the shader before dispatching.
+//
+// wvu::ShaderProgram compute_program;
+// compute_program.LoadComputeShaderFromString(compute_shader_string_instance);
+// compute_program.Create(&error_info_log);
+// wvu::ShaderProgram::BindShaderStorageBuffer(0, input_buffer);
+// wvu::ShaderProgram::BindShaderStorageBuffer(1, output_buffer);
+// compute_program.Dispatch(num_groups);
+// glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+//
+// 8) Loading precompiled SPIR-V shaders example:
+// Compiling SPIR-V modules at build time, e.g., with glslangValidator -G,
+// spares the driver the parsing of GLSL on every launch. The GLSL sources are
+// the fallback for contexts without ARB_gl_spirv.
+//
+// wvu::ShaderProgram shader_program;
+// shader_program.LoadSpirvShaderFromFile(GL_VERTEX_SHADER, "shader.vert.spv");
+// shader_program.LoadSpirvShaderFromFile(GL_FRAGMENT_SHADER,
+//                                        "shader.frag.spv");
+// shader_program.LoadVertexShaderFromFile("shader.vert");
+// shader_program.LoadFragmentShaderFromFile("shader.frag");
+// shader_program.Create(&error_info_log);
+//
+// 9) Finding the programs that dominate startup example:
+// Every program records how long its creation took. Label the programs to
+// tell them apart in the report.
 //
-//  ...
-//  const GLint uniform_variable_location =
-//     glGetUniformLocation(shader_program_.shader_program_id(),
-//                          "uniform_variable_name");
-//  ...
+// shader_program.set_label("terrain");
+// shader_program.Create(&error_info_log);
+// ...  // Create the rest of the programs.
+// std::cout << wvu::ShaderProgram::MakeCreationReport();
+//
+// The shader program id is still available through the accessor method
+// shader_program_id() for direct OpenGL calls.
 class ShaderProgram {
  public:
+  // Index of an active uniform in uniforms(). Handles are resolved once with
+  // GetUniformHandle() and stay valid while the program exists.
+  typedef int UniformHandle;
+  static constexpr UniformHandle kInvalidUniformHandle = -1;
+
+  // The glUniform*() function that uploads a uniform.
+  enum UniformUpload {
+    UNIFORM_1F, UNIFORM_1I, UNIFORM_1UI, UNIFORM_2FV, UNIFORM_3FV, UNIFORM_4FV,
+    UNIFORM_MATRIX_3FV, UNIFORM_MATRIX_4FV
+  };
+
+  // Description of an active uniform or attribute of the program. The names of
+  // arrays do not include the "[0]" suffix reported by OpenGL.
+  struct ShaderVariable {
+    std::string name;
+    // The location to use with OpenGL functions.
+    GLint location;
+    // The OpenGL type, e.g., GL_FLOAT_VEC3.
+    GLenum type;
+    // The number of elements; greater than one for arrays.
+    GLint size;
+  };
+
+  // Wall time spent creating a program. For programs created with
+  // CreateAsync(), the shader times cover the submission only and link_seconds
+  // covers the wait in Finish().
+  struct CreationTiming {
+    CreationTiming() :
+        source_size(0), binary_cache_seconds(0.0), vertex_shader_seconds(0.0),
+        fragment_shader_seconds(0.0), compute_shader_seconds(0.0),
+        link_seconds(0.0), created(false) {}
+    std::string label;
+    // Bytes of the GLSL sources or SPIR-V modules the program is built from.
+    size_t source_size;
+    // Time spent looking up the binary cache, see SetBinaryCacheDirectory().
+    double binary_cache_seconds;
+    double vertex_shader_seconds;
+    double fragment_shader_seconds;
+    double compute_shader_seconds;
+    double link_seconds;
+    // False when the creation failed.
+    bool created;
+
+    double total_seconds() const {
+      return binary_cache_seconds + vertex_shader_seconds +
+          fragment_shader_seconds + compute_shader_seconds + link_seconds;
+    }
+  };
+
   // Default constructor.
   ShaderProgram() :
       // Initializing member attributes.
       vertex_shader_src_(""), fragment_shader_src_(""),
-      vertex_shader_(0), fragment_shader_(0), shader_program_id_(0),
-      created_(false) {}
+      compute_shader_src_(""), vertex_shader_spirv_(""),
+      fragment_shader_spirv_(""), compute_shader_spirv_(""),
+      vertex_shader_(0), fragment_shader_(0),
+      compute_shader_(0), shader_program_id_(0),
+      created_(false), creation_pending_(false),
+      loaded_from_binary_cache_(false), label_(""), num_uniform_uploads_(0),
+      num_skipped_uniform_uploads_(0) {}
   // Destructor. Invoked automatically once the instance goes out of scope.
   virtual ~ShaderProgram() {
-    if (created_) {
-      // Once the shader program is not needed, we tell OpenGL to delete it.
-      glDeleteProgram(shader_program_id_);
-    }
+    Release();
   }
 
+  // The class owns the OpenGL program and deletes it in the destructor, so
+  // instances cannot be copied. Moving transfers the program; the moved-from
+  // instance is left as a default-constructed one. This allows keeping
+  // programs by value in containers, e.g., std::vector<ShaderProgram>.
+  ShaderProgram(const ShaderProgram&) = delete;
+  ShaderProgram& operator=(const ShaderProgram&) = delete;
+  ShaderProgram(ShaderProgram&& other) noexcept;
+  ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+
   // The accessor member returns the shader program id that OpenGL generates
   // when creating the shader program. When the shader program has not been
   // created, the shader_program_id() returns 0.
@@ -113,6 +248,138 @@ class ShaderProgram {
     return shader_program_id_;
   }
 
+  // Returns the active uniforms of the created program. Uniforms inside uniform
+  // blocks are not listed since they are not set with glUniform*().
+  const std::vector<ShaderVariable>& uniforms() const {
+    return uniforms_;
+  }
+
+  // Returns the active attributes of the created program.
+  const std::vector<ShaderVariable>& attributes() const {
+    return attributes_;
+  }
+
+  // Returns the handle of the active uniform with the given name, or
+  // kInvalidUniformHandle if the program does not use such a uniform.
+  UniformHandle GetUniformHandle(const std::string& name) const;
+
+  // Returns the location of the active attribute with the given name, or -1 if
+  // the program does not use such an attribute.
+  GLint GetAttributeLocation(const std::string& name) const;
+
+  // Typed setters of uniforms. The class keeps a copy of the value of every
+  // uniform. A setter compares the value with the copy and, if it differs,
+  // records the new value and marks the uniform dirty; nothing is sent to
+  // OpenGL until FlushUniforms(). Setting an invalid handle does nothing, just
+  // like OpenGL ignores the location -1; this includes every handle out of the
+  // range of the uniforms of this program. Vectors and matrices read their
+  // values from the given pointer; matrices are in column-major order, i.e.,
+  // what Eigen::Matrix4f::data() returns.
+  void SetUniform(const UniformHandle handle, const GLfloat value);
+  void SetUniform(const UniformHandle handle, const GLint value);
+  void SetUniform(const UniformHandle handle, const GLuint value);
+  void SetUniformVector2(const UniformHandle handle, const GLfloat* values);
+  void SetUniformVector3(const UniformHandle handle, const GLfloat* values);
+  void SetUniformVector4(const UniformHandle handle, const GLfloat* values);
+  void SetUniformMatrix3(const UniformHandle handle, const GLfloat* values);
+  void SetUniformMatrix4(const UniformHandle handle, const GLfloat* values);
+
+  // Uploads the dirty uniforms with glUniform*(). The program must be in use,
+  // see Use(). Call it once right before every draw or dispatch. Returns the
+  // number of uniforms uploaded.
+  int FlushUniforms();
+
+  // Returns the handles of the uniforms that the next FlushUniforms() uploads.
+  const std::vector<UniformHandle>& dirty_uniforms() const {
+    return dirty_uniforms_;
+  }
+
+  // Returns the glUniform*() function and the raw bits of the value last set
+  // for the uniform. Returns false if the handle is invalid or the uniform was
+  // never set.
+  bool GetUniformValue(const UniformHandle handle,
+                       UniformUpload* upload,
+                       const uint32_t** values) const;
+
+  // Uploads the raw bits of a value to the location of the program in use with
+  // the glUniform*() function, as FlushUniforms() does.
+  static void UploadUniform(const GLint location,
+                            const UniformUpload upload,
+                            const uint32_t* values);
+
+  // Returns the number of uniforms uploaded by FlushUniforms(), and the number
+  // of setter calls that were dropped because the uniform already had the
+  // value.
+  uint64_t num_uniform_uploads() const {
+    return num_uniform_uploads_;
+  }
+  uint64_t num_skipped_uniform_uploads() const {
+    return num_skipped_uniform_uploads_;
+  }
+
+  // Sets both uniform counters to zero.
+  void ResetUniformCounters() {
+    num_uniform_uploads_ = 0;
+    num_skipped_uniform_uploads_ = 0;
+  }
+
+  // Sets a name that identifies the program in the creation timings.
+  void set_label(const std::string& label) {
+    label_ = label;
+  }
+  const std::string& label() const {
+    return label_;
+  }
+
+  // Returns the GLSL sources of the shaders, empty when not loaded.
+  const std::string& vertex_shader_src() const {
+    return vertex_shader_src_;
+  }
+  const std::string& fragment_shader_src() const {
+    return fragment_shader_src_;
+  }
+
+  // Returns the timing of the last creation of the program, see Create() and
+  // Finish().
+  const CreationTiming& creation_timing() const {
+    return creation_timing_;
+  }
+
+  // Returns the timings of the program creations completed so far, for all
+  // threads, in completion order. Only the last SetMaxNumCreationTimings()
+  // timings are kept, so that programs created all along, e.g., by hot
+  // reloading, do not grow the list without bound.
+  static std::vector<CreationTiming> GetCreationTimings();
+
+  // Forgets the timings returned by GetCreationTimings().
+  static void ClearCreationTimings();
+
+  // Sets how many of the last timings GetCreationTimings() keeps, 1024 by
+  // default. Zero stops recording them. Extra timings are dropped at once.
+  static void SetMaxNumCreationTimings(const size_t num_timings);
+
+  // Returns a report of the timings returned by GetCreationTimings(), with one
+  // line per program sorted from the slowest to the fastest creation.
+  static std::string MakeCreationReport();
+
+  // Returns true if Create() loaded the program from the binary cache instead
+  // of compiling and linking it.
+  bool loaded_from_binary_cache() const {
+    return loaded_from_binary_cache_;
+  }
+
+  // Sets the directory where linked program binaries are stored and looked up
+  // by Create(). The cache is disabled when the directory is empty, which is
+  // the default. The directory is created if it does not exist. Any mismatch or
+  // failure while using the cache silently falls back to compiling the
+  // sources. The cache requires ARB_get_program_binary.
+  static void SetBinaryCacheDirectory(const std::string& directory);
+
+  // Returns a copy of the directory of the binary cache, or an empty string
+  // when the cache is disabled. The directory may be changed by another thread
+  // at any time.
+  static std::string binary_cache_directory();
+
   // Loads a vertex shader source coude from a string. Returns true if
   // successful, and false otherwise.
   // Parameters:
@@ -138,11 +405,89 @@ class ShaderProgram {
   //   fragment_shader_path  The filepath for the fragment shader.
   bool LoadFragmentShaderFromFile(const std::string& fragment_shader_path);
 
+  // Loads a compute shader source code from a string. A program with a compute
+  // shader cannot have a vertex or a fragment shader. Returns true if
+  // successful, and false otherwise.
+  // Parameters:
+  //   compute_shader_source  The C++ string containing the compute shader
+  //     source.
+  bool LoadComputeShaderFromString(const std::string& compute_shader_source);
+
+  // Loads a compute shader from a file. Returns true if successful, and false
+  // otherwise.
+  // Parameters:
+  //   compute_shader_path  The filepath for the compute shader.
+  bool LoadComputeShaderFromFile(const std::string& compute_shader_path);
+
+  // Loads a precompiled SPIR-V module, see ARB_gl_spirv. The module must have a
+  // "main" entry point; specialization constants keep their default values.
+  // Create() uses the modules instead of the GLSL sources when the context
+  // supports ARB_gl_spirv and every shader of the program has a module.
+  // Otherwise it compiles the GLSL sources, so load them as well to support
+  // every context. Since the names of the variables may be stripped from the
+  // modules, the shaders should declare explicit locations and bindings.
+  // Returns true if successful, and false otherwise, e.g., when the data is not
+  // a SPIR-V module.
+  // Parameters:
+  //   shader_type  GL_VERTEX_SHADER, GL_FRAGMENT_SHADER or GL_COMPUTE_SHADER.
+  //   spirv_module  The bytes of the SPIR-V module.
+  bool LoadSpirvShader(const GLenum shader_type,
+                       const std::string& spirv_module);
+
+  // Loads a precompiled SPIR-V module from a file, see LoadSpirvShader().
+  // Parameters:
+  //   shader_type  GL_VERTEX_SHADER, GL_FRAGMENT_SHADER or GL_COMPUTE_SHADER.
+  //   spirv_path  The filepath for the SPIR-V module.
+  bool LoadSpirvShaderFromFile(const GLenum shader_type,
+                               const std::string& spirv_path);
+
+  // Returns true if Create() builds the program from the SPIR-V modules
+  // instead of the GLSL sources with the current context.
+  bool uses_spirv() const;
+
+  // Returns true if the program has a compute shader.
+  bool is_compute() const {
+    return !compute_shader_src_.empty() || !compute_shader_spirv_.empty();
+  }
+
+  // Resolves the #include lines of the loaded shaders and injects the
+  // definitions, see ShaderPreprocessor. Call it after loading the shaders and
+  // before Create(). Returns true if successful, and false otherwise, in which
+  // case error_info_log holds the reason.
+  //
+  // Parameters:
+  //   preprocessor  The preprocessor that knows the include sources.
+  //   defines  The definitions to inject into both shaders.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool PreprocessShaders(const ShaderPreprocessor& preprocessor,
+                         const ShaderDefines& defines,
+                         std::string* error_info_log);
+
+  // Bakes the values of uniforms that never change for the program into the
+  // loaded GLSL sources as constants, see BakeShaderConstants(). The driver
+  // then folds the branches and unrolls the loops that depend on them. Call it
+  // after loading the shaders, and after PreprocessShaders() if the uniforms
+  // are declared in included sources, and before Create(). Baked uniforms are
+  // no longer active, so their handles are invalid. Returns false if a
+  // constant names no uniform declaration of the shaders, a value is empty or
+  // spans several lines, or SPIR-V modules are loaded, in which case
+  // error_info_log holds the reason.
+  //
+  // Parameters:
+  //   constants  The values of the uniforms to bake.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool BakeConstants(const ShaderConstants& constants,
+                     std::string* error_info_log);
+
   // This function executes the following steps:
-  // 1. Compiles the vertex shader. If an error occurrs, the error information
-  //    log is copied into error_info_log pointer.
+  // 0. If the binary cache is enabled and holds a matching binary, loads the
+  //    program from it and skips the steps below.
+  // 1. Compiles the vertex shader, or specializes its SPIR-V module, see
+  //    uses_spirv(). If an error occurrs, the error information log is copied
+  //    into error_info_log pointer.
   // 2. Compiles the fragment shader. If an error occurrs, the error information
   //    log is copied into error_info_log pointer.
+  //    A compute program compiles its compute shader instead of steps 1 and 2.
   // 3. Links the shaders to form a shader program. If an error occurrs, the
   //    error information log is copied into error_info_log pointer.
   // 4. Cleans up temporary variables.
@@ -153,39 +498,200 @@ class ShaderProgram {
   //  error_info_log  A pointer to a string that holds the error log.
   bool Create(std::string* error_info_log);
 
+  // Submits the compilation of the shaders and the linkage of the program, and
+  // returns without waiting for the driver. Call IsReady() to poll the progress
+  // and Finish() to complete the creation. When the binary cache holds the
+  // program, it is loaded right away. Calling this function on a created or
+  // submitted program does nothing.
+  void CreateAsync();
+
+  // Returns true when Finish() will not wait for the driver. It never blocks.
+  // It relies on KHR_parallel_shader_compile; without the extension the driver
+  // compiles when the status is queried, so it always returns true.
+  bool IsReady() const;
+
+  // Waits until the driver compiles and links the program submitted with
+  // CreateAsync(), and completes its creation. Returns true if the program
+  // was created, and false otherwise. As with Create(), the error information
+  // log is copied into error_info_log in case of a failure.
+  //
+  // Parameters:
+  //  error_info_log  A pointer to a string that holds the error log.
+  bool Finish(std::string* error_info_log);
+
+  // Uses the compute program and launches the given number of work groups.
+  // Returns false if the program is not a created compute program, or if a
+  // count exceeds GetMaxComputeWorkGroupCount(), in which case nothing is
+  // launched. The caller issues the glMemoryBarrier() that matches how the
+  // results are used.
+  bool Dispatch(const GLuint num_groups_x,
+                const GLuint num_groups_y = 1,
+                const GLuint num_groups_z = 1) const;
+
+  // Returns the maximum number of work groups of a dispatch along each
+  // dimension, i.e., GL_MAX_COMPUTE_WORK_GROUP_COUNT. OpenGL guarantees only
+  // 65535, so larger work has to be split into several dispatches. The limit
+  // is queried once per thread, which assumes one context per thread as Use()
+  // does.
+  static void GetMaxComputeWorkGroupCount(GLuint max_num_groups[3]);
+
+  // Returns the local size declared by the compute shader, or zeros if the
+  // program is not a created compute program.
+  void GetComputeWorkGroupSize(GLint work_group_size[3]) const;
+
+  // Returns the binding of the shader storage block with the given name, or -1
+  // if the program has no such block.
+  GLint GetShaderStorageBlockBinding(const std::string& name) const;
+
+  // Assigns the binding to the uniform block with the given name, i.e., the
+  // binding of the uniform buffer that the block reads. Returns false if the
+  // program has no such block.
+  bool SetUniformBlockBinding(const std::string& name,
+                              const GLuint binding) const;
+
+  // Binds the whole buffer, or a range of it, to the shader storage binding.
+  static void BindShaderStorageBuffer(const GLuint binding,
+                                      const GLuint buffer);
+  static void BindShaderStorageBuffer(const GLuint binding,
+                                      const GLuint buffer,
+                                      const GLintptr offset,
+                                      const GLsizeiptr size);
+
+  // Sets the number of threads the driver may use to compile shaders in
+  // parallel. Requires KHR_parallel_shader_compile or
+  // ARB_parallel_shader_compile; otherwise it does nothing.
+  static void SetMaxShaderCompilerThreads(const GLuint num_threads);
+
   // This function activates the shader as the current one in OpenGL.
   // Returns true if the function successfully activates the shader program.
-  bool Use() const {
-    if (created_) {
-      // We set the shader program as active.
-      glUseProgram(shader_program_id_);
-      return true;
-    }
-    return false;
-  }
+  // The class remembers the program that is in use, so calling Use() on the
+  // program that is already active does not call OpenGL. The tracking is per
+  // thread, which matches the context that is current in the thread. Call
+  // InvalidateCurrentProgram() after making a different context current or
+  // after calling glUseProgram() directly.
+  bool Use() const;
+
+  // Unbinds the program in use with glUseProgram(0), e.g., so that a program
+  // pipeline takes effect. The call is skipped when no program is known to be
+  // in use, and counts as a program bind.
+  static void UseNoProgram();
+
+  // Forgets the program that is in use in the calling thread, so that the next
+  // Use() or UseNoProgram() calls OpenGL.
+  static void InvalidateCurrentProgram();
+
+  // Returns the program that Use() made current in the calling thread, or zero
+  // when unknown or after UseNoProgram().
+  static GLuint current_program_id();
+
+  // Returns the number of glUseProgram() calls issued by Use() and the number
+  // of calls skipped because the program was already in use, for all threads.
+  static uint64_t num_program_binds_issued();
+  static uint64_t num_program_binds_skipped();
+
+  // Sets both bind counters to zero.
+  static void ResetProgramBindCounters();
+
+  // Returns the number of programs linked from sources, for all threads.
+  // Programs loaded from the binary cache are not linked.
+  static uint64_t num_program_links();
 
  protected:
+  // The value of a uniform as last set, and whether it awaits its upload.
+  struct UniformState {
+    UniformState() : upload(UNIFORM_1F), known(false), dirty(false) {}
+    UniformUpload upload;
+    // False until the uniform is set for the first time, since the value that
+    // OpenGL holds after linking is unknown.
+    bool known;
+    bool dirty;
+    // Raw bits of up to a 4x4 matrix.
+    uint32_t values[16];
+  };
+
+  // Records the value of a uniform and marks it dirty if it changed.
+  void SetUniformValue(const UniformHandle handle,
+                       const UniformUpload upload,
+                       const void* values,
+                       const int num_values);
+
   // Compiles the vertex shader.
   bool BuildVertexShader(std::string* info_log);
   // Compiles the fragment shader.
   bool BuildFragmentShader(std::string* info_log);
+  // Compiles the compute shader.
+  bool BuildComputeShader(std::string* info_log);
   // Links the shaders to form a shader program.
   bool LinkProgram(std::string* info_log);
+  // Creates the program from a binary stored in the cache. Returns true if
+  // successful, and false otherwise.
+  bool LoadProgramFromBinaryCache();
+  // Reads the binary of the program from the cache and loads it.
+  bool LoadProgramBinary();
+  // Stores the binary of the linked program in the cache.
+  void StoreProgramInBinaryCache() const;
+  // Returns the path of the cache file of the shaders the program is built
+  // from.
+  std::string BinaryCacheFilepath() const;
+  // Resets the timing and sets the label and the source size for a new
+  // creation.
+  void StartCreationTiming();
+  // Stores the timing of the completed creation with the timings of all the
+  // programs.
+  void RecordCreationTiming(const bool created);
+  // Marks the program as created and enumerates its active uniforms and
+  // attributes.
+  void OnProgramCreated();
+  // Forgets the program if it is the one in use in the calling thread.
+  void OnProgramDeleted() const;
+  // Verifies that the loaded shaders form a valid program and that the context
+  // supports them.
+  bool CheckShaderSources(std::string* info_log) const;
+  // Returns the ids of the shaders of the program.
+  std::vector<GLuint> shaders() const;
+  // Deletes the OpenGL objects owned by the instance and resets it to the
+  // state of a default-constructed one.
+  void Release();
 
  private:
   // Vertex shader program source.
   std::string vertex_shader_src_;
   // Fragment shader program source.
   std::string fragment_shader_src_;
+  // Compute shader program source.
+  std::string compute_shader_src_;
+  // SPIR-V modules of the shaders, if loaded.
+  std::string vertex_shader_spirv_;
+  std::string fragment_shader_spirv_;
+  std::string compute_shader_spirv_;
   // Vertex shader id.
   GLuint vertex_shader_;
   // Fragment shader id.
   GLuint fragment_shader_;
+  // Compute shader id.
+  GLuint compute_shader_;
   // Program shader id.
   GLuint shader_program_id_;
   // Created state variable. True when this shader program is created, and false
   // otherwise.
   bool created_;
+  // True when CreateAsync() submitted the program and Finish() was not called
+  // yet.
+  bool creation_pending_;
+  // True when the program was loaded from the binary cache.
+  bool loaded_from_binary_cache_;
+  // Name of the program in the creation timings.
+  std::string label_;
+  CreationTiming creation_timing_;
+  // Active uniforms and attributes, enumerated once the program is created.
+  std::vector<ShaderVariable> uniforms_;
+  std::vector<ShaderVariable> attributes_;
+  // Shadow copy of the uniforms, indexed by handle, and the handles of the
+  // dirty ones.
+  std::vector<UniformState> uniform_states_;
+  std::vector<UniformHandle> dirty_uniforms_;
+  uint64_t num_uniform_uploads_;
+  uint64_t num_skipped_uniform_uploads_;
 };
 
 }  // namespace wvu
@@ -0,0 +1,122 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_program_pool.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shader_program.h"
+
+namespace wvu {
+
+void ShaderProgramPool::Reserve(const int num_programs) {
+  slots_.reserve(num_programs);
+}
+
+ShaderProgramPool::Handle ShaderProgramPool::Add(
+    ShaderProgram&& shader_program) {
+  const uint32_t index = AcquireSlot();
+  Slot& slot = slots_[index];
+  slot.program = std::move(shader_program);
+  slot.in_use = true;
+  ++num_programs_;
+  return Handle{ index, slot.generation };
+}
+
+ShaderProgramPool::Handle ShaderProgramPool::Create(
+    const std::string& vertex_shader_src,
+    const std::string& fragment_shader_src,
+    std::string* error_info_log) {
+  const uint32_t index = AcquireSlot();
+  Slot& slot = slots_[index];
+  slot.program.LoadVertexShaderFromString(vertex_shader_src);
+  slot.program.LoadFragmentShaderFromString(fragment_shader_src);
+  if (!slot.program.Create(error_info_log)) {
+    // Leave the slot free for the next program.
+    slot.program = ShaderProgram();
+    free_slots_.push_back(index);
+    return Handle{ 0, 0 };
+  }
+  slot.in_use = true;
+  ++num_programs_;
+  return Handle{ index, slot.generation };
+}
+
+ShaderProgram* ShaderProgramPool::Get(const Handle handle) {
+  return const_cast<ShaderProgram*>(
+      static_cast<const ShaderProgramPool*>(this)->Get(handle));
+}
+
+const ShaderProgram* ShaderProgramPool::Get(const Handle handle) const {
+  if (handle.index >= slots_.size()) {
+    return nullptr;
+  }
+  const Slot& slot = slots_[handle.index];
+  if (!slot.in_use || slot.generation != handle.generation) {
+    return nullptr;
+  }
+  return &slot.program;
+}
+
+bool ShaderProgramPool::Remove(const Handle handle) {
+  if (Get(handle) == nullptr) {
+    return false;
+  }
+  Slot& slot = slots_[handle.index];
+  // Assigning an empty program deletes the OpenGL program.
+  slot.program = ShaderProgram();
+  slot.in_use = false;
+  // Skip zero on wrap-around, since it marks invalid handles.
+  if (++slot.generation == 0) {
+    slot.generation = 1;
+  }
+  free_slots_.push_back(handle.index);
+  --num_programs_;
+  return true;
+}
+
+uint32_t ShaderProgramPool::AcquireSlot() {
+  if (!free_slots_.empty()) {
+    const uint32_t index = free_slots_.back();
+    free_slots_.pop_back();
+    return index;
+  }
+  slots_.emplace_back();
+  return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+}  // namespace wvu
@@ -0,0 +1,129 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_PROGRAM_POOL_H_
+#define GLUTILS_SHADER_PROGRAM_POOL_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "shader_program.h"
+
+namespace wvu {
+// This class owns many shader programs in a single contiguous array and hands
+// out handles to them. A handle is the index of a slot and the generation of
+// the slot when the program was added; removing a program bumps the
+// generation of its slot, so handles of removed programs are detected instead
+// of silently referring to the program that reuses the slot. Handles stay
+// valid while the array grows, whereas pointers returned by Get() are only
+// valid until the next call to Add() or Create(). Programs are stored by
+// value, so adding one does not allocate unless the array grows, and removed
+// slots are reused.
+//
+// Example.
+//
+// wvu::ShaderProgramPool pool;
+// const wvu::ShaderProgramPool::Handle material =
+//     pool.Create(vertex_shader_src, fragment_shader_src, &error_info_log);
+// while (...) {  // Rendering loop.
+//   pool.Get(material)->Use();
+//   ...
+// }
+class ShaderProgramPool {
+ public:
+  // A handle to a program of the pool. The generation of a valid handle is
+  // never zero, so a value-initialized handle is invalid.
+  struct Handle {
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  ShaderProgramPool() : num_programs_(0) {}
+
+  // Reserves space for the given number of programs, so that adding them does
+  // not grow the array.
+  void Reserve(const int num_programs);
+
+  // Moves the program into the pool and returns its handle.
+  Handle Add(ShaderProgram&& shader_program);
+
+  // Creates a program from the sources directly in the pool and returns its
+  // handle. Returns an invalid handle if the program cannot be created, in
+  // which case error_info_log holds the error log.
+  //
+  // Parameters:
+  //   vertex_shader_src  The C++ string containing the vertex shader source.
+  //   fragment_shader_src  The C++ string containing the fragment shader
+  //     source.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  Handle Create(const std::string& vertex_shader_src,
+                const std::string& fragment_shader_src,
+                std::string* error_info_log);
+
+  // Returns the program of the handle, or a null pointer if the handle is
+  // invalid or its program was removed.
+  ShaderProgram* Get(const Handle handle);
+  const ShaderProgram* Get(const Handle handle) const;
+
+  // Deletes the program of the handle. Returns false if the handle is invalid
+  // or its program was already removed, and true otherwise.
+  bool Remove(const Handle handle);
+
+  // Returns the number of programs in the pool.
+  int num_programs() const {
+    return num_programs_;
+  }
+
+ private:
+  // A slot of the array. The slot holds a program when in_use is true.
+  struct Slot {
+    Slot() : generation(1), in_use(false) {}
+    ShaderProgram program;
+    uint32_t generation;
+    bool in_use;
+  };
+
+  // Returns the index of a free slot, growing the array if needed.
+  uint32_t AcquireSlot();
+
+  std::vector<Slot> slots_;
+  // Indices of the slots whose programs were removed.
+  std::vector<uint32_t> free_slots_;
+  int num_programs_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_PROGRAM_POOL_H_
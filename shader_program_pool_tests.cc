@@ -0,0 +1,103 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "shader_program_pool.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class ShaderProgramPoolTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderProgramPoolTest, PoolsProgramsWithStableHandles) {
+  constexpr int kNumPrograms = 32;
+  ShaderProgramPool pool;
+  std::vector<ShaderProgramPool::Handle> handles;
+  std::vector<GLuint> program_ids;
+  for (int i = 0; i < kNumPrograms; ++i) {
+    std::string error_info_log;
+    const ShaderProgramPool::Handle handle =
+        pool.Create(vertex_shader_src, MakeFragmentShaderSource(i),
+                    &error_info_log);
+    ASSERT_NE(pool.Get(handle), nullptr) << error_info_log;
+    handles.push_back(handle);
+    program_ids.push_back(pool.Get(handle)->shader_program_id());
+  }
+  EXPECT_EQ(pool.num_programs(), kNumPrograms);
+  // The handles still refer to the same programs after the pool grew.
+  for (int i = 0; i < kNumPrograms; ++i) {
+    ASSERT_NE(pool.Get(handles[i]), nullptr);
+    EXPECT_EQ(pool.Get(handles[i])->shader_program_id(), program_ids[i]);
+  }
+
+  // Removing a program invalidates its handle, even once the slot is reused.
+  EXPECT_TRUE(pool.Remove(handles[3]));
+  EXPECT_FALSE(glIsProgram(program_ids[3]));
+  EXPECT_EQ(pool.Get(handles[3]), nullptr);
+  EXPECT_FALSE(pool.Remove(handles[3]));
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  const ShaderProgramPool::Handle reused_handle =
+      pool.Add(std::move(shader_program));
+  EXPECT_EQ(reused_handle.index, handles[3].index);
+  EXPECT_NE(reused_handle.generation, handles[3].generation);
+  EXPECT_EQ(pool.Get(handles[3]), nullptr);
+  ASSERT_NE(pool.Get(reused_handle), nullptr);
+  EXPECT_TRUE(pool.Get(reused_handle)->Use());
+  EXPECT_EQ(pool.num_programs(), kNumPrograms);
+
+  // Invalid handles and failed creations.
+  EXPECT_EQ(pool.Get(ShaderProgramPool::Handle()), nullptr);
+  EXPECT_EQ(pool.Get(ShaderProgramPool::Handle{ kNumPrograms + 1, 1 }),
+            nullptr);
+  std::string error_info_log;
+  const ShaderProgramPool::Handle invalid_handle =
+      pool.Create(vertex_shader_src, fragment_shader_src + "asdasd;",
+                  &error_info_log);
+  EXPECT_EQ(pool.Get(invalid_handle), nullptr);
+  EXPECT_FALSE(error_info_log.empty());
+  EXPECT_EQ(pool.num_programs(), kNumPrograms);
+}
+
+}  // namespace wvu
@@ -0,0 +1,120 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_program_registry.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "shader_program.h"
+
+namespace wvu {
+
+ShaderProgramRegistry* ShaderProgramRegistry::Get() {
+  // The registry is never destroyed, so programs released during the static
+  // destruction of the process can still unregister themselves.
+  static ShaderProgramRegistry* registry = new ShaderProgramRegistry;
+  return registry;
+}
+
+size_t ShaderProgramRegistry::SourcePairHash::operator()(
+    const SourcePair& sources) const {
+  const size_t vertex_hash =
+      std::hash<std::string>()(sources.vertex_shader_src);
+  const size_t fragment_hash =
+      std::hash<std::string>()(sources.fragment_shader_src);
+  // Combine the hashes as boost::hash_combine does.
+  return vertex_hash ^
+      (fragment_hash + 0x9e3779b9 + (vertex_hash << 6) + (vertex_hash >> 2));
+}
+
+std::shared_ptr<ShaderProgram> ShaderProgramRegistry::GetOrCreate(
+    const std::string& vertex_shader_src,
+    const std::string& fragment_shader_src,
+    std::string* error_info_log) {
+  SourcePair sources = { vertex_shader_src, fragment_shader_src };
+  // The lock is held while building, so concurrent requests for the same
+  // sources compile the program only once.
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = programs_.find(sources);
+  if (entry != programs_.end()) {
+    std::shared_ptr<ShaderProgram> shader_program =
+        entry->second.program.lock();
+    if (shader_program) {
+      return shader_program;
+    }
+  }
+
+  std::unique_ptr<ShaderProgram> shader_program(new ShaderProgram);
+  shader_program->LoadVertexShaderFromString(vertex_shader_src);
+  shader_program->LoadFragmentShaderFromString(fragment_shader_src);
+  if (!shader_program->Create(error_info_log)) {
+    return nullptr;
+  }
+  const ShaderProgram* raw_program = shader_program.get();
+  std::shared_ptr<ShaderProgram> handle(
+      shader_program.release(),
+      [this, sources](ShaderProgram* shader_program) {
+        Release(sources, shader_program);
+      });
+  Entry& new_entry = programs_[sources];
+  new_entry.program = handle;
+  new_entry.raw_program = raw_program;
+  return handle;
+}
+
+int ShaderProgramRegistry::num_programs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(programs_.size());
+}
+
+void ShaderProgramRegistry::Release(const SourcePair& sources,
+                                    ShaderProgram* shader_program) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The entry may already refer to a newer program built from the same
+    // sources after this one expired, in which case it must be kept.
+    auto entry = programs_.find(sources);
+    if (entry != programs_.end() &&
+        entry->second.raw_program == shader_program) {
+      programs_.erase(entry);
+    }
+  }
+  // Deleting the instance deletes the OpenGL program.
+  delete shader_program;
+}
+
+}  // namespace wvu
@@ -0,0 +1,119 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_PROGRAM_REGISTRY_H_
+#define GLUTILS_SHADER_PROGRAM_REGISTRY_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "shader_program.h"
+
+namespace wvu {
+// This class shares linked shader programs among all the users of the same
+// vertex and fragment shader sources. The registry hashes the pair of sources
+// and hands back a reference-counted handle to a program that is already
+// linked, so identical programs are compiled and linked only once. The OpenGL
+// program is deleted once the last handle goes away; at that point the context
+// that owns the program must be current, as with any ShaderProgram.
+//
+// Example.
+//
+// std::string error_info_log;
+// std::shared_ptr<wvu::ShaderProgram> shader_program =
+//     wvu::ShaderProgramRegistry::Get()->GetOrCreate(vertex_shader_src,
+//                                                    fragment_shader_src,
+//                                                    &error_info_log);
+// if (!shader_program) {
+//   LOG(ERROR) << error_info_log;
+// }
+class ShaderProgramRegistry {
+ public:
+  // Returns the process-wide registry.
+  static ShaderProgramRegistry* Get();
+
+  // Returns a linked program built from the given sources. If a program with
+  // the same sources is alive, it is returned without compiling anything.
+  // Returns a null pointer if the program cannot be created, in which case
+  // error_info_log holds the error log.
+  //
+  // Parameters:
+  //   vertex_shader_src  The C++ string containing the vertex shader source.
+  //   fragment_shader_src  The C++ string containing the fragment shader
+  //     source.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  std::shared_ptr<ShaderProgram> GetOrCreate(
+      const std::string& vertex_shader_src,
+      const std::string& fragment_shader_src,
+      std::string* error_info_log);
+
+  // Returns the number of programs alive in the registry.
+  int num_programs() const;
+
+ private:
+  // The vertex and fragment shader sources of a program.
+  struct SourcePair {
+    std::string vertex_shader_src;
+    std::string fragment_shader_src;
+    bool operator==(const SourcePair& other) const {
+      return vertex_shader_src == other.vertex_shader_src &&
+          fragment_shader_src == other.fragment_shader_src;
+    }
+  };
+  // Hashes both sources of a pair.
+  struct SourcePairHash {
+    size_t operator()(const SourcePair& sources) const;
+  };
+  // A program of the registry. The raw pointer identifies the program that the
+  // entry refers to, even after the weak pointer expired.
+  struct Entry {
+    std::weak_ptr<ShaderProgram> program;
+    const ShaderProgram* raw_program;
+  };
+
+  ShaderProgramRegistry() {}
+  // Removes the entry of a program whose last handle went away, and deletes
+  // the program.
+  void Release(const SourcePair& sources, ShaderProgram* shader_program);
+
+  // Guards programs_.
+  mutable std::mutex mutex_;
+  std::unordered_map<SourcePair, Entry, SourcePairHash> programs_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_PROGRAM_REGISTRY_H_
@@ -0,0 +1,88 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+
+// System specific headers.
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "shader_program_registry.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class ShaderProgramRegistryTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderProgramRegistryTest, RegistrySharesProgramsWithIdenticalSources) {
+  ShaderProgramRegistry* registry = ShaderProgramRegistry::Get();
+  const int num_programs = registry->num_programs();
+  std::string error_info_log;
+  std::shared_ptr<ShaderProgram> program = registry->GetOrCreate(
+      vertex_shader_src, fragment_shader_src, &error_info_log);
+  ASSERT_NE(program, nullptr) << error_info_log;
+  std::shared_ptr<ShaderProgram> same_program = registry->GetOrCreate(
+      vertex_shader_src, fragment_shader_src, &error_info_log);
+  std::shared_ptr<ShaderProgram> other_program = registry->GetOrCreate(
+      vertex_shader_src, MakeFragmentShaderSource(7), &error_info_log);
+  ASSERT_NE(other_program, nullptr) << error_info_log;
+  EXPECT_EQ(program, same_program);
+  EXPECT_NE(program, other_program);
+  EXPECT_EQ(registry->num_programs(), num_programs + 2);
+
+  // The program is deleted once the last handle goes away.
+  const GLuint program_id = program->shader_program_id();
+  program.reset();
+  EXPECT_TRUE(glIsProgram(program_id));
+  same_program.reset();
+  EXPECT_FALSE(glIsProgram(program_id));
+  EXPECT_EQ(registry->num_programs(), num_programs + 1);
+  other_program.reset();
+  EXPECT_EQ(registry->num_programs(), num_programs);
+}
+
+TEST_F(ShaderProgramRegistryTest, RegistryReportsInvalidSources) {
+  ShaderProgramRegistry* registry = ShaderProgramRegistry::Get();
+  const int num_programs = registry->num_programs();
+  std::string error_info_log;
+  EXPECT_EQ(registry->GetOrCreate(vertex_shader_src, "asdasdjqw;jdekl",
+                                  &error_info_log),
+            nullptr);
+  EXPECT_GT(error_info_log.size(), 0);
+  EXPECT_EQ(registry->num_programs(), num_programs);
+}
+
+}  // namespace wvu
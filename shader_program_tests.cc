@@ -0,0 +1,703 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <stdlib.h>
+
+// C++ headers.
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+// Shaders that use uniforms of several types.
+const std::string uniform_vertex_shader_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "layout (location = 1) in vec3 normal;\n"
+    "uniform mat4 model;\n"
+    "uniform vec3 offsets[4];\n"
+    "out vec3 shading_normal;\n"
+    "void main() {\n"
+    "shading_normal = normal;\n"
+    "gl_Position = model * vec4(position + offsets[gl_VertexID % 4], 1.0f);\n"
+    "}\n";
+
+const std::string uniform_fragment_shader_src =
+    "#version 330 core\n"
+    "in vec3 shading_normal;\n"
+    "uniform vec4 tint;\n"
+    "uniform float scale;\n"
+    "uniform int mode;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "color = scale * tint + float(mode) * vec4(shading_normal, 0.0f);\n"
+    "}\n";
+
+// Returns true if the driver can store and load program binaries.
+bool IsBinaryCacheSupported() {
+  GLint num_binary_formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_binary_formats);
+  return GLEW_ARB_get_program_binary && num_binary_formats > 0;
+}
+
+// A compute shader that doubles the values of a storage buffer.
+const std::string double_compute_shader_src =
+    "#version 430 core\n"
+    "layout (local_size_x = 64) in;\n"
+    "layout (std430, binding = 2) buffer Values {\n"
+    "  float values[];\n"
+    "};\n"
+    "void main() {\n"
+    "  values[gl_GlobalInvocationID.x] *= 2.0f;\n"
+    "}\n";
+
+// A compute shader that stores 42 into a storage buffer, and an equivalent
+// SPIR-V 1.0 module.
+const std::string store_value_compute_shader_src =
+    "#version 430 core\n"
+    "layout (local_size_x = 1) in;\n"
+    "layout (std430, binding = 0) buffer Value {\n"
+    "  uint value;\n"
+    "};\n"
+    "void main() {\n"
+    "  value = 42u;\n"
+    "}\n";
+const uint32_t store_value_compute_shader_spirv[] = {
+  0x07230203, 0x00010000, 0x00000000, 0x0000000e, 0x00000000, 0x00020011,
+  0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000005,
+  0x0000000b, 0x6e69616d, 0x00000000, 0x00060010, 0x0000000b, 0x00000011,
+  0x00000001, 0x00000001, 0x00000001, 0x00030047, 0x00000004, 0x00000003,
+  0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00040047,
+  0x00000006, 0x00000021, 0x00000000, 0x00040047, 0x0000000a, 0x00000001,
+  0x00000000, 0x00020013, 0x00000001, 0x00030021, 0x00000002, 0x00000001,
+  0x00040015, 0x00000003, 0x00000020, 0x00000000, 0x0003001e, 0x00000004,
+  0x00000003, 0x00040020, 0x00000005, 0x00000002, 0x00000004, 0x0004003b,
+  0x00000005, 0x00000006, 0x00000002, 0x00040020, 0x00000007, 0x00000002,
+  0x00000003, 0x00040015, 0x00000008, 0x00000020, 0x00000001, 0x0004002b,
+  0x00000008, 0x00000009, 0x00000000, 0x00040032, 0x00000003, 0x0000000a,
+  0x0000002a, 0x00050036, 0x00000001, 0x0000000b, 0x00000000, 0x00000002,
+  0x000200f8, 0x0000000c, 0x00050041, 0x00000007, 0x0000000d, 0x00000006,
+  0x00000009, 0x0003003e, 0x0000000d, 0x0000000a, 0x000100fd, 0x00010038
+};
+
+class ShaderProgramTest : public GLTest {};
+
+// Restores the default number of creation timings kept, even if an assertion
+// ends the test early.
+class CreationTimingsLimitRestorer {
+ public:
+  ~CreationTimingsLimitRestorer() {
+    ShaderProgram::SetMaxNumCreationTimings(1024);
+  }
+};
+
+// Enables the binary cache in a new temporary directory. The cache is disabled
+// and the directory removed on destruction, even if an assertion ends the test
+// early.
+class ScopedBinaryCacheDirectory {
+ public:
+  ScopedBinaryCacheDirectory() {
+    char directory[] = "/tmp/shader_binary_cache_XXXXXX";
+    if (mkdtemp(directory) != nullptr) {
+      directory_ = directory;
+      ShaderProgram::SetBinaryCacheDirectory(directory_);
+    }
+  }
+  ~ScopedBinaryCacheDirectory() {
+    ShaderProgram::SetBinaryCacheDirectory("");
+    if (!directory_.empty()) {
+      RemoveDirectory(directory_);
+    }
+  }
+
+  // Returns the directory, or an empty string if it could not be created.
+  const std::string& directory() const {
+    return directory_;
+  }
+
+ private:
+  std::string directory_;
+};
+
+}  // namespace
+
+TEST_F(ShaderProgramTest, LoadsProgramFromBinaryCache) {
+  ScopedBinaryCacheDirectory cache_directory;
+  ASSERT_FALSE(cache_directory.directory().empty());
+
+  // Build a set of programs from the sources and then build them again from
+  // the cache, as a second launch would do. See gl_benchmarks.cc for the time
+  // that the cache saves.
+  constexpr int kNumPrograms = 20;
+  for (const bool warm : { false, true }) {
+    for (int i = 0; i < kNumPrograms; ++i) {
+      ShaderProgram shader_program;
+      shader_program.LoadVertexShaderFromString(vertex_shader_src);
+      shader_program.LoadFragmentShaderFromString(MakeFragmentShaderSource(i));
+      std::string error_info_log;
+      ASSERT_TRUE(shader_program.Create(&error_info_log)) << error_info_log;
+      ASSERT_TRUE(shader_program.Use());
+      EXPECT_GT(shader_program.shader_program_id(), 0);
+      EXPECT_EQ(shader_program.loaded_from_binary_cache(),
+                warm && IsBinaryCacheSupported());
+    }
+  }
+}
+
+TEST_F(ShaderProgramTest, StoresOneCompleteBinaryPerKey) {
+  if (!IsBinaryCacheSupported()) {
+    LOG(INFO) << "Program binaries are not supported; skipping.";
+    return;
+  }
+  ScopedBinaryCacheDirectory cache_directory;
+  ASSERT_FALSE(cache_directory.directory().empty());
+  // Every write goes through its own temporary file, which the rename moves
+  // into place, so only one complete binary per key remains.
+  for (int i = 0; i < 4; ++i) {
+    ShaderProgram shader_program;
+    shader_program.LoadVertexShaderFromString(vertex_shader_src);
+    shader_program.LoadFragmentShaderFromString(
+        MakeFragmentShaderSource(i % 2));
+    ASSERT_TRUE(shader_program.Create(nullptr));
+  }
+  EXPECT_EQ(ListFiles(cache_directory.directory()).size(), 2u);
+}
+
+TEST_F(ShaderProgramTest, FallsBackToSourcesOnCorruptedBinaryCache) {
+  ScopedBinaryCacheDirectory cache_directory;
+  ASSERT_FALSE(cache_directory.directory().empty());
+  {
+    ShaderProgram shader_program;
+    shader_program.LoadVertexShaderFromString(vertex_shader_src);
+    shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+    ASSERT_TRUE(shader_program.Create(nullptr));
+  }
+  // Corrupt every stored binary.
+  for (const std::string& filepath : ListFiles(cache_directory.directory())) {
+    std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+    out << "not a program binary";
+  }
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  std::string error_info_log;
+  EXPECT_TRUE(shader_program.Create(&error_info_log));
+  EXPECT_FALSE(shader_program.loaded_from_binary_cache());
+  EXPECT_GT(shader_program.shader_program_id(), 0);
+}
+
+TEST_F(ShaderProgramTest, CreateProgramsAsynchronously) {
+  constexpr int kNumPrograms = 16;
+  ShaderProgram::SetMaxShaderCompilerThreads(4);
+  std::vector<ShaderProgram> shader_programs(kNumPrograms);
+  // Submit every program before waiting for any of them.
+  for (int i = 0; i < kNumPrograms; ++i) {
+    shader_programs[i].LoadVertexShaderFromString(vertex_shader_src);
+    shader_programs[i].LoadFragmentShaderFromString(
+        MakeFragmentShaderSource(100 + i));
+    shader_programs[i].CreateAsync();
+  }
+  int num_polls = 0;
+  for (ShaderProgram& shader_program : shader_programs) {
+    while (!shader_program.IsReady()) {
+      ++num_polls;
+    }
+    std::string error_info_log;
+    EXPECT_TRUE(shader_program.Finish(&error_info_log)) << error_info_log;
+    EXPECT_GT(shader_program.shader_program_id(), 0);
+    EXPECT_TRUE(shader_program.Use());
+  }
+  LOG(INFO) << "Polled " << num_polls << " times before the programs were "
+            << "ready.";
+}
+
+TEST_F(ShaderProgramTest, CreateProgramAsynchronouslyFromInvalidSources) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(vertex_shader_src + "asdasd;");
+  std::string error_info_log;
+  EXPECT_FALSE(shader_program.Finish(&error_info_log));
+  shader_program.CreateAsync();
+  EXPECT_FALSE(shader_program.Finish(&error_info_log));
+  EXPECT_GT(error_info_log.size(), 0);
+  EXPECT_EQ(shader_program.shader_program_id(), 0);
+  EXPECT_FALSE(shader_program.Use());
+}
+
+TEST_F(ShaderProgramTest, RecordsCreationTimings) {
+  ShaderProgram::ClearCreationTimings();
+  ShaderProgram shader_program;
+  shader_program.set_label("valid");
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  ShaderProgram invalid_program;
+  invalid_program.set_label("invalid");
+  invalid_program.LoadVertexShaderFromString(vertex_shader_src);
+  invalid_program.LoadFragmentShaderFromString("invalid source");
+  ASSERT_FALSE(invalid_program.Create(nullptr));
+  ShaderProgram async_program;
+  async_program.LoadVertexShaderFromString(vertex_shader_src);
+  async_program.LoadFragmentShaderFromString(fragment_shader_src);
+  async_program.CreateAsync();
+  ASSERT_TRUE(async_program.Finish(nullptr));
+
+  const std::vector<ShaderProgram::CreationTiming> creation_timings =
+      ShaderProgram::GetCreationTimings();
+  ASSERT_EQ(creation_timings.size(), 3);
+  const ShaderProgram::CreationTiming& timing = creation_timings[0];
+  EXPECT_EQ(timing.label, "valid");
+  EXPECT_TRUE(timing.created);
+  EXPECT_EQ(timing.source_size,
+            vertex_shader_src.size() + fragment_shader_src.size());
+  EXPECT_GT(timing.vertex_shader_seconds, 0.0);
+  EXPECT_GT(timing.fragment_shader_seconds, 0.0);
+  EXPECT_GT(timing.link_seconds, 0.0);
+  EXPECT_EQ(timing.total_seconds(),
+            shader_program.creation_timing().total_seconds());
+  EXPECT_EQ(creation_timings[1].label, "invalid");
+  EXPECT_FALSE(creation_timings[1].created);
+  EXPECT_TRUE(creation_timings[2].created);
+  EXPECT_GT(creation_timings[2].link_seconds, 0.0);
+
+  // The report lists one line per program, from the slowest to the fastest.
+  const std::string report = ShaderProgram::MakeCreationReport();
+  LOG(INFO) << "\n" << report;
+  EXPECT_NE(report.find("3 programs"), std::string::npos);
+  EXPECT_NE(report.find("invalid (failed)"), std::string::npos);
+  EXPECT_NE(report.find("(unlabeled)"), std::string::npos);
+  std::istringstream lines(report);
+  std::string line;
+  std::getline(lines, line);
+  std::getline(lines, line);
+  double previous_total_ms = std::numeric_limits<double>::max();
+  int num_programs = 0;
+  while (std::getline(lines, line)) {
+    const double total_ms = std::stod(line);
+    EXPECT_LE(total_ms, previous_total_ms);
+    previous_total_ms = total_ms;
+    ++num_programs;
+  }
+  EXPECT_EQ(num_programs, 3);
+}
+
+TEST_F(ShaderProgramTest, KeepsOnlyTheLastCreationTimings) {
+  ShaderProgram::ClearCreationTimings();
+  CreationTimingsLimitRestorer restorer;
+  ShaderProgram::SetMaxNumCreationTimings(2);
+  for (int i = 0; i < 3; ++i) {
+    ShaderProgram shader_program;
+    shader_program.set_label(std::to_string(i));
+    shader_program.LoadVertexShaderFromString(vertex_shader_src);
+    shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+    ASSERT_TRUE(shader_program.Create(nullptr));
+  }
+  std::vector<ShaderProgram::CreationTiming> creation_timings =
+      ShaderProgram::GetCreationTimings();
+  ASSERT_EQ(creation_timings.size(), 2);
+  EXPECT_EQ(creation_timings[0].label, "1");
+  EXPECT_EQ(creation_timings[1].label, "2");
+
+  // Lowering the limit drops the oldest timings, and zero stops recording.
+  ShaderProgram::SetMaxNumCreationTimings(1);
+  creation_timings = ShaderProgram::GetCreationTimings();
+  ASSERT_EQ(creation_timings.size(), 1);
+  EXPECT_EQ(creation_timings[0].label, "2");
+  ShaderProgram::SetMaxNumCreationTimings(0);
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  EXPECT_TRUE(ShaderProgram::GetCreationTimings().empty());
+}
+
+TEST_F(ShaderProgramTest, ReflectsActiveUniformsAndAttributes) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(uniform_vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(uniform_fragment_shader_src);
+  std::string error_info_log;
+  ASSERT_TRUE(shader_program.Create(&error_info_log)) << error_info_log;
+
+  EXPECT_EQ(shader_program.uniforms().size(), 5);
+  const ShaderProgram::UniformHandle offsets_handle =
+      shader_program.GetUniformHandle("offsets");
+  ASSERT_NE(offsets_handle, ShaderProgram::kInvalidUniformHandle);
+  const ShaderProgram::ShaderVariable& offsets =
+      shader_program.uniforms()[offsets_handle];
+  EXPECT_EQ(offsets.type, GL_FLOAT_VEC3);
+  EXPECT_EQ(offsets.size, 4);
+  EXPECT_EQ(offsets.location,
+            glGetUniformLocation(shader_program.shader_program_id(),
+                                 "offsets"));
+  EXPECT_EQ(shader_program.GetUniformHandle("missing"),
+            ShaderProgram::kInvalidUniformHandle);
+
+  EXPECT_EQ(shader_program.attributes().size(), 2);
+  EXPECT_EQ(shader_program.GetAttributeLocation("position"), 0);
+  EXPECT_EQ(shader_program.GetAttributeLocation("normal"), 1);
+  EXPECT_EQ(shader_program.GetAttributeLocation("missing"), -1);
+}
+
+TEST_F(ShaderProgramTest, SetsUniformsByHandle) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(uniform_vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(uniform_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  ASSERT_TRUE(shader_program.Use());
+  const GLuint program_id = shader_program.shader_program_id();
+
+  const Eigen::Matrix4f model = Eigen::Matrix4f::Random();
+  const Eigen::Vector4f tint = Eigen::Vector4f::Random();
+  const ShaderProgram::UniformHandle model_handle =
+      shader_program.GetUniformHandle("model");
+  const ShaderProgram::UniformHandle tint_handle =
+      shader_program.GetUniformHandle("tint");
+  const ShaderProgram::UniformHandle scale_handle =
+      shader_program.GetUniformHandle("scale");
+  const ShaderProgram::UniformHandle mode_handle =
+      shader_program.GetUniformHandle("mode");
+  shader_program.SetUniformMatrix4(model_handle, model.data());
+  shader_program.SetUniformVector4(tint_handle, tint.data());
+  shader_program.SetUniform(scale_handle, 0.25f);
+  shader_program.SetUniform(mode_handle, 3);
+  shader_program.SetUniform(ShaderProgram::kInvalidUniformHandle, 1.0f);
+  EXPECT_EQ(shader_program.FlushUniforms(), 4);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  Eigen::Matrix4f stored_model;
+  glGetUniformfv(program_id, shader_program.uniforms()[model_handle].location,
+                 stored_model.data());
+  EXPECT_TRUE(stored_model == model);
+  Eigen::Vector4f stored_tint;
+  glGetUniformfv(program_id, shader_program.uniforms()[tint_handle].location,
+                 stored_tint.data());
+  EXPECT_TRUE(stored_tint == tint);
+  GLfloat stored_scale = 0.0f;
+  glGetUniformfv(program_id, shader_program.uniforms()[scale_handle].location,
+                 &stored_scale);
+  EXPECT_EQ(stored_scale, 0.25f);
+  GLint stored_mode = 0;
+  glGetUniformiv(program_id, shader_program.uniforms()[mode_handle].location,
+                 &stored_mode);
+  EXPECT_EQ(stored_mode, 3);
+}
+
+TEST_F(ShaderProgramTest, UploadsOnlyChangedUniforms) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(uniform_vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(uniform_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  ASSERT_TRUE(shader_program.Use());
+  const GLuint program_id = shader_program.shader_program_id();
+  const ShaderProgram::UniformHandle model_handle =
+      shader_program.GetUniformHandle("model");
+  const ShaderProgram::UniformHandle scale_handle =
+      shader_program.GetUniformHandle("scale");
+  const ShaderProgram::UniformHandle mode_handle =
+      shader_program.GetUniformHandle("mode");
+
+  // Nothing is uploaded before the flush, and a uniform set twice before a
+  // flush is uploaded once.
+  const Eigen::Matrix4f model = Eigen::Matrix4f::Random();
+  shader_program.SetUniformMatrix4(model_handle, model.data());
+  shader_program.SetUniform(scale_handle, 0.5f);
+  shader_program.SetUniform(scale_handle, 0.75f);
+  shader_program.SetUniform(mode_handle, 1);
+  EXPECT_EQ(shader_program.num_uniform_uploads(), 0);
+  EXPECT_EQ(shader_program.FlushUniforms(), 3);
+  EXPECT_EQ(shader_program.num_uniform_uploads(), 3);
+
+  // Simulate frames that set the same values every frame and only change the
+  // scale.
+  constexpr int kNumFrames = 10;
+  shader_program.ResetUniformCounters();
+  for (int i = 0; i < kNumFrames; ++i) {
+    shader_program.SetUniformMatrix4(model_handle, model.data());
+    shader_program.SetUniform(scale_handle, static_cast<GLfloat>(i));
+    shader_program.SetUniform(mode_handle, 1);
+    shader_program.FlushUniforms();
+  }
+  EXPECT_EQ(shader_program.num_uniform_uploads(), kNumFrames);
+  EXPECT_EQ(shader_program.num_skipped_uniform_uploads(), 2 * kNumFrames);
+  EXPECT_EQ(shader_program.FlushUniforms(), 0);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  GLfloat stored_scale = 0.0f;
+  glGetUniformfv(program_id, shader_program.uniforms()[scale_handle].location,
+                 &stored_scale);
+  EXPECT_EQ(stored_scale, kNumFrames - 1);
+  Eigen::Matrix4f stored_model;
+  glGetUniformfv(program_id, shader_program.uniforms()[model_handle].location,
+                 stored_model.data());
+  EXPECT_TRUE(stored_model == model);
+}
+
+TEST_F(ShaderProgramTest, IgnoresOutOfRangeUniformHandles) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(uniform_vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(uniform_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  ASSERT_TRUE(shader_program.Use());
+  const ShaderProgram::UniformHandle scale_handle =
+      shader_program.GetUniformHandle("scale");
+  const GLfloat identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+                                 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+                                 0.0f, 1.0f };
+  const int num_uniforms = static_cast<int>(shader_program.uniforms().size());
+  for (const ShaderProgram::UniformHandle handle :
+           { -2, num_uniforms, num_uniforms + 100 }) {
+    shader_program.SetUniform(handle, 1.0f);
+    shader_program.SetUniformMatrix4(handle, identity);
+  }
+  EXPECT_EQ(shader_program.FlushUniforms(), 0);
+
+  // A handle kept after the program is moved refers to nothing in the
+  // moved-from instance.
+  ShaderProgram moved_program(std::move(shader_program));
+  shader_program.SetUniform(scale_handle, 0.5f);
+  EXPECT_EQ(shader_program.FlushUniforms(), 0);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(ShaderProgramTest, SkipsRedundantProgramBinds) {
+  ShaderProgram first_program;
+  first_program.LoadVertexShaderFromString(vertex_shader_src);
+  first_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(first_program.Create(nullptr));
+  ShaderProgram second_program;
+  second_program.LoadVertexShaderFromString(vertex_shader_src);
+  second_program.LoadFragmentShaderFromString(MakeFragmentShaderSource(3));
+  ASSERT_TRUE(second_program.Create(nullptr));
+
+  ShaderProgram::InvalidateCurrentProgram();
+  ShaderProgram::ResetProgramBindCounters();
+  // Simulate frames that use the same program many times.
+  constexpr int kNumFrames = 10;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EXPECT_TRUE(first_program.Use());
+    EXPECT_TRUE(first_program.Use());
+  }
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 1);
+  EXPECT_EQ(ShaderProgram::num_program_binds_skipped(), 2 * kNumFrames - 1);
+  GLint current_program = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+  EXPECT_EQ(current_program, first_program.shader_program_id());
+
+  EXPECT_TRUE(second_program.Use());
+  EXPECT_TRUE(first_program.Use());
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 3);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+  EXPECT_EQ(current_program, first_program.shader_program_id());
+
+  // Binding behind the back of the class requires an invalidation.
+  glUseProgram(0);
+  ShaderProgram::InvalidateCurrentProgram();
+  EXPECT_TRUE(first_program.Use());
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 4);
+}
+
+TEST_F(ShaderProgramTest, ForgetsDeletedProgramInUse) {
+  ShaderProgram::InvalidateCurrentProgram();
+  ShaderProgram::ResetProgramBindCounters();
+  for (int i = 0; i < 2; ++i) {
+    // Programs created one after another may get the same id once the
+    // previous one is deleted, so every Use() must bind.
+    ShaderProgram shader_program;
+    shader_program.LoadVertexShaderFromString(vertex_shader_src);
+    shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+    ASSERT_TRUE(shader_program.Create(nullptr));
+    EXPECT_TRUE(shader_program.Use());
+  }
+  EXPECT_EQ(ShaderProgram::num_program_binds_issued(), 2);
+  EXPECT_EQ(ShaderProgram::num_program_binds_skipped(), 0);
+}
+
+TEST_F(ShaderProgramTest, MovesProgramOwnership) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(uniform_vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(uniform_fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+  const GLuint program_id = shader_program.shader_program_id();
+
+  ShaderProgram moved_program(std::move(shader_program));
+  EXPECT_EQ(moved_program.shader_program_id(), program_id);
+  EXPECT_EQ(moved_program.uniforms().size(), 5);
+  EXPECT_EQ(shader_program.shader_program_id(), 0);
+  EXPECT_TRUE(shader_program.uniforms().empty());
+
+  // Programs kept by value survive the growth of a vector.
+  std::vector<ShaderProgram> programs;
+  programs.push_back(std::move(moved_program));
+  for (int i = 0; i < 8; ++i) {
+    programs.emplace_back();
+  }
+  EXPECT_EQ(programs[0].shader_program_id(), program_id);
+  EXPECT_TRUE(glIsProgram(program_id));
+  EXPECT_TRUE(programs[0].Use());
+  // OpenGL defers deleting the program in use.
+  glUseProgram(0);
+  ShaderProgram::InvalidateCurrentProgram();
+
+  // Move assignment deletes the program it replaces.
+  programs[0] = ShaderProgram();
+  EXPECT_EQ(programs[0].shader_program_id(), 0);
+  EXPECT_FALSE(glIsProgram(program_id));
+}
+
+TEST_F(ShaderProgramTest, DispatchesComputePrograms) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  ShaderProgram compute_program;
+  compute_program.LoadComputeShaderFromString(double_compute_shader_src);
+  EXPECT_TRUE(compute_program.is_compute());
+  std::string error_info_log;
+  ASSERT_TRUE(compute_program.Create(&error_info_log)) << error_info_log;
+  GLint work_group_size[3];
+  compute_program.GetComputeWorkGroupSize(work_group_size);
+  EXPECT_EQ(work_group_size[0], 64);
+  EXPECT_EQ(work_group_size[1], 1);
+  EXPECT_EQ(work_group_size[2], 1);
+  EXPECT_EQ(compute_program.GetShaderStorageBlockBinding("Values"), 2);
+  EXPECT_EQ(compute_program.GetShaderStorageBlockBinding("Missing"), -1);
+
+  constexpr int kNumValues = 256;
+  std::vector<float> values(kNumValues);
+  std::iota(values.begin(), values.end(), 0.0f);
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, kNumValues * sizeof(float),
+               values.data(), GL_DYNAMIC_COPY);
+  ShaderProgram::BindShaderStorageBuffer(2, buffer);
+  ASSERT_TRUE(compute_program.Dispatch(kNumValues / 64));
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  std::vector<float> doubled_values(kNumValues);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, kNumValues * sizeof(float),
+                     doubled_values.data());
+  for (int i = 0; i < kNumValues; ++i) {
+    EXPECT_EQ(doubled_values[i], 2.0f * values[i]);
+  }
+
+  // Dispatches beyond the limit of the driver are refused, not launched.
+  GLuint max_num_groups[3];
+  ShaderProgram::GetMaxComputeWorkGroupCount(max_num_groups);
+  EXPECT_GE(max_num_groups[0], 65535);
+  if (max_num_groups[0] < std::numeric_limits<GLuint>::max()) {
+    EXPECT_FALSE(compute_program.Dispatch(max_num_groups[0] + 1));
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(ShaderProgramTest, RejectsComputeProgramsWithOtherShaders) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadComputeShaderFromString(double_compute_shader_src);
+  std::string error_info_log;
+  EXPECT_FALSE(shader_program.Create(&error_info_log));
+  EXPECT_FALSE(error_info_log.empty());
+  EXPECT_FALSE(shader_program.Dispatch(1));
+
+  // Graphics programs cannot be dispatched.
+  ShaderProgram graphics_program;
+  graphics_program.LoadVertexShaderFromString(vertex_shader_src);
+  graphics_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(graphics_program.Create(nullptr));
+  EXPECT_FALSE(graphics_program.Dispatch(1));
+}
+
+TEST_F(ShaderProgramTest, CreatesProgramsFromSpirv) {
+  if (!IsComputeSupported()) {
+    LOG(INFO) << "Compute shaders are not supported; skipping.";
+    return;
+  }
+  const std::string spirv_module(
+      reinterpret_cast<const char*>(store_value_compute_shader_spirv),
+      sizeof(store_value_compute_shader_spirv));
+  ShaderProgram compute_program;
+  EXPECT_FALSE(compute_program.LoadSpirvShader(GL_COMPUTE_SHADER,
+                                               "not a module"));
+  EXPECT_FALSE(compute_program.LoadSpirvShader(GL_GEOMETRY_SHADER,
+                                               spirv_module));
+  ASSERT_TRUE(compute_program.LoadSpirvShader(GL_COMPUTE_SHADER,
+                                              spirv_module));
+  EXPECT_TRUE(compute_program.is_compute());
+  // The GLSL source is compiled when the context lacks ARB_gl_spirv.
+  compute_program.LoadComputeShaderFromString(store_value_compute_shader_src);
+  EXPECT_EQ(compute_program.uses_spirv(), GLEW_ARB_gl_spirv != GL_FALSE);
+  std::string error_info_log;
+  ASSERT_TRUE(compute_program.Create(&error_info_log)) << error_info_log;
+
+  GLuint buffer = 0;
+  const GLuint zero = 0;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), &zero, GL_DYNAMIC_COPY);
+  ShaderProgram::BindShaderStorageBuffer(0, buffer);
+  ASSERT_TRUE(compute_program.Dispatch(1));
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  GLuint value = 0;
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(value), &value);
+  EXPECT_EQ(value, 42);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  // Without a GLSL fallback, SPIR-V modules for only some of the shaders are
+  // rejected.
+  ShaderProgram partial_program;
+  partial_program.LoadVertexShaderFromString(vertex_shader_src);
+  ASSERT_TRUE(partial_program.LoadSpirvShader(GL_FRAGMENT_SHADER,
+                                              spirv_module));
+  EXPECT_FALSE(partial_program.uses_spirv());
+  EXPECT_FALSE(partial_program.Create(&error_info_log));
+  EXPECT_FALSE(error_info_log.empty());
+}
+
+}  // namespace wvu
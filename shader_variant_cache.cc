@@ -0,0 +1,84 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "shader_variant_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace wvu {
+
+ShaderVariantCache::ShaderVariantCache(const ShaderPreprocessor& preprocessor,
+                                       const std::string& vertex_shader_src,
+                                       const std::string& fragment_shader_src)
+    : preprocessor_(preprocessor),
+      vertex_shader_src_(vertex_shader_src),
+      fragment_shader_src_(fragment_shader_src) {}
+
+ShaderProgram* ShaderVariantCache::GetVariant(const ShaderDefines& defines,
+                                              std::string* error_info_log) {
+  return GetVariant(defines, ShaderConstants(), error_info_log);
+}
+
+ShaderProgram* ShaderVariantCache::GetVariant(const ShaderDefines& defines,
+                                              const ShaderConstants& constants,
+                                              std::string* error_info_log) {
+  // Every definition adds a line to its key, so the empty line separates the
+  // definitions from the constants.
+  const std::string key = MakeShaderDefinesKey(defines) + "\n" +
+      MakeShaderDefinesKey(constants);
+  auto variant = variants_.find(key);
+  if (variant == variants_.end()) {
+    Variant new_variant;
+    new_variant.program.reset(new ShaderProgram);
+    ShaderProgram* program = new_variant.program.get();
+    program->LoadVertexShaderFromString(vertex_shader_src_);
+    program->LoadFragmentShaderFromString(fragment_shader_src_);
+    if (!program->PreprocessShaders(preprocessor_, defines,
+                                    &new_variant.error_info_log) ||
+        (!constants.empty() &&
+         !program->BakeConstants(constants, &new_variant.error_info_log)) ||
+        !program->Create(&new_variant.error_info_log)) {
+      new_variant.program.reset();
+    }
+    variant = variants_.emplace(key, std::move(new_variant)).first;
+  }
+  if (!variant->second.program && error_info_log) {
+    *error_info_log = variant->second.error_info_log;
+  }
+  return variant->second.program.get();
+}
+
+}  // namespace wvu
@@ -0,0 +1,122 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_SHADER_VARIANT_CACHE_H_
+#define GLUTILS_SHADER_VARIANT_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "shader_preprocessor.h"
+#include "shader_program.h"
+
+namespace wvu {
+// This class builds the variants of a program lazily. A variant is the program
+// that results from preprocessing the vertex and fragment sources with a set
+// of definitions and, optionally, from baking a set of uniforms as constants,
+// see ShaderProgram::BakeConstants(). Instead of one source per feature
+// combination, a single source selects its features with #ifdef, and only the
+// combinations that are requested are ever compiled. Every variant is built
+// the first time it is requested and kept, keyed by its sets of definitions
+// and constants, until the cache is destroyed. Failures are kept too, so a
+// broken variant is not compiled again every frame. The class is not
+// thread-safe; use it from the thread that has the context current.
+//
+// Example.
+//
+// wvu::ShaderVariantCache variants(preprocessor, vertex_shader_src,
+//                                  fragment_shader_src);
+// while (...) {  // Rendering loop.
+//   wvu::ShaderDefines defines;
+//   if (use_lighting) defines["USE_LIGHTING"] = "";
+//   wvu::ShaderProgram* shader_program =
+//       variants.GetVariant(defines, &error_info_log);
+//   ...
+// }
+class ShaderVariantCache {
+ public:
+  // Parameters:
+  //   preprocessor  The preprocessor that knows the include sources. It is
+  //     copied.
+  //   vertex_shader_src  The vertex shader source, before preprocessing.
+  //   fragment_shader_src  The fragment shader source, before preprocessing.
+  ShaderVariantCache(const ShaderPreprocessor& preprocessor,
+                     const std::string& vertex_shader_src,
+                     const std::string& fragment_shader_src);
+
+  // Returns the variant for the definitions, building it on the first request.
+  // Returns a null pointer if the variant cannot be built, in which case
+  // error_info_log holds the error log. The program is owned by the cache.
+  //
+  // Parameters:
+  //   defines  The definitions of the variant.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  ShaderProgram* GetVariant(const ShaderDefines& defines,
+                            std::string* error_info_log);
+
+  // Returns the variant for the definitions whose uniforms in constants are
+  // baked with the given values, building it on the first request.
+  //
+  // Parameters:
+  //   defines  The definitions of the variant.
+  //   constants  The values of the uniforms to bake.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  ShaderProgram* GetVariant(const ShaderDefines& defines,
+                            const ShaderConstants& constants,
+                            std::string* error_info_log);
+
+  // Returns the number of variants built so far, including the failed ones.
+  int num_variants() const {
+    return static_cast<int>(variants_.size());
+  }
+
+ private:
+  // A built variant. The program is null if the variant failed to build.
+  struct Variant {
+    std::unique_ptr<ShaderProgram> program;
+    std::string error_info_log;
+  };
+
+  const ShaderPreprocessor preprocessor_;
+  const std::string vertex_shader_src_;
+  const std::string fragment_shader_src_;
+  // Variants by the keys of their definitions and constants, see
+  // MakeShaderDefinesKey().
+  std::unordered_map<std::string, Variant> variants_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_SHADER_VARIANT_CACHE_H_
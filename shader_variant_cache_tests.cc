@@ -0,0 +1,197 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <cmath>
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_preprocessor.h"
+#include "shader_program.h"
+#include "shader_variant_cache.h"
+#include "test/gl_test.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+// Draws a triangle that covers the viewport with the program and reads the
+// image into pixels.
+void DrawFullscreenFrame(ShaderProgram* shader_program,
+                         const int width,
+                         const int height,
+                         std::vector<unsigned char>* pixels) {
+  shader_program->Use();
+  shader_program->FlushUniforms();
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  pixels->resize(4 * width * height);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+}
+
+class ShaderVariantCacheTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(ShaderVariantCacheTest, BuildsShaderVariantsLazily) {
+  ShaderPreprocessor preprocessor;
+  preprocessor.AddIncludeSource(
+      "tint.glsl",
+      "uniform vec4 tint;\n"
+      "vec4 Tint(vec4 color) { return tint * color; }\n");
+  ShaderVariantCache variants(preprocessor, vertex_shader_src,
+                              "#version 330 core\n"
+                              "#ifdef USE_TINT\n"
+                              "#include \"tint.glsl\"\n"
+                              "#endif\n"
+                              "out vec4 color;\n"
+                              "void main() {\n"
+                              "color = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+                              "#ifdef USE_TINT\n"
+                              "color = Tint(color);\n"
+                              "#endif\n"
+                              "#ifdef BROKEN\n"
+                              "color = undeclared;\n"
+                              "#endif\n"
+                              "}\n");
+  EXPECT_EQ(variants.num_variants(), 0);
+
+  std::string error_info_log;
+  ShaderDefines defines;
+  ShaderProgram* plain_program = variants.GetVariant(defines, &error_info_log);
+  ASSERT_NE(plain_program, nullptr) << error_info_log;
+  EXPECT_EQ(plain_program->GetUniformHandle("tint"),
+            ShaderProgram::kInvalidUniformHandle);
+  defines["USE_TINT"] = "";
+  ShaderProgram* tint_program = variants.GetVariant(defines, &error_info_log);
+  ASSERT_NE(tint_program, nullptr) << error_info_log;
+  EXPECT_NE(tint_program, plain_program);
+  EXPECT_NE(tint_program->GetUniformHandle("tint"),
+            ShaderProgram::kInvalidUniformHandle);
+  EXPECT_EQ(variants.num_variants(), 2);
+
+  // Requesting a variant again does not build anything.
+  EXPECT_EQ(variants.GetVariant(defines, &error_info_log), tint_program);
+  EXPECT_EQ(variants.GetVariant(ShaderDefines(), &error_info_log),
+            plain_program);
+  EXPECT_EQ(variants.num_variants(), 2);
+
+  // A broken variant fails every time it is requested.
+  defines["BROKEN"] = "";
+  for (int i = 0; i < 2; ++i) {
+    error_info_log.clear();
+    EXPECT_EQ(variants.GetVariant(defines, &error_info_log), nullptr);
+    EXPECT_FALSE(error_info_log.empty());
+  }
+  EXPECT_EQ(variants.num_variants(), 3);
+}
+
+TEST_F(ShaderVariantCacheTest, BakesUniformsIntoVariants) {
+  ShaderVariantCache variants(ShaderPreprocessor(),
+                              fullscreen_vertex_shader_src,
+                              lights_fragment_shader_src);
+  std::string error_info_log;
+  ShaderProgram* uniform_program =
+      variants.GetVariant(ShaderDefines(), &error_info_log);
+  ASSERT_NE(uniform_program, nullptr) << error_info_log;
+  ShaderConstants constants;
+  constants["num_lights"] = "8";
+  constants["use_fog"] = "true";
+  ShaderProgram* baked_program =
+      variants.GetVariant(ShaderDefines(), constants, &error_info_log);
+  ASSERT_NE(baked_program, nullptr) << error_info_log;
+  EXPECT_NE(baked_program, uniform_program);
+  EXPECT_EQ(variants.GetVariant(ShaderDefines(), constants, &error_info_log),
+            baked_program);
+  EXPECT_EQ(variants.num_variants(), 2);
+  // Baked uniforms are no longer active.
+  EXPECT_EQ(baked_program->GetUniformHandle("num_lights"),
+            ShaderProgram::kInvalidUniformHandle);
+  EXPECT_EQ(baked_program->GetUniformHandle("use_fog"),
+            ShaderProgram::kInvalidUniformHandle);
+  EXPECT_NE(baked_program->GetUniformHandle("fog_density"),
+            ShaderProgram::kInvalidUniformHandle);
+
+  // A constant must name a uniform declaration.
+  ShaderConstants unknown_constants;
+  unknown_constants["num_shadows"] = "2";
+  EXPECT_EQ(variants.GetVariant(ShaderDefines(), unknown_constants,
+                                &error_info_log), nullptr);
+  EXPECT_NE(error_info_log.find("num_shadows"), std::string::npos);
+
+  constexpr int kSize = 256;
+  GLuint texture = 0, framebuffer = 0, vertex_array = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kSize, kSize, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  ASSERT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER), GL_FRAMEBUFFER_COMPLETE);
+  glGenVertexArrays(1, &vertex_array);
+  glBindVertexArray(vertex_array);
+  glViewport(0, 0, kSize, kSize);
+
+  uniform_program->SetUniform(uniform_program->GetUniformHandle("num_lights"),
+                              8);
+  uniform_program->SetUniform(uniform_program->GetUniformHandle("use_fog"), 1);
+  uniform_program->SetUniform(
+      uniform_program->GetUniformHandle("fog_density"), 0.25f);
+  baked_program->SetUniform(baked_program->GetUniformHandle("fog_density"),
+                            0.25f);
+  std::vector<unsigned char> uniform_pixels, baked_pixels;
+  DrawFullscreenFrame(uniform_program, kSize, kSize, &uniform_pixels);
+  DrawFullscreenFrame(baked_program, kSize, kSize, &baked_pixels);
+  // Both variants produce the same image.
+  ASSERT_EQ(uniform_pixels.size(), baked_pixels.size());
+  int num_different_values = 0;
+  for (size_t i = 0; i < uniform_pixels.size(); ++i) {
+    if (std::abs(uniform_pixels[i] - baked_pixels[i]) > 1) {
+      ++num_different_values;
+    }
+  }
+  EXPECT_EQ(num_different_values, 0);
+  EXPECT_GT(uniform_pixels[0], 0);
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindVertexArray(0);
+  glDeleteVertexArrays(1, &vertex_array);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+}
+
+}  // namespace wvu
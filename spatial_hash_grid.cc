@@ -0,0 +1,285 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "spatial_hash_grid.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <Eigen/Core>
+
+namespace wvu {
+namespace {
+// Below this number of points per thread, spawning threads costs more than
+// the work it saves.
+constexpr int kMinNumPointsPerThread = 16384;
+
+// Number of buckets a query can visit without allocating memory.
+constexpr int kMaxNumLocalBuckets = 27;
+
+// Number of distances checked per SIMD batch in the queries.
+constexpr int kNumPointsPerBatch = 8;
+
+// Largest magnitude of a cell coordinate, so that the extent of a cell range
+// fits in an int.
+constexpr float kMaxCellCoordinate = 1 << 29;
+
+// Runs function(thread_index) on num_threads threads and waits for all of
+// them. The calling thread runs the index zero.
+template <typename Function>
+void ParallelFor(const int num_threads, const Function& function) {
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int thread_index = 1; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back(function, thread_index);
+  }
+  function(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// Returns the first element of the range_index-th of num_ranges equal ranges
+// over [0, num_elements).
+int RangeBegin(const int num_elements,
+               const int range_index,
+               const int num_ranges) {
+  return static_cast<int64_t>(num_elements) * range_index / num_ranges;
+}
+
+}  // namespace
+
+SpatialHashGrid::SpatialHashGrid(const float cell_size, const int num_threads)
+    : cell_size_(cell_size),
+      inverse_cell_size_(1.0f / cell_size),
+      num_threads_(num_threads > 0 ?
+                   num_threads :
+                   std::max<int>(1, std::thread::hardware_concurrency())),
+      bucket_mask_(0),
+      bucket_starts_(2, 0) {}
+
+int SpatialHashGrid::HashCell(const int x, const int y, const int z) const {
+  const uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^
+      static_cast<uint32_t>(y) * 19349663u ^
+      static_cast<uint32_t>(z) * 83492791u;
+  return static_cast<int>(hash & bucket_mask_);
+}
+
+int SpatialHashGrid::CellCoordinate(const float coordinate) const {
+  const float cell = std::floor(coordinate * inverse_cell_size_);
+  // Casting a NaN or a value outside of int is undefined. Far away coordinates
+  // are clamped, so they share the outermost cells, which keeps the results
+  // exact since the queries check the distances.
+  if (std::isnan(cell)) {
+    return 0;
+  }
+  return static_cast<int>(
+      std::min(std::max(cell, -kMaxCellCoordinate), kMaxCellCoordinate));
+}
+
+void SpatialHashGrid::Build(const std::vector<Eigen::Vector3f>& positions) {
+  const int num_points = positions.size();
+  // Use as many buckets as points, rounded to a power of two, so that the
+  // hash can be reduced with a mask.
+  int num_buckets = 1;
+  while (num_buckets < num_points) {
+    num_buckets <<= 1;
+  }
+  bucket_mask_ = num_buckets - 1;
+  const int num_threads = std::max(
+      1, std::min(num_threads_, num_points / kMinNumPointsPerThread));
+
+  // 1. Compute the bucket of every point and a histogram per thread.
+  point_buckets_.resize(num_points);
+  thread_counts_.assign(static_cast<size_t>(num_threads) * num_buckets, 0);
+  ParallelFor(num_threads, [&](const int thread_index) {
+    int* counts = &thread_counts_[static_cast<size_t>(thread_index) *
+                                  num_buckets];
+    const int end = RangeBegin(num_points, thread_index + 1, num_threads);
+    for (int i = RangeBegin(num_points, thread_index, num_threads);
+         i < end; ++i) {
+      const Eigen::Vector3f& position = positions[i];
+      const int bucket = HashCell(CellCoordinate(position.x()),
+                                  CellCoordinate(position.y()),
+                                  CellCoordinate(position.z()));
+      point_buckets_[i] = bucket;
+      ++counts[bucket];
+    }
+  });
+
+  // 2. Exclusive prefix sum over the histograms in bucket-major order. Every
+  // thread first adds up its own range of buckets, then the range totals are
+  // scanned, and finally every thread writes the offsets of its range. After
+  // this step thread_counts_ holds where every thread writes its points of
+  // each bucket.
+  std::vector<int> range_offsets(num_threads + 1, 0);
+  ParallelFor(num_threads, [&](const int thread_index) {
+    const int end = RangeBegin(num_buckets, thread_index + 1, num_threads);
+    int total = 0;
+    for (int bucket = RangeBegin(num_buckets, thread_index, num_threads);
+         bucket < end; ++bucket) {
+      for (int t = 0; t < num_threads; ++t) {
+        total += thread_counts_[static_cast<size_t>(t) * num_buckets + bucket];
+      }
+    }
+    range_offsets[thread_index + 1] = total;
+  });
+  for (int t = 0; t < num_threads; ++t) {
+    range_offsets[t + 1] += range_offsets[t];
+  }
+  bucket_starts_.resize(num_buckets + 1);
+  bucket_starts_[num_buckets] = num_points;
+  ParallelFor(num_threads, [&](const int thread_index) {
+    const int end = RangeBegin(num_buckets, thread_index + 1, num_threads);
+    int offset = range_offsets[thread_index];
+    for (int bucket = RangeBegin(num_buckets, thread_index, num_threads);
+         bucket < end; ++bucket) {
+      bucket_starts_[bucket] = offset;
+      for (int t = 0; t < num_threads; ++t) {
+        int& count =
+            thread_counts_[static_cast<size_t>(t) * num_buckets + bucket];
+        const int num_bucket_points = count;
+        count = offset;
+        offset += num_bucket_points;
+      }
+    }
+  });
+
+  // 3. Scatter the points into their buckets. Points keep their original
+  // relative order inside a bucket.
+  point_indices_.resize(num_points);
+  x_.resize(num_points);
+  y_.resize(num_points);
+  z_.resize(num_points);
+  ParallelFor(num_threads, [&](const int thread_index) {
+    int* offsets = &thread_counts_[static_cast<size_t>(thread_index) *
+                                   num_buckets];
+    const int end = RangeBegin(num_points, thread_index + 1, num_threads);
+    for (int i = RangeBegin(num_points, thread_index, num_threads);
+         i < end; ++i) {
+      const int destination = offsets[point_buckets_[i]]++;
+      point_indices_[destination] = i;
+      x_[destination] = positions[i].x();
+      y_[destination] = positions[i].y();
+      z_[destination] = positions[i].z();
+    }
+  });
+}
+
+void SpatialHashGrid::FindNeighbors(const Eigen::Vector3f& query,
+                                    const float radius,
+                                    std::vector<int>* neighbors) const {
+  neighbors->clear();
+  if (point_indices_.empty() || !(radius >= 0.0f)) {
+    return;
+  }
+  // Collect the buckets of the cells overlapping the bounding box of the
+  // query sphere. Different cells may hash to the same bucket, so duplicates
+  // are removed to report every point once.
+  const int min_x = CellCoordinate(query.x() - radius);
+  const int min_y = CellCoordinate(query.y() - radius);
+  const int min_z = CellCoordinate(query.z() - radius);
+  const int max_x = CellCoordinate(query.x() + radius);
+  const int max_y = CellCoordinate(query.y() + radius);
+  const int max_z = CellCoordinate(query.z() + radius);
+  // Count the cells in 64 bits, saturating above the number of buckets since
+  // the product of the extents overflows even 64 bits for huge radii.
+  int64_t num_cells = 1;
+  for (const int extent :
+           { max_x - min_x + 1, max_y - min_y + 1, max_z - min_z + 1 }) {
+    num_cells = std::min<int64_t>(num_cells * extent, num_buckets() + 1);
+  }
+
+  // Appends the points in [i, end) that are within radius of the query.
+  typedef Eigen::Array<float, kNumPointsPerBatch, 1> BatchArray;
+  const float squared_radius = radius * radius;
+  const auto check_points = [&](int i, const int end) {
+    // Check kNumPointsPerBatch distances at once.
+    for (; i + kNumPointsPerBatch <= end; i += kNumPointsPerBatch) {
+      const BatchArray squared_distances =
+          (Eigen::Map<const BatchArray>(&x_[i]) - query.x()).square() +
+          (Eigen::Map<const BatchArray>(&y_[i]) - query.y()).square() +
+          (Eigen::Map<const BatchArray>(&z_[i]) - query.z()).square();
+      for (int j = 0; j < kNumPointsPerBatch; ++j) {
+        if (squared_distances[j] <= squared_radius) {
+          neighbors->push_back(point_indices_[i + j]);
+        }
+      }
+    }
+    for (; i < end; ++i) {
+      const float dx = x_[i] - query.x();
+      const float dy = y_[i] - query.y();
+      const float dz = z_[i] - query.z();
+      if (dx * dx + dy * dy + dz * dz <= squared_radius) {
+        neighbors->push_back(point_indices_[i]);
+      }
+    }
+  };
+  // When there are at least as many cells as buckets, every bucket is likely
+  // visited, so all the points are checked at once. The buckets are
+  // contiguous.
+  if (num_cells >= num_buckets()) {
+    check_points(0, num_points());
+    return;
+  }
+
+  // Queries with a radius up to the cell size touch at most 27 cells, so the
+  // common case avoids allocating memory.
+  int local_buckets[kMaxNumLocalBuckets];
+  std::vector<int> allocated_buckets;
+  int* buckets = local_buckets;
+  if (num_cells > kMaxNumLocalBuckets) {
+    allocated_buckets.resize(num_cells);
+    buckets = allocated_buckets.data();
+  }
+  int num_cell_buckets = 0;
+  for (int x = min_x; x <= max_x; ++x) {
+    for (int y = min_y; y <= max_y; ++y) {
+      for (int z = min_z; z <= max_z; ++z) {
+        buckets[num_cell_buckets++] = HashCell(x, y, z);
+      }
+    }
+  }
+  std::sort(buckets, buckets + num_cell_buckets);
+  num_cell_buckets =
+      std::unique(buckets, buckets + num_cell_buckets) - buckets;
+  for (int k = 0; k < num_cell_buckets; ++k) {
+    check_points(bucket_starts_[buckets[k]], bucket_starts_[buckets[k] + 1]);
+  }
+}
+
+}  // namespace wvu
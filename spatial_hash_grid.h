@@ -0,0 +1,118 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef WVU_SPATIAL_HASH_GRID_H_
+#define WVU_SPATIAL_HASH_GRID_H_
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace wvu {
+// This class answers radius queries over a set of 3d points that may move
+// every frame. Space is split into cubic cells of the same size and every cell
+// is hashed into a bucket. Rebuilding the grid is a parallel counting sort of
+// the points by bucket, so it is cheap enough to be done every frame. The
+// points of a bucket are stored contiguously in a structure of arrays, which
+// lets queries check several distances per SIMD instruction.
+//
+// Example.
+//
+// wvu::SpatialHashGrid grid(kInteractionRadius);
+// while (...) {  // Simulation loop.
+//   ...
+//   grid.Build(positions);
+//   std::vector<int> neighbors;
+//   grid.FindNeighbors(positions[i], kInteractionRadius, &neighbors);
+//   ...
+// }
+class SpatialHashGrid {
+ public:
+  // Creates a grid with cubic cells of edge cell_size. Queries are fastest when
+  // the radius is close to the cell size. When num_threads is zero, the grid
+  // uses as many threads as hardware threads.
+  explicit SpatialHashGrid(const float cell_size, const int num_threads = 0);
+  ~SpatialHashGrid() {}
+
+  // Rebuilds the grid from the positions. The positions are copied, so the
+  // vector may change after this call.
+  void Build(const std::vector<Eigen::Vector3f>& positions);
+
+  // Stores in neighbors the indices of the points that are within radius of
+  // query. The previous contents of neighbors are removed.
+  void FindNeighbors(const Eigen::Vector3f& query,
+                     const float radius,
+                     std::vector<int>* neighbors) const;
+
+  // Returns the number of points in the grid.
+  int num_points() const {
+    return static_cast<int>(point_indices_.size());
+  }
+
+  // Returns the number of buckets in the grid.
+  int num_buckets() const {
+    return static_cast<int>(bucket_starts_.size()) - 1;
+  }
+
+ protected:
+  // Returns the bucket of the cell with integer coordinates (x, y, z).
+  int HashCell(const int x, const int y, const int z) const;
+  // Returns the integer coordinate of the cell that contains coordinate.
+  int CellCoordinate(const float coordinate) const;
+
+ private:
+  // Edge of the cells and its inverse.
+  const float cell_size_;
+  const float inverse_cell_size_;
+  // Number of threads used to rebuild the grid.
+  const int num_threads_;
+  // Mask applied to the hash. The number of buckets is a power of two.
+  int bucket_mask_;
+  // The points of bucket b are in [bucket_starts_[b], bucket_starts_[b + 1]).
+  std::vector<int> bucket_starts_;
+  // Original index of every point, sorted by bucket.
+  std::vector<int> point_indices_;
+  // Coordinates of the points, sorted by bucket.
+  Eigen::ArrayXf x_;
+  Eigen::ArrayXf y_;
+  Eigen::ArrayXf z_;
+  // Bucket of every point in the original order. Kept to avoid reallocating
+  // it every frame.
+  std::vector<int> point_buckets_;
+  // Per-thread histograms of the buckets, num_threads_ x num_buckets.
+  std::vector<int> thread_counts_;
+};
+
+}  // namespace wvu
+
+#endif  // WVU_SPATIAL_HASH_GRID_H_
@@ -0,0 +1,177 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <algorithm>  // For std::sort.
+#include <chrono>  // For timing the rebuild and the queries.
+#include <limits>
+#include <vector>
+
+// System specific headers.
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "spatial_hash_grid.h"
+
+namespace wvu {
+namespace {
+// Returns the indices of the points within radius of query by brute force.
+std::vector<int> FindNeighborsByBruteForce(
+    const std::vector<Eigen::Vector3f>& positions,
+    const Eigen::Vector3f& query,
+    const float radius) {
+  std::vector<int> neighbors;
+  for (int i = 0; i < static_cast<int>(positions.size()); ++i) {
+    if ((positions[i] - query).squaredNorm() <= radius * radius) {
+      neighbors.push_back(i);
+    }
+  }
+  return neighbors;
+}
+
+std::vector<Eigen::Vector3f> MakeRandomPositions(const int num_points) {
+  std::vector<Eigen::Vector3f> positions(num_points);
+  for (Eigen::Vector3f& position : positions) {
+    position = 10.0f * Eigen::Vector3f::Random();
+  }
+  return positions;
+}
+
+}  // namespace
+
+TEST(SpatialHashGrid, MatchesBruteForce) {
+  const std::vector<Eigen::Vector3f> positions = MakeRandomPositions(5000);
+  const float kRadii[] = { 0.1f, 0.5f, 1.0f, 3.0f };
+  for (const int num_threads : { 1, 4 }) {
+    SpatialHashGrid grid(0.5f, num_threads);
+    grid.Build(positions);
+    EXPECT_EQ(grid.num_points(), positions.size());
+    std::vector<int> neighbors;
+    for (int i = 0; i < 100; ++i) {
+      for (const float radius : kRadii) {
+        const Eigen::Vector3f query = 10.0f * Eigen::Vector3f::Random();
+        grid.FindNeighbors(query, radius, &neighbors);
+        std::sort(neighbors.begin(), neighbors.end());
+        EXPECT_EQ(neighbors,
+                  FindNeighborsByBruteForce(positions, query, radius));
+      }
+    }
+  }
+}
+
+TEST(SpatialHashGrid, RebuildsWithMovedPoints) {
+  std::vector<Eigen::Vector3f> positions = MakeRandomPositions(1000);
+  SpatialHashGrid grid(1.0f);
+  grid.Build(positions);
+  std::vector<int> neighbors;
+  grid.FindNeighbors(positions[7], 1e-3f, &neighbors);
+  ASSERT_EQ(neighbors.size(), 1);
+  EXPECT_EQ(neighbors[0], 7);
+
+  positions[7] = Eigen::Vector3f(100.0f, 100.0f, 100.0f);
+  grid.Build(positions);
+  grid.FindNeighbors(Eigen::Vector3f(100.0f, 100.0f, 100.0f), 1e-3f,
+                     &neighbors);
+  ASSERT_EQ(neighbors.size(), 1);
+  EXPECT_EQ(neighbors[0], 7);
+}
+
+TEST(SpatialHashGrid, EmptyGrid) {
+  SpatialHashGrid grid(1.0f);
+  std::vector<int> neighbors(3, 0);
+  grid.FindNeighbors(Eigen::Vector3f::Zero(), 1.0f, &neighbors);
+  EXPECT_TRUE(neighbors.empty());
+  grid.Build(std::vector<Eigen::Vector3f>());
+  grid.FindNeighbors(Eigen::Vector3f::Zero(), 1.0f, &neighbors);
+  EXPECT_TRUE(neighbors.empty());
+}
+
+// Radii that span many cells per axis used to overflow the number of cells of
+// the query, and coordinates beyond the range of int used to be cast to int.
+TEST(SpatialHashGrid, HandlesHugeRadiiAndFarAwayPoints) {
+  std::vector<Eigen::Vector3f> positions = MakeRandomPositions(1000);
+  positions[3] = Eigen::Vector3f(1e20f, -1e20f, 1e20f);
+  positions[5] = Eigen::Vector3f(std::numeric_limits<float>::quiet_NaN(),
+                                 0.0f, 0.0f);
+  SpatialHashGrid grid(0.01f);
+  grid.Build(positions);
+  std::vector<int> neighbors;
+  for (const float radius : { 100.0f, 1e6f, 1e30f }) {
+    const Eigen::Vector3f query = Eigen::Vector3f::Zero();
+    grid.FindNeighbors(query, radius, &neighbors);
+    std::sort(neighbors.begin(), neighbors.end());
+    EXPECT_EQ(neighbors, FindNeighborsByBruteForce(positions, query, radius));
+  }
+  // Far away points are still found near their position.
+  grid.FindNeighbors(positions[3], 1.0f, &neighbors);
+  ASSERT_EQ(neighbors.size(), 1);
+  EXPECT_EQ(neighbors[0], 3);
+  // Negative and NaN radii find nothing.
+  grid.FindNeighbors(Eigen::Vector3f::Zero(), -1.0f, &neighbors);
+  EXPECT_TRUE(neighbors.empty());
+  grid.FindNeighbors(Eigen::Vector3f::Zero(),
+                     std::numeric_limits<float>::quiet_NaN(), &neighbors);
+  EXPECT_TRUE(neighbors.empty());
+}
+
+// Reports the time of a rebuild plus one query per point for one million
+// points, i.e., the per-frame work of a particle simulation.
+TEST(SpatialHashGrid, RebuildAndQueryOneMillionPoints) {
+  constexpr int kNumPoints = 1000000;
+  // About 8 points per cell.
+  constexpr float kCellSize = 0.4f;
+  const std::vector<Eigen::Vector3f> positions =
+      MakeRandomPositions(kNumPoints);
+  SpatialHashGrid grid(kCellSize);
+  grid.Build(positions);
+
+  const auto build_start = std::chrono::steady_clock::now();
+  grid.Build(positions);
+  const auto build_end = std::chrono::steady_clock::now();
+  std::vector<int> neighbors;
+  int num_neighbors = 0;
+  for (int i = 0; i < kNumPoints; ++i) {
+    grid.FindNeighbors(positions[i], 0.5f * kCellSize, &neighbors);
+    num_neighbors += neighbors.size();
+  }
+  const auto query_end = std::chrono::steady_clock::now();
+  // Every point is its own neighbor.
+  EXPECT_GE(num_neighbors, kNumPoints);
+
+  const std::chrono::duration<double, std::milli> build_time =
+      build_end - build_start;
+  const std::chrono::duration<double, std::milli> query_time =
+      query_end - build_end;
+  LOG(INFO) << "Rebuild: " << build_time.count() << " ms, "
+            << kNumPoints << " queries: " << query_time.count() << " ms";
+}
+
+}  // namespace wvu
@@ -0,0 +1,192 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "test/gl_test.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace wvu {
+
+GLFWwindow* GLTest::window = nullptr;
+
+void GLTest::SetUpTestCase() {
+  // Initialize the GLFW library.
+  if (!glfwInit()) {
+    LOG(FATAL) << "GLFW did not initialize correctly";
+  }
+  // GLFW_CONTEXT_VERSION_{MAJOR|MINOR} sets the minimum OpenGL API version
+  // that the tests use.
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  window = glfwCreateWindow(480, 640, "Tests", nullptr, nullptr);
+  if (!window) {
+    glfwTerminate();
+    LOG(FATAL) << "Could not create a window";
+  }
+  glfwMakeContextCurrent(window);
+  // Initialize GLEW.
+  glewExperimental = GL_TRUE;
+  if (glewInit() != GLEW_OK) {
+    glfwTerminate();
+    LOG(FATAL) << "Glew did not initialize properly!";
+  }
+}
+
+void GLTest::TearDownTestCase() {
+  glfwDestroyWindow(window);
+  window = nullptr;
+  glfwTerminate();
+}
+
+const std::string vertex_shader_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "\n"
+    "void main() {\n"
+    "gl_Position = vec4(position.x, position.y, position.z, 1.0f);\n"
+    "}\n";
+
+const std::string fragment_shader_src =
+    "#version 330 core\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "color = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+    "}\n";
+
+const std::string fullscreen_vertex_shader_src =
+    "#version 330 core\n"
+    "void main() {\n"
+    "  vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "  gl_Position = vec4(2.0f * position - 1.0f, 0.0f, 1.0f);\n"
+    "}\n";
+
+const std::string lights_fragment_shader_src =
+    "#version 330 core\n"
+    "uniform int num_lights;\n"
+    "uniform bool use_fog;\n"
+    "uniform float fog_density;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "  vec2 position = gl_FragCoord.xy / 256.0f;\n"
+    "  vec3 shade = vec3(0.0f);\n"
+    "  for (int i = 0; i < num_lights; ++i) {\n"
+    "    vec2 light = vec2(float(i) / float(num_lights), 0.5f);\n"
+    "    vec2 offset = position - light;\n"
+    "    shade += vec3(0.1f, 0.05f, 0.02f) /\n"
+    "        (1.0f + 10.0f * dot(offset, offset));\n"
+    "  }\n"
+    "  if (use_fog) {\n"
+    "    shade = mix(shade, vec3(0.5f), fog_density);\n"
+    "  }\n"
+    "  color = vec4(shade, 1.0f);\n"
+    "}\n";
+
+std::string MakeFragmentShaderSource(const int index) {
+  return "#version 330 core\n"
+      "out vec4 color;\n"
+      "void main() {\n"
+      "color = vec4(" + std::to_string(index) + ".0f, 0.5f, 0.2f, 1.0f);\n"
+      "}\n";
+}
+
+bool IsComputeSupported() {
+  return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+}
+
+bool IsSeparableProgramSupported() {
+  return GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+}
+
+std::string MakeSeparableVertexShaderSource(const int index) {
+  return "#version 410 core\n"
+      "layout (location = 0) in vec3 position;\n"
+      "layout (location = 0) out vec3 shading_color;\n"
+      "out gl_PerVertex { vec4 gl_Position; };\n"
+      "void main() {\n"
+      "shading_color = position * " + std::to_string(index) + ".0f;\n"
+      "gl_Position = vec4(position, 1.0f);\n"
+      "}\n";
+}
+
+std::string MakeSeparableFragmentShaderSource(const int index) {
+  return "#version 410 core\n"
+      "layout (location = 0) in vec3 shading_color;\n"
+      "out vec4 color;\n"
+      "void main() {\n"
+      "color = vec4(shading_color, " + std::to_string(index) + ".0f);\n"
+      "}\n";
+}
+
+std::vector<std::string> ListFiles(const std::string& directory) {
+  std::vector<std::string> filepaths;
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    return filepaths;
+  }
+  while (const dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name != "." && name != "..") {
+      filepaths.push_back(directory + "/" + name);
+    }
+  }
+  closedir(dir);
+  return filepaths;
+}
+
+void WriteFile(const std::string& filepath, const std::string& contents) {
+  std::ofstream file(filepath);
+  file << contents;
+}
+
+void RemoveDirectory(const std::string& directory) {
+  for (const std::string& filepath : ListFiles(directory)) {
+    unlink(filepath.c_str());
+  }
+  rmdir(directory.c_str());
+}
+
+}  // namespace wvu
@@ -0,0 +1,95 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef TEST_GL_TEST_H_
+#define TEST_GL_TEST_H_
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+struct GLFWwindow;
+
+namespace wvu {
+// A fixture that creates a hidden window with an OpenGL 3.2+ core context, made
+// current for the tests of the test case, and initializes GLEW. The tests of
+// every OpenGL module derive their fixture from it.
+class GLTest : public ::testing::Test {
+ public:
+  static void SetUpTestCase();
+  static void TearDownTestCase();
+
+ protected:
+  static GLFWwindow* window;
+};
+
+// A vertex shader that passes the positions of attribute 0 through and a
+// fragment shader that outputs a constant orange.
+extern const std::string vertex_shader_src;
+extern const std::string fragment_shader_src;
+
+// A vertex shader that covers the viewport with a triangle drawn from three
+// vertices without attributes, and a fill-bound fragment shader whose cost per
+// pixel depends on a light count and a fog toggle.
+extern const std::string fullscreen_vertex_shader_src;
+extern const std::string lights_fragment_shader_src;
+
+// Returns a fragment shader source that differs for every index, so that every
+// index produces a different program.
+std::string MakeFragmentShaderSource(const int index);
+
+// Returns true if the context supports compute shaders.
+bool IsComputeSupported();
+
+// Returns true if the context supports separable programs.
+bool IsSeparableProgramSupported();
+
+// Returns a vertex shader that differs for every index and can be linked alone
+// into a separable program.
+std::string MakeSeparableVertexShaderSource(const int index);
+
+// Returns a fragment shader that matches MakeSeparableVertexShaderSource() by
+// location and differs for every index.
+std::string MakeSeparableFragmentShaderSource(const int index);
+
+// Returns the paths of the files in a directory.
+std::vector<std::string> ListFiles(const std::string& directory);
+
+// Writes the contents into the file, replacing it.
+void WriteFile(const std::string& filepath, const std::string& contents);
+
+// Removes a directory and the files it holds.
+void RemoveDirectory(const std::string& directory);
+
+}  // namespace wvu
+
+#endif  // TEST_GL_TEST_H_
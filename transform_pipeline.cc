@@ -0,0 +1,128 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "transform_pipeline.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+namespace wvu {
+namespace {
+// Number of points processed per block. A block of input, output and buffer
+// points fits in the L1/L2 caches, so every term is added while the block is
+// still cached and each point is read and written from memory once.
+constexpr int kNumPointsPerBlock = 1024;
+
+}  // namespace
+
+TransformPipeline& TransformPipeline::MultiplyByMatrix(
+    const Eigen::Matrix4f& matrix) {
+  // matrix * (A p + c + sum_k B_k b_k) = (matrix A) p + matrix c +
+  // sum_k (matrix B_k) b_k.
+  fused_.linear = matrix * fused_.linear;
+  fused_.offset = matrix * fused_.offset;
+  for (auto& buffer_term : fused_.buffer_terms) {
+    buffer_term.second = matrix * buffer_term.second;
+  }
+  ++num_operations_;
+  return *this;
+}
+
+TransformPipeline& TransformPipeline::AddPoint(const Eigen::Vector4f& point) {
+  fused_.offset += point;
+  ++num_operations_;
+  return *this;
+}
+
+TransformPipeline& TransformPipeline::AddPoints(
+    const Eigen::Matrix4Xf* points) {
+  // Adding the same buffer again only changes its matrix.
+  auto buffer_term = std::find_if(
+      fused_.buffer_terms.begin(), fused_.buffer_terms.end(),
+      [points](const std::pair<const Eigen::Matrix4Xf*,
+                               Eigen::Matrix4f>& term) {
+        return term.first == points;
+      });
+  if (buffer_term != fused_.buffer_terms.end()) {
+    buffer_term->second += Eigen::Matrix4f::Identity();
+  } else {
+    fused_.buffer_terms.emplace_back(points, Eigen::Matrix4f::Identity());
+  }
+  ++num_operations_;
+  return *this;
+}
+
+void TransformPipeline::Clear() {
+  fused_.linear.setIdentity();
+  fused_.offset.setZero();
+  fused_.buffer_terms.clear();
+  num_operations_ = 0;
+}
+
+bool TransformPipeline::Evaluate(const Eigen::Matrix4Xf& input,
+                                 Eigen::Matrix4Xf* output,
+                                 std::string* error_info_log) const {
+  const int num_points = input.cols();
+  for (const auto& buffer_term : fused_.buffer_terms) {
+    if (buffer_term.first->cols() != num_points) {
+      if (error_info_log) {
+        *error_info_log = "A recorded buffer has " +
+            std::to_string(buffer_term.first->cols()) + " points but the " +
+            "input has " + std::to_string(num_points) + " points.";
+      }
+      return false;
+    }
+  }
+  output->resize(Eigen::NoChange, num_points);
+  // The block is computed in a temporary so that output may be the input.
+  Eigen::Matrix<float, 4, kNumPointsPerBlock> block;
+  for (int start = 0; start < num_points; start += kNumPointsPerBlock) {
+    const int block_size = std::min(kNumPointsPerBlock, num_points - start);
+    auto block_points = block.leftCols(block_size);
+    block_points.noalias() =
+        fused_.linear * input.middleCols(start, block_size);
+    block_points.colwise() += fused_.offset;
+    for (const auto& buffer_term : fused_.buffer_terms) {
+      block_points.noalias() +=
+          buffer_term.second *
+          buffer_term.first->middleCols(start, block_size);
+    }
+    output->middleCols(start, block_size) = block_points;
+  }
+  return true;
+}
+
+}  // namespace wvu
@@ -0,0 +1,133 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef WVU_TRANSFORM_PIPELINE_H_
+#define WVU_TRANSFORM_PIPELINE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <Eigen/Core>
+
+namespace wvu {
+// This class records a chain of wvu operations over whole buffers of 4d points
+// and evaluates them later in a single pass. Every supported operation is
+// affine, so the recorded chain is folded into
+//
+//   output[i] = A * input[i] + c + sum_k B_k * buffer_k[i],
+//
+// where the matrices are pre-multiplied once instead of once per point, and no
+// temporary buffer is materialized between operations.
+//
+// Buffers hold one point per column, i.e., a 4xN matrix.
+//
+// Example. The eager code
+//
+//   for (int i = 0; i < num_points; ++i) {
+//     out[i] = MultiplyVectorAndMatrix(
+//         Multiply4x4Matrices(P, Multiply4x4Matrices(V, M)),
+//         Add4dPoints(points[i], offsets[i]));
+//   }
+//
+// becomes
+//
+//   wvu::TransformPipeline pipeline;
+//   pipeline.AddPoints(&offsets).MultiplyByMatrix(M)
+//       .MultiplyByMatrix(V).MultiplyByMatrix(P);
+//   std::string error_info_log;
+//   if (!pipeline.Evaluate(points, &out, &error_info_log)) {
+//     LOG(ERROR) << error_info_log;
+//   }
+class TransformPipeline {
+ public:
+  // The folded form of the recorded operations.
+  struct FusedTransform {
+    // The matrix A applied to the input points.
+    Eigen::Matrix4f linear;
+    // The constant offset c.
+    Eigen::Vector4f offset;
+    // The matrices B_k and their buffers. Every buffer appears once.
+    std::vector<std::pair<const Eigen::Matrix4Xf*, Eigen::Matrix4f> >
+        buffer_terms;
+  };
+
+  TransformPipeline() : num_operations_(0) { Clear(); }
+  ~TransformPipeline() {}
+
+  // Records p = matrix * p, i.e., MultiplyVectorAndMatrix(matrix, p).
+  TransformPipeline& MultiplyByMatrix(const Eigen::Matrix4f& matrix);
+
+  // Records p = p + point, i.e., Add4dPoints(p, point), with the same point
+  // for every element.
+  TransformPipeline& AddPoint(const Eigen::Vector4f& point);
+
+  // Records p[i] = p[i] + points[i]. The buffer is not copied, so it must be
+  // alive when Evaluate() is called.
+  TransformPipeline& AddPoints(const Eigen::Matrix4Xf* points);
+
+  // Removes every recorded operation.
+  void Clear();
+
+  // Returns the number of recorded operations.
+  int num_operations() const {
+    return num_operations_;
+  }
+
+  // Returns the folded form of the recorded operations.
+  const FusedTransform& fused_transform() const {
+    return fused_;
+  }
+
+  // Applies the recorded operations to input and stores the result in output.
+  // The output may be the input. Returns false when a recorded buffer does not
+  // have as many points as the input, and true otherwise.
+  //
+  // Parameters:
+  //   input  The points, one per column.
+  //   output  The transformed points. It is resized to the size of input.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Evaluate(const Eigen::Matrix4Xf& input,
+                Eigen::Matrix4Xf* output,
+                std::string* error_info_log) const;
+
+ private:
+  // The recorded operations folded as they are recorded.
+  FusedTransform fused_;
+  // Number of recorded operations.
+  int num_operations_;
+};
+
+}  // namespace wvu
+
+#endif  // WVU_TRANSFORM_PIPELINE_H_
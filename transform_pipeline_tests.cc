@@ -0,0 +1,124 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <chrono>  // For timing the eager and fused evaluations.
+#include <string>
+
+// System specific headers.
+#include "assignment.h"
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "transform_pipeline.h"
+
+namespace wvu {
+
+TEST(TransformPipeline, MatchesEagerEvaluation) {
+  constexpr int kNumPoints = 100003;
+  const Eigen::Matrix4f model = Eigen::Matrix4f::Random();
+  const Eigen::Matrix4f view = Eigen::Matrix4f::Random();
+  const Eigen::Matrix4f projection = Eigen::Matrix4f::Random();
+  const Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, kNumPoints);
+  const Eigen::Matrix4Xf offsets = Eigen::Matrix4Xf::Random(4, kNumPoints);
+
+  const auto eager_start = std::chrono::steady_clock::now();
+  Eigen::Matrix4Xf expected(4, kNumPoints);
+  for (int i = 0; i < kNumPoints; ++i) {
+    expected.col(i) = MultiplyVectorAndMatrix(
+        Multiply4x4Matrices(projection, Multiply4x4Matrices(view, model)),
+        Add4dPoints(points.col(i), offsets.col(i)));
+  }
+  const auto eager_end = std::chrono::steady_clock::now();
+
+  TransformPipeline pipeline;
+  pipeline.AddPoints(&offsets)
+      .MultiplyByMatrix(model)
+      .MultiplyByMatrix(view)
+      .MultiplyByMatrix(projection);
+  EXPECT_EQ(pipeline.num_operations(), 4);
+  Eigen::Matrix4Xf result;
+  std::string error_info_log;
+  const auto fused_start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(pipeline.Evaluate(points, &result, &error_info_log));
+  const auto fused_end = std::chrono::steady_clock::now();
+
+  ASSERT_EQ(result.cols(), kNumPoints);
+  EXPECT_LT((result - expected).cwiseAbs().maxCoeff(), 1e-4);
+  const std::chrono::duration<double, std::micro> eager_time =
+      eager_end - eager_start;
+  const std::chrono::duration<double, std::micro> fused_time =
+      fused_end - fused_start;
+  LOG(INFO) << "Transformed " << kNumPoints << " points. Eager: "
+            << eager_time.count() << " us, fused: " << fused_time.count()
+            << " us, speedup: " << eager_time.count() / fused_time.count()
+            << "x";
+}
+
+TEST(TransformPipeline, FoldsOperationsIntoOneAffineTransform) {
+  const Eigen::Matrix4f x = Eigen::Matrix4f::Random();
+  const Eigen::Matrix4f y = Eigen::Matrix4f::Random();
+  const Eigen::Vector4f offset = Eigen::Vector4f::Random();
+  const Eigen::Matrix4Xf buffer = Eigen::Matrix4Xf::Random(4, 8);
+  TransformPipeline pipeline;
+  pipeline.MultiplyByMatrix(x).AddPoint(offset).AddPoints(&buffer)
+      .MultiplyByMatrix(y).AddPoints(&buffer);
+  const TransformPipeline::FusedTransform& fused = pipeline.fused_transform();
+  EXPECT_LT((fused.linear - Multiply4x4Matrices(y, x)).norm(), 1e-4);
+  EXPECT_LT((fused.offset - MultiplyVectorAndMatrix(y, offset)).norm(), 1e-4);
+  // The same buffer is only read once.
+  ASSERT_EQ(fused.buffer_terms.size(), 1);
+  EXPECT_LT((fused.buffer_terms[0].second -
+             (y + Eigen::Matrix4f::Identity())).norm(), 1e-4);
+}
+
+TEST(TransformPipeline, EvaluatesInPlace) {
+  Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, 3001);
+  const Eigen::Matrix4Xf original_points = points;
+  const Eigen::Matrix4f matrix = Eigen::Matrix4f::Random();
+  TransformPipeline pipeline;
+  pipeline.MultiplyByMatrix(matrix);
+  ASSERT_TRUE(pipeline.Evaluate(points, &points, nullptr));
+  EXPECT_LT((points - matrix * original_points).cwiseAbs().maxCoeff(), 1e-4);
+}
+
+TEST(TransformPipeline, RejectsBuffersOfDifferentSize) {
+  const Eigen::Matrix4Xf points = Eigen::Matrix4Xf::Random(4, 10);
+  const Eigen::Matrix4Xf offsets = Eigen::Matrix4Xf::Random(4, 11);
+  TransformPipeline pipeline;
+  pipeline.AddPoints(&offsets);
+  Eigen::Matrix4Xf result;
+  std::string error_info_log;
+  EXPECT_FALSE(pipeline.Evaluate(points, &result, &error_info_log));
+  EXPECT_GT(error_info_log.size(), 0);
+}
+
+}  // namespace wvu
@@ -0,0 +1,130 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+// Transforms a file of packed float3 or float4 points with a 4x4 matrix and
+// reports the end to end throughput. The files are streamed through fixed-size
+// memory-mapped windows, so the input may be larger than the available RAM.
+//
+// Example:
+//
+// ./bin/transform_point_file --input=/data/lidar.xyz --output=/data/out.xyz
+//     --format=3 --window_mb=64
+//     --matrix="1,0,0,10, 0,1,0,0, 0,0,1,0, 0,0,0,1"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <Eigen/Core>
+
+#include "point_stream.h"
+
+// Use the right namespace for google flags (gflags).
+#ifdef GFLAGS_NAMESPACE_GOOGLE
+#define CS470_GFLAGS_NAMESPACE google
+#else
+#define CS470_GFLAGS_NAMESPACE gflags
+#endif
+
+DEFINE_string(input, "", "Filepath of the packed input points.");
+DEFINE_string(output, "", "Filepath of the transformed points.");
+DEFINE_int32(format, 3, "Number of floats per point: 3 or 4.");
+DEFINE_int32(window_mb, 64, "Size in MB of the mapped windows.");
+DEFINE_int32(readahead_windows, 2, "Number of windows to prefetch.");
+DEFINE_string(matrix, "",
+              "Row-major 4x4 transformation as 16 comma separated values. "
+              "The identity is used when empty.");
+
+// Annonymous namespace for helper functions.
+namespace {
+// Parses the row-major matrix given in the command line. Returns true if
+// successful, and false otherwise.
+bool ParseMatrix(const std::string& text, Eigen::Matrix4f* matrix) {
+  if (text.empty()) {
+    *matrix = Eigen::Matrix4f::Identity();
+    return true;
+  }
+  std::stringstream stream(text);
+  for (int i = 0; i < 16; ++i) {
+    std::string value;
+    if (!std::getline(stream, value, ',')) {
+      return false;
+    }
+    std::stringstream value_stream(value);
+    if (!(value_stream >> (*matrix)(i / 4, i % 4))) {
+      return false;
+    }
+  }
+  // The last value must end the text; extra values or a trailing comma are
+  // most likely a typo in the matrix.
+  return stream.eof();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CS470_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_input.empty() || FLAGS_output.empty()) {
+    std::cerr << "ERROR: --input and --output are required.\n";
+    return -1;
+  }
+  if (FLAGS_format != wvu::FLOAT3 && FLAGS_format != wvu::FLOAT4) {
+    std::cerr << "ERROR: --format must be 3 or 4.\n";
+    return -1;
+  }
+  Eigen::Matrix4f transformation;
+  if (!ParseMatrix(FLAGS_matrix, &transformation)) {
+    std::cerr << "ERROR: --matrix must hold exactly 16 comma separated "
+                 "values.\n";
+    return -1;
+  }
+
+  wvu::PointStreamOptions options;
+  options.format = static_cast<wvu::PointRecordFormat>(FLAGS_format);
+  options.window_size_bytes = static_cast<size_t>(FLAGS_window_mb) << 20;
+  options.readahead_windows = FLAGS_readahead_windows;
+  wvu::PointStreamStats stats;
+  std::string error_info_log;
+  if (!wvu::TransformPointFile(FLAGS_input, FLAGS_output, transformation,
+                               options, &stats, &error_info_log)) {
+    std::cerr << "ERROR: " << error_info_log << "\n";
+    return -1;
+  }
+  std::cout << "Transformed " << stats.num_points << " points in "
+            << stats.num_windows << " windows.\n"
+            << "Elapsed time: " << stats.elapsed_seconds << " s\n"
+            << "Throughput: " << stats.GigabytesPerSecond() << " GB/s\n";
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "uniform_buffer_ring.h"
+
+#include <stdint.h>
+#include <string>
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+// Time to wait for a fence before checking again, in nanoseconds.
+constexpr GLuint64 kFenceWaitTimeout = 1000000000;
+
+// Returns the offset rounded up to a multiple of the alignment.
+GLintptr AlignOffset(const GLintptr offset, const GLint alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+UniformBufferRing::~UniformBufferRing() {
+  for (size_t i = 0; i < fenced_ranges_.size(); ++i) {
+    // Consecutive ranges may share a fence; delete it once.
+    if (i + 1 == fenced_ranges_.size() ||
+        fenced_ranges_[i + 1].fence != fenced_ranges_[i].fence) {
+      glDeleteSync(fenced_ranges_[i].fence);
+    }
+  }
+  if (buffer_id_ != 0) {
+    // Deleting the buffer also unmaps it.
+    glDeleteBuffers(1, &buffer_id_);
+  }
+}
+
+bool UniformBufferRing::Initialize(const GLsizeiptr capacity,
+                                   std::string* error_info_log) {
+  if (buffer_id_ != 0) {
+    return true;
+  }
+  if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+    if (error_info_log) {
+      *error_info_log = "The uniform buffer ring requires OpenGL 4.4 or "
+          "ARB_buffer_storage.";
+    }
+    return false;
+  }
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment_);
+  if (alignment_ <= 0) {
+    alignment_ = 1;
+  }
+  const GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &buffer_id_);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer_id_);
+  glBufferStorage(GL_UNIFORM_BUFFER, capacity, nullptr, flags);
+  mapped_data_ = static_cast<char*>(
+      glMapBufferRange(GL_UNIFORM_BUFFER, 0, capacity, flags));
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  if (mapped_data_ == nullptr) {
+    glDeleteBuffers(1, &buffer_id_);
+    buffer_id_ = 0;
+    if (error_info_log) {
+      *error_info_log = "Could not map the uniform buffer.";
+    }
+    return false;
+  }
+  capacity_ = capacity;
+  return true;
+}
+
+bool UniformBufferRing::Allocate(const GLsizeiptr size, Block* block) {
+  if (mapped_data_ == nullptr || size <= 0 || size > capacity_) {
+    return false;
+  }
+  GLintptr offset = AlignOffset(head_, alignment_);
+  if (offset + size > capacity_) {
+    // Wrap around. The blocks allocated so far in this frame still need a
+    // fence, which they get with the next call to Fence().
+    if (head_ > region_start_) {
+      unfenced_ranges_.push_back(FencedRange{ nullptr, region_start_, head_ });
+    }
+    offset = 0;
+    head_ = 0;
+    region_start_ = 0;
+  }
+  const GLintptr end = offset + size;
+  // A frame that uses more than the whole ring reaches its own blocks, which
+  // have no fence yet.
+  for (const FencedRange& range : unfenced_ranges_) {
+    if (range.start < end && offset < range.end) {
+      Fence();
+      break;
+    }
+  }
+  WaitForRanges(offset, end);
+  head_ = end;
+  ++num_allocations_;
+  block->data = mapped_data_ + offset;
+  block->offset = offset;
+  block->size = size;
+  return true;
+}
+
+void UniformBufferRing::BindBlock(const GLuint binding,
+                                  const Block& block) const {
+  trace_recorder_->BindUniformBufferRange(binding, buffer_id_, block.offset,
+                                          block.size, block.data);
+}
+
+void UniformBufferRing::Fence() {
+  if (head_ > region_start_) {
+    unfenced_ranges_.push_back(FencedRange{ nullptr, region_start_, head_ });
+    region_start_ = head_;
+  }
+  if (unfenced_ranges_.empty()) {
+    return;
+  }
+  const GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  for (FencedRange& range : unfenced_ranges_) {
+    range.fence = fence;
+    fenced_ranges_.push_back(range);
+  }
+  unfenced_ranges_.clear();
+}
+
+void UniformBufferRing::WaitForRanges(const GLintptr start,
+                                      const GLintptr end) {
+  // Fences are signaled in order, so waiting for the newest overlapping range
+  // covers the older ones too.
+  int last_overlapping = -1;
+  for (int i = 0; i < static_cast<int>(fenced_ranges_.size()); ++i) {
+    if (fenced_ranges_[i].start < end && start < fenced_ranges_[i].end) {
+      last_overlapping = i;
+    }
+  }
+  if (last_overlapping < 0) {
+    return;
+  }
+  const GLsync fence = fenced_ranges_[last_overlapping].fence;
+  if (glClientWaitSync(fence, 0, 0) != GL_ALREADY_SIGNALED) {
+    ++num_fence_waits_;
+    GLenum result;
+    do {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                kFenceWaitTimeout);
+    } while (result == GL_TIMEOUT_EXPIRED);
+  }
+  for (int i = 0; i <= last_overlapping; ++i) {
+    const GLsync range_fence = fenced_ranges_.front().fence;
+    fenced_ranges_.pop_front();
+    if (fenced_ranges_.empty() || fenced_ranges_.front().fence != range_fence) {
+      glDeleteSync(range_fence);
+    }
+  }
+}
+
+}  // namespace wvu
@@ -0,0 +1,170 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_UNIFORM_BUFFER_RING_H_
+#define GLUTILS_UNIFORM_BUFFER_RING_H_
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <GL/glew.h>
+
+#include "gl_trace.h"
+
+namespace wvu {
+// This class sub-allocates uniform blocks from a single uniform buffer that
+// stays mapped for its whole life. Every draw writes its uniforms into a block
+// of the ring through a plain pointer and binds the block with
+// glBindBufferRange(), which replaces many glUniform*() calls per draw with a
+// memcpy and a single bind. Blocks are handed out in order and the ring wraps
+// around when it reaches its end.
+// The GPU may still read a block from a previous frame when the ring wraps
+// around to it. Call Fence() once the draws that use the blocks of a frame are
+// submitted; the ring then waits for the fence before overwriting those
+// blocks. With a ring that holds a few frames of uniforms, the wait is normally
+// already satisfied. BindBlock() issues its call through the given trace
+// recorder, which records the contents of the block. Requires OpenGL 4.4 or
+// ARB_buffer_storage.
+//
+// Example.
+//
+// wvu::UniformBufferRing uniform_ring;
+// uniform_ring.Initialize(4 << 20, &error_info_log);
+// shader_program.SetUniformBlockBinding("DrawData", 0);
+// while (...) {  // Rendering loop.
+//   for (const DrawableObject& object : objects) {
+//     wvu::UniformBufferRing::Block block;
+//     uniform_ring.Allocate(sizeof(DrawData), &block);
+//     memcpy(block.data, &object.draw_data, sizeof(DrawData));
+//     uniform_ring.BindBlock(0, block);
+//     glDrawArrays(...);
+//   }
+//   uniform_ring.Fence();
+// }
+class UniformBufferRing {
+ public:
+  // A block of the ring.
+  struct Block {
+    // Where the uniforms are written. The memory is coherent, so no flush is
+    // needed.
+    void* data;
+    // The offset of the block in the buffer; a multiple of the alignment.
+    GLintptr offset;
+    GLsizeiptr size;
+  };
+
+  // Binds the blocks through the trace recorder, which must outlive the ring.
+  // A null recorder binds them directly.
+  explicit UniformBufferRing(GLTraceRecorder* trace_recorder = nullptr) :
+      trace_recorder_(trace_recorder ?
+                      trace_recorder : GLTraceRecorder::PassThrough()),
+      buffer_id_(0), mapped_data_(nullptr), capacity_(0), alignment_(1),
+      head_(0), region_start_(0), num_allocations_(0), num_fence_waits_(0) {}
+  ~UniformBufferRing();
+  UniformBufferRing(const UniformBufferRing&) = delete;
+  UniformBufferRing& operator=(const UniformBufferRing&) = delete;
+
+  // Creates and maps the buffer. Returns true if successful, and false
+  // otherwise, in which case error_info_log holds the reason.
+  //
+  // Parameters:
+  //   capacity  The size of the buffer in bytes.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Initialize(const GLsizeiptr capacity, std::string* error_info_log);
+
+  // Allocates a block of the given size, aligned to the uniform buffer offset
+  // alignment of the driver. Waits for the GPU if the block overlaps blocks
+  // that may still be in use. Returns false if the size exceeds the capacity.
+  bool Allocate(const GLsizeiptr size, Block* block);
+
+  // Binds the block to the uniform buffer binding.
+  void BindBlock(const GLuint binding, const Block& block) const;
+
+  // Protects the blocks allocated since the last call with a fence. Call it
+  // once the draws that read them are submitted, e.g., at the end of a frame.
+  void Fence();
+
+  // Returns the id of the buffer.
+  GLuint buffer_id() const {
+    return buffer_id_;
+  }
+
+  // Returns the alignment of the offsets of the blocks.
+  GLint alignment() const {
+    return alignment_;
+  }
+
+  // Returns the number of allocated blocks, and the number of allocations that
+  // had to wait for the GPU.
+  uint64_t num_allocations() const {
+    return num_allocations_;
+  }
+  uint64_t num_fence_waits() const {
+    return num_fence_waits_;
+  }
+
+ private:
+  // A range of the buffer, [start, end), that the GPU may still read until the
+  // fence is signaled. Ranges are kept from the oldest to the newest, and
+  // several consecutive ranges may share a fence.
+  struct FencedRange {
+    GLsync fence;
+    GLintptr start;
+    GLintptr end;
+  };
+
+  // Waits for the fences of the ranges that overlap [start, end), and of the
+  // older ones, and forgets them.
+  void WaitForRanges(const GLintptr start, const GLintptr end);
+
+  GLTraceRecorder* trace_recorder_;
+  GLuint buffer_id_;
+  char* mapped_data_;
+  GLsizeiptr capacity_;
+  GLint alignment_;
+  // Offset where the next block starts.
+  GLintptr head_;
+  // Start of the blocks allocated since the last fence.
+  GLintptr region_start_;
+  // Ranges allocated since the last fence that ended because the ring wrapped
+  // around. They receive the next fence.
+  std::deque<FencedRange> unfenced_ranges_;
+  std::deque<FencedRange> fenced_ranges_;
+  uint64_t num_allocations_;
+  uint64_t num_fence_waits_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_UNIFORM_BUFFER_RING_H_
@@ -0,0 +1,193 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C headers.
+#include <string.h>
+
+// C++ headers.
+#include <string>
+
+// System specific headers.
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+#include "uniform_buffer_ring.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+// Returns true if the context supports immutable buffer storage.
+bool IsBufferStorageSupported() {
+  return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+class UniformBufferRingTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(UniformBufferRingTest, AllocatesAlignedUniformBlocksFromRing) {
+  if (!IsBufferStorageSupported()) {
+    LOG(INFO) << "Buffer storage is not supported; skipping.";
+    return;
+  }
+  UniformBufferRing uniform_ring;
+  std::string error_info_log;
+  constexpr GLsizeiptr kCapacity = 1 << 16;
+  ASSERT_TRUE(uniform_ring.Initialize(kCapacity, &error_info_log))
+      << error_info_log;
+  const GLint alignment = uniform_ring.alignment();
+  ASSERT_GT(alignment, 0);
+
+  // Allocate several frames worth of blocks, so that the ring wraps around.
+  constexpr int kBlockSize = 48;
+  const int num_blocks_per_frame = kCapacity / alignment / 2;
+  GLintptr previous_offset = -1;
+  int num_wraps = 0;
+  for (int frame = 0; frame < 6; ++frame) {
+    for (int i = 0; i < num_blocks_per_frame; ++i) {
+      UniformBufferRing::Block block;
+      ASSERT_TRUE(uniform_ring.Allocate(kBlockSize, &block));
+      EXPECT_EQ(block.offset % alignment, 0);
+      EXPECT_LE(block.offset + kBlockSize, kCapacity);
+      if (block.offset <= previous_offset) {
+        ++num_wraps;
+      }
+      previous_offset = block.offset;
+      *static_cast<int*>(block.data) = frame * num_blocks_per_frame + i;
+    }
+    uniform_ring.Fence();
+  }
+  EXPECT_GE(num_wraps, 2);
+  EXPECT_EQ(uniform_ring.num_allocations(), 6 * num_blocks_per_frame);
+
+  // The last block is visible to the GPU without any flush.
+  int last_value = -1;
+  glBindBuffer(GL_UNIFORM_BUFFER, uniform_ring.buffer_id());
+  glGetBufferSubData(GL_UNIFORM_BUFFER, previous_offset, sizeof(last_value),
+                     &last_value);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  EXPECT_EQ(last_value, 6 * num_blocks_per_frame - 1);
+
+  // A frame that uses more than the whole ring still gets its blocks.
+  for (int i = 0; i < 3 * num_blocks_per_frame; ++i) {
+    UniformBufferRing::Block block;
+    ASSERT_TRUE(uniform_ring.Allocate(kBlockSize, &block));
+  }
+  UniformBufferRing::Block block;
+  EXPECT_FALSE(uniform_ring.Allocate(kCapacity + 1, &block));
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(UniformBufferRingTest, DrawsWithUniformBlocksFromRing) {
+  if (!IsBufferStorageSupported()) {
+    LOG(INFO) << "Buffer storage is not supported; skipping.";
+    return;
+  }
+  // Every draw covers one pixel of a 4x1 target with the color of its block.
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(
+      "#version 330 core\n"
+      "layout (std140) uniform DrawData {\n"
+      "  vec4 color;\n"
+      "  float x;\n"
+      "};\n"
+      "void main() {\n"
+      "  gl_Position = vec4(x, 0.0f, 0.0f, 1.0f);\n"
+      "}\n");
+  shader_program.LoadFragmentShaderFromString(
+      "#version 330 core\n"
+      "layout (std140) uniform DrawData {\n"
+      "  vec4 color;\n"
+      "  float x;\n"
+      "};\n"
+      "out vec4 frag_color;\n"
+      "void main() {\n"
+      "  frag_color = color;\n"
+      "}\n");
+  std::string error_info_log;
+  ASSERT_TRUE(shader_program.Create(&error_info_log)) << error_info_log;
+  EXPECT_TRUE(shader_program.SetUniformBlockBinding("DrawData", 3));
+  EXPECT_FALSE(shader_program.SetUniformBlockBinding("Missing", 3));
+
+  constexpr int kWidth = 4;
+  GLuint texture = 0, framebuffer = 0, vertex_array = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kWidth, 1, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  ASSERT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER), GL_FRAMEBUFFER_COMPLETE);
+  glGenVertexArrays(1, &vertex_array);
+  glBindVertexArray(vertex_array);
+  glViewport(0, 0, kWidth, 1);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  UniformBufferRing uniform_ring;
+  ASSERT_TRUE(uniform_ring.Initialize(1 << 16, &error_info_log))
+      << error_info_log;
+  ASSERT_TRUE(shader_program.Use());
+  for (int i = 0; i < kWidth; ++i) {
+    // The std140 layout of DrawData.
+    const float draw_data[5] = {
+      i / 3.0f, 1.0f - i / 3.0f, 0.0f, 1.0f, (2.0f * i + 1.0f) / kWidth - 1.0f
+    };
+    UniformBufferRing::Block block;
+    ASSERT_TRUE(uniform_ring.Allocate(sizeof(draw_data), &block));
+    memcpy(block.data, draw_data, sizeof(draw_data));
+    uniform_ring.BindBlock(3, block);
+    glDrawArrays(GL_POINTS, 0, 1);
+  }
+  uniform_ring.Fence();
+
+  unsigned char pixels[4 * kWidth];
+  glReadPixels(0, 0, kWidth, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  for (int i = 0; i < kWidth; ++i) {
+    EXPECT_NEAR(pixels[4 * i], 255.0f * i / 3.0f, 1.0f);
+    EXPECT_NEAR(pixels[4 * i + 1], 255.0f * (1.0f - i / 3.0f), 1.0f);
+    EXPECT_EQ(pixels[4 * i + 3], 255);
+  }
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindVertexArray(0);
+  glDeleteVertexArrays(1, &vertex_array);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+}
+
+}  // namespace wvu
@@ -0,0 +1,227 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#include "vertex_buffer_arena.h"
+
+#include <stdint.h>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <GL/glew.h>
+
+namespace wvu {
+
+VertexBufferArena::~VertexBufferArena() {
+  for (const Buffer& buffer : buffers_) {
+    trace_recorder_->DeleteBuffer(buffer.buffer_id);
+  }
+}
+
+bool VertexBufferArena::Initialize(const GLsizei vertex_stride,
+                                   const GLsizei buffer_capacity,
+                                   std::string* error_info_log) {
+  if (!buffers_.empty()) {
+    return true;
+  }
+  if (vertex_stride <= 0 || buffer_capacity <= 0) {
+    if (error_info_log) {
+      *error_info_log = "The vertex stride and the buffer capacity must be "
+          "positive.";
+    }
+    return false;
+  }
+  vertex_stride_ = vertex_stride;
+  buffer_capacity_ = buffer_capacity;
+  if (!AddBuffer()) {
+    if (error_info_log) {
+      *error_info_log = "Could not allocate a vertex buffer of " +
+          std::to_string(static_cast<int64_t>(buffer_capacity) *
+                         vertex_stride) + " bytes.";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool VertexBufferArena::Allocate(const void* vertices,
+                                 const GLsizei num_vertices,
+                                 Slice* slice) {
+  if (buffers_.empty() || num_vertices <= 0 ||
+      num_vertices > buffer_capacity_) {
+    return false;
+  }
+  // Take the smallest free range that fits, from any buffer.
+  int best_buffer = -1;
+  std::pair<GLsizei, GLint> best_range;
+  for (int i = 0; i < num_buffers(); ++i) {
+    const auto range = buffers_[i].free_ranges_by_size.lower_bound(
+        std::make_pair(num_vertices, 0));
+    if (range != buffers_[i].free_ranges_by_size.end() &&
+        (best_buffer < 0 || range->first < best_range.first)) {
+      best_buffer = i;
+      best_range = *range;
+    }
+  }
+  if (best_buffer < 0) {
+    if (!AddBuffer()) {
+      return false;
+    }
+    best_buffer = num_buffers() - 1;
+    best_range = std::make_pair(buffer_capacity_, 0);
+  }
+
+  // Split the range; the rest stays free.
+  Buffer* buffer = &buffers_[best_buffer];
+  EraseFreeRange(buffer->free_ranges.find(best_range.second), buffer);
+  if (best_range.first > num_vertices) {
+    InsertFreeRange(best_range.second + num_vertices,
+                    best_range.first - num_vertices, buffer);
+  }
+  slice->buffer = best_buffer;
+  slice->base_vertex = best_range.second;
+  slice->num_vertices = num_vertices;
+  ++num_slices_;
+
+  if (vertices) {
+    trace_recorder_->BindBuffer(GL_COPY_WRITE_BUFFER, buffer->buffer_id);
+    trace_recorder_->BufferSubData(
+        GL_COPY_WRITE_BUFFER,
+        static_cast<GLintptr>(slice->base_vertex) * vertex_stride_,
+        static_cast<GLsizeiptr>(num_vertices) * vertex_stride_, vertices);
+    trace_recorder_->BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+  return true;
+}
+
+bool VertexBufferArena::Free(Slice* slice) {
+  if (slice->buffer < 0 || slice->buffer >= num_buffers() ||
+      slice->base_vertex < 0 || slice->num_vertices <= 0 ||
+      static_cast<int64_t>(slice->base_vertex) + slice->num_vertices >
+      buffer_capacity_) {
+    return false;
+  }
+  Buffer* buffer = &buffers_[slice->buffer];
+  GLint start = slice->base_vertex;
+  GLsizei size = slice->num_vertices;
+  // A slice that overlaps a free range was freed already, or never allocated.
+  // Freeing it again would corrupt the free list.
+  auto next = buffer->free_ranges.lower_bound(start);
+  if (next != buffer->free_ranges.end() && next->first < start + size) {
+    return false;
+  }
+  if (next != buffer->free_ranges.begin() &&
+      std::prev(next)->first + std::prev(next)->second > start) {
+    return false;
+  }
+  // Merge with the free neighbors.
+  if (next != buffer->free_ranges.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == start) {
+      start = previous->first;
+      size += previous->second;
+      EraseFreeRange(previous, buffer);
+    }
+  }
+  if (next != buffer->free_ranges.end() && start + size == next->first) {
+    size += next->second;
+    EraseFreeRange(next, buffer);
+  }
+  InsertFreeRange(start, size, buffer);
+  --num_slices_;
+  *slice = Slice();
+  return true;
+}
+
+VertexBufferArenaStats VertexBufferArena::stats() const {
+  VertexBufferArenaStats stats;
+  stats.num_buffers = num_buffers();
+  stats.num_slices = num_slices_;
+  for (const Buffer& buffer : buffers_) {
+    stats.capacity_bytes +=
+        static_cast<uint64_t>(buffer_capacity_) * vertex_stride_;
+    for (const auto& range : buffer.free_ranges) {
+      stats.free_bytes += static_cast<uint64_t>(range.second) * vertex_stride_;
+    }
+    stats.num_free_blocks += buffer.free_ranges.size();
+    if (!buffer.free_ranges_by_size.empty()) {
+      const uint64_t largest_free_block_bytes = static_cast<uint64_t>(
+          buffer.free_ranges_by_size.rbegin()->first) * vertex_stride_;
+      if (largest_free_block_bytes > stats.largest_free_block_bytes) {
+        stats.largest_free_block_bytes = largest_free_block_bytes;
+      }
+    }
+  }
+  stats.used_bytes = stats.capacity_bytes - stats.free_bytes;
+  return stats;
+}
+
+bool VertexBufferArena::AddBuffer() {
+  const GLsizeiptr size =
+      static_cast<GLsizeiptr>(buffer_capacity_) * vertex_stride_;
+  Buffer buffer;
+  trace_recorder_->GenBuffer(&buffer.buffer_id);
+  trace_recorder_->BindBuffer(GL_COPY_WRITE_BUFFER, buffer.buffer_id);
+  trace_recorder_->BufferData(GL_COPY_WRITE_BUFFER, size, nullptr,
+                              GL_STATIC_DRAW);
+  // The size is zero if the driver ran out of memory.
+  GLint64 allocated_size = 0;
+  glGetBufferParameteri64v(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE,
+                           &allocated_size);
+  trace_recorder_->BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  if (allocated_size != size) {
+    trace_recorder_->DeleteBuffer(buffer.buffer_id);
+    return false;
+  }
+  InsertFreeRange(0, buffer_capacity_, &buffer);
+  buffers_.push_back(std::move(buffer));
+  return true;
+}
+
+void VertexBufferArena::InsertFreeRange(const GLint start,
+                                        const GLsizei size,
+                                        Buffer* buffer) {
+  buffer->free_ranges[start] = size;
+  buffer->free_ranges_by_size.insert(std::make_pair(size, start));
+}
+
+void VertexBufferArena::EraseFreeRange(
+    const std::map<GLint, GLsizei>::iterator& range, Buffer* buffer) {
+  buffer->free_ranges_by_size.erase(
+      std::make_pair(range->second, range->first));
+  buffer->free_ranges.erase(range);
+}
+
+}  // namespace wvu
@@ -0,0 +1,180 @@
+// Copyright (C) 2016 West Virginia University.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Victor Fragoso (victor.fragoso@mail.wvu.edu)
+
+#ifndef GLUTILS_VERTEX_BUFFER_ARENA_H_
+#define GLUTILS_VERTEX_BUFFER_ARENA_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <GL/glew.h>
+
+#include "gl_trace.h"
+
+namespace wvu {
+// Statistics of the memory of a vertex buffer arena.
+struct VertexBufferArenaStats {
+  VertexBufferArenaStats() :
+      num_buffers(0), num_slices(0), capacity_bytes(0), used_bytes(0),
+      free_bytes(0), largest_free_block_bytes(0), num_free_blocks(0) {}
+  int num_buffers;
+  int num_slices;
+  uint64_t capacity_bytes;
+  uint64_t used_bytes;
+  uint64_t free_bytes;
+  uint64_t largest_free_block_bytes;
+  int num_free_blocks;
+
+  // Returns the fraction of the free memory that is not in the largest free
+  // block, i.e., 0 when the free memory is contiguous and close to 1 when it is
+  // split into many small blocks.
+  double fragmentation() const {
+    return free_bytes == 0 ? 0.0 :
+        1.0 - static_cast<double>(largest_free_block_bytes) / free_bytes;
+  }
+};
+
+// This class packs the vertices of many meshes into a few large vertex
+// buffers. Every mesh receives a slice of a buffer, i.e., a range of vertices,
+// and is drawn from the buffer with its first vertex as the base vertex, e.g.,
+// glDrawArrays(mode, slice.base_vertex, slice.num_vertices) or
+// glDrawElementsBaseVertex(..., slice.base_vertex). All the meshes of a buffer
+// thus share one vertex array object, and the draws need no bind in between.
+// All the meshes share the same vertex layout, given by the stride.
+// The free ranges of every buffer are kept in a free list; a slice takes the
+// smallest free range that fits it, and a freed slice merges with its free
+// neighbors. A new buffer is created when no free range fits.
+// Vertices are uploaded through GL_COPY_WRITE_BUFFER, so the vertex array and
+// array buffer bindings are not changed. The buffers are created and filled
+// through the given trace recorder, so a capture can replay the meshes.
+//
+// Example.
+//
+// wvu::VertexBufferArena arena;
+// arena.Initialize(sizeof(Vertex), 1 << 20, &error_info_log);
+// wvu::VertexBufferArena::Slice slice;
+// arena.Allocate(mesh.vertices.data(), mesh.vertices.size(), &slice);
+// ...  // Create one vertex array object per buffer of the arena, see
+//      // buffer_id().
+// glBindVertexArray(vertex_arrays[slice.buffer]);
+// glDrawArrays(GL_TRIANGLES, slice.base_vertex, slice.num_vertices);
+// ...
+// arena.Free(&slice);
+class VertexBufferArena {
+ public:
+  // A range of vertices of one of the buffers.
+  struct Slice {
+    Slice() : buffer(-1), base_vertex(0), num_vertices(0) {}
+    // The index of the buffer, see buffer_id().
+    int buffer;
+    GLint base_vertex;
+    GLsizei num_vertices;
+  };
+
+  // Issues the buffer calls through the trace recorder, which must outlive the
+  // arena. A null recorder issues them directly.
+  explicit VertexBufferArena(GLTraceRecorder* trace_recorder = nullptr) :
+      trace_recorder_(trace_recorder ?
+                      trace_recorder : GLTraceRecorder::PassThrough()),
+      vertex_stride_(0), buffer_capacity_(0), num_slices_(0) {}
+  ~VertexBufferArena();
+  VertexBufferArena(const VertexBufferArena&) = delete;
+  VertexBufferArena& operator=(const VertexBufferArena&) = delete;
+
+  // Creates the first buffer. Returns true if successful, and false otherwise,
+  // in which case error_info_log holds the reason.
+  //
+  // Parameters:
+  //   vertex_stride  The size of a vertex in bytes.
+  //   buffer_capacity  The number of vertices of every buffer, which bounds
+  //     the size of a mesh.
+  //   error_info_log  Optional pointer to a string that holds the error log.
+  bool Initialize(const GLsizei vertex_stride,
+                  const GLsizei buffer_capacity,
+                  std::string* error_info_log);
+
+  // Allocates a slice for the vertices and uploads them. Returns false if the
+  // mesh is empty or larger than a buffer.
+  bool Allocate(const void* vertices,
+                const GLsizei num_vertices,
+                Slice* slice);
+
+  // Returns the slice to its buffer and resets it to an empty slice. The
+  // buffers are kept for later allocations. Returns false, and changes
+  // nothing, if the slice is not allocated from this arena, e.g., if it was
+  // freed already or its range lies outside the buffer.
+  bool Free(Slice* slice);
+
+  // Returns the number of buffers and the id of a buffer.
+  int num_buffers() const {
+    return static_cast<int>(buffers_.size());
+  }
+  GLuint buffer_id(const int buffer) const {
+    return buffers_[buffer].buffer_id;
+  }
+
+  // Returns the statistics of the memory of the arena.
+  VertexBufferArenaStats stats() const;
+
+ private:
+  // A buffer and its free ranges, kept by start and by size. Both are in
+  // vertices.
+  struct Buffer {
+    GLuint buffer_id;
+    std::map<GLint, GLsizei> free_ranges;
+    std::set<std::pair<GLsizei, GLint> > free_ranges_by_size;
+  };
+
+  // Creates a buffer with a single free range. Returns false if the driver
+  // could not allocate it.
+  bool AddBuffer();
+
+  // Adds or removes a free range of the buffer.
+  void InsertFreeRange(const GLint start, const GLsizei size, Buffer* buffer);
+  void EraseFreeRange(const std::map<GLint, GLsizei>::iterator& range,
+                      Buffer* buffer);
+
+  GLTraceRecorder* trace_recorder_;
+  GLsizei vertex_stride_;
+  GLsizei buffer_capacity_;
+  std::vector<Buffer> buffers_;
+  int num_slices_;
+};
+
+}  // namespace wvu
+
+#endif  // GLUTILS_VERTEX_BUFFER_ARENA_H_
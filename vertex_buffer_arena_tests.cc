@@ -0,0 +1,212 @@
+// Copyright (C) 2016  Victor Fragoso <victor.fragoso@mail.wvu.edu>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of the West Virginia University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL VICTOR FRAGOSO BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// C++ headers.
+#include <string>
+#include <vector>
+
+// System specific headers.
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "shader_program.h"
+#include "test/gl_test.h"
+#include "vertex_buffer_arena.h"
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace wvu {
+namespace {
+class VertexBufferArenaTest : public GLTest {};
+
+}  // namespace
+
+TEST_F(VertexBufferArenaTest, SubAllocatesVertexBuffers) {
+  constexpr GLsizei kStride = 3 * sizeof(GLfloat);
+  constexpr GLsizei kCapacity = 1024;
+  VertexBufferArena arena;
+  std::string error_info_log;
+  ASSERT_TRUE(arena.Initialize(kStride, kCapacity, &error_info_log))
+      << error_info_log;
+  EXPECT_EQ(arena.num_buffers(), 1);
+
+  // Slices are packed one after another.
+  VertexBufferArena::Slice slices[3];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(arena.Allocate(nullptr, 100, &slices[i]));
+    EXPECT_EQ(slices[i].buffer, 0);
+    EXPECT_EQ(slices[i].base_vertex, 100 * i);
+  }
+  VertexBufferArenaStats stats = arena.stats();
+  EXPECT_EQ(stats.num_slices, 3);
+  EXPECT_EQ(stats.used_bytes, 300 * kStride);
+  EXPECT_EQ(stats.num_free_blocks, 1);
+  EXPECT_EQ(stats.fragmentation(), 0.0);
+
+  // Freeing the middle slice leaves a hole, which the smaller slice that
+  // fits takes.
+  EXPECT_TRUE(arena.Free(&slices[1]));
+  EXPECT_EQ(slices[1].buffer, -1);
+  stats = arena.stats();
+  EXPECT_EQ(stats.num_free_blocks, 2);
+  EXPECT_EQ(stats.largest_free_block_bytes, 724 * kStride);
+  EXPECT_GT(stats.fragmentation(), 0.0);
+  VertexBufferArena::Slice small_slice;
+  ASSERT_TRUE(arena.Allocate(nullptr, 50, &small_slice));
+  EXPECT_EQ(small_slice.base_vertex, 100);
+
+  // Freed neighbors merge back into a single free range.
+  EXPECT_TRUE(arena.Free(&small_slice));
+  EXPECT_TRUE(arena.Free(&slices[0]));
+  EXPECT_TRUE(arena.Free(&slices[2]));
+  stats = arena.stats();
+  EXPECT_EQ(stats.num_slices, 0);
+  EXPECT_EQ(stats.used_bytes, 0);
+  EXPECT_EQ(stats.num_free_blocks, 1);
+  EXPECT_EQ(stats.largest_free_block_bytes, kCapacity * kStride);
+
+  // A slice that fits no free range goes into a new buffer, and a mesh larger
+  // than a buffer is rejected.
+  VertexBufferArena::Slice large_slices[2];
+  ASSERT_TRUE(arena.Allocate(nullptr, 1000, &large_slices[0]));
+  ASSERT_TRUE(arena.Allocate(nullptr, 1000, &large_slices[1]));
+  EXPECT_EQ(large_slices[1].buffer, 1);
+  EXPECT_EQ(arena.num_buffers(), 2);
+  VertexBufferArena::Slice too_large_slice;
+  EXPECT_FALSE(arena.Allocate(nullptr, kCapacity + 1, &too_large_slice));
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(VertexBufferArenaTest, RejectsSlicesThatAreNotAllocated) {
+  VertexBufferArena arena;
+  ASSERT_TRUE(arena.Initialize(3 * sizeof(GLfloat), 1024, nullptr));
+  VertexBufferArena::Slice slices[3];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(arena.Allocate(nullptr, 100, &slices[i]));
+  }
+  // A second free of a copy of a freed slice is rejected and leaves the free
+  // list intact, also when the copy overlaps a merged free range.
+  const VertexBufferArena::Slice first_slice = slices[0];
+  const VertexBufferArena::Slice second_slice = slices[1];
+  ASSERT_TRUE(arena.Free(&slices[1]));
+  ASSERT_TRUE(arena.Free(&slices[0]));
+  for (VertexBufferArena::Slice slice : { first_slice, second_slice }) {
+    EXPECT_FALSE(arena.Free(&slice));
+    EXPECT_EQ(slice.buffer, 0);
+  }
+  // A reset slice and slices outside the buffer are rejected too.
+  EXPECT_FALSE(arena.Free(&slices[0]));
+  VertexBufferArena::Slice outside_slice = slices[2];
+  outside_slice.base_vertex = 1000;
+  EXPECT_FALSE(arena.Free(&outside_slice));
+  outside_slice.buffer = 1;
+  outside_slice.base_vertex = 0;
+  EXPECT_FALSE(arena.Free(&outside_slice));
+
+  VertexBufferArenaStats stats = arena.stats();
+  EXPECT_EQ(stats.num_slices, 1);
+  EXPECT_EQ(stats.num_free_blocks, 2);
+  EXPECT_EQ(stats.largest_free_block_bytes, 724 * 3 * sizeof(GLfloat));
+  // Allocations keep working on the intact free list.
+  VertexBufferArena::Slice slice;
+  ASSERT_TRUE(arena.Allocate(nullptr, 200, &slice));
+  EXPECT_EQ(slice.base_vertex, 0);
+  ASSERT_TRUE(arena.Free(&slice));
+  ASSERT_TRUE(arena.Free(&slices[2]));
+  stats = arena.stats();
+  EXPECT_EQ(stats.num_slices, 0);
+  EXPECT_EQ(stats.num_free_blocks, 1);
+}
+
+TEST_F(VertexBufferArenaTest, DrawsMeshesFromVertexBufferArena) {
+  ShaderProgram shader_program;
+  shader_program.LoadVertexShaderFromString(vertex_shader_src);
+  shader_program.LoadFragmentShaderFromString(fragment_shader_src);
+  ASSERT_TRUE(shader_program.Create(nullptr));
+
+  constexpr int kWidth = 4;
+  GLuint texture = 0, framebuffer = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kWidth, 1, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  ASSERT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER), GL_FRAMEBUFFER_COMPLETE);
+  glViewport(0, 0, kWidth, 1);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // Many one-point meshes, one per pixel and repeated, in a single arena.
+  constexpr int kNumMeshes = 4096;
+  VertexBufferArena arena;
+  std::string error_info_log;
+  ASSERT_TRUE(arena.Initialize(3 * sizeof(GLfloat), kNumMeshes,
+                               &error_info_log)) << error_info_log;
+  std::vector<VertexBufferArena::Slice> slices(kNumMeshes);
+  for (int i = 0; i < kNumMeshes; ++i) {
+    const GLfloat vertex[3] = {
+      (2.0f * (i % kWidth) + 1.0f) / kWidth - 1.0f, 0.0f, 0.0f
+    };
+    ASSERT_TRUE(arena.Allocate(vertex, 1, &slices[i]));
+  }
+  EXPECT_EQ(arena.num_buffers(), 1);
+  GLuint arena_vertex_array = 0;
+  glGenVertexArrays(1, &arena_vertex_array);
+  glBindVertexArray(arena_vertex_array);
+  glBindBuffer(GL_ARRAY_BUFFER, arena.buffer_id(0));
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat),
+                        nullptr);
+  glEnableVertexAttribArray(0);
+
+  // Draw the meshes of the odd pixels from the arena.
+  ASSERT_TRUE(shader_program.Use());
+  for (int i = 1; i < kWidth; i += 2) {
+    glDrawArrays(GL_POINTS, slices[i].base_vertex, slices[i].num_vertices);
+  }
+  unsigned char pixels[4 * kWidth];
+  glReadPixels(0, 0, kWidth, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  for (int i = 0; i < kWidth; ++i) {
+    EXPECT_EQ(pixels[4 * i], i % 2 == 1 ? 255 : 0);
+  }
+  EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDeleteVertexArrays(1, &arena_vertex_array);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &texture);
+}
+
+}  // namespace wvu